@@ -1,8 +1,10 @@
 #include "mainwindow.h"
+#include "startuptimeline.h"
 
 #include <QApplication>
 #include <QDir>
 #include <QDebug>
+#include <QThread>
 #include <iostream>
 #include <cstdlib>
 #include <csignal>
@@ -41,6 +43,11 @@ QStringList convertPluginsToStringList(char** plugins) {
 static QString g_instanceTmpDir;
 static std::vector<pid_t> g_childPids; // child PIDs recorded at startup
 
+// With CHATSDK_STARTUP=core-thread, Logos Core is started and loads modules
+// on this thread, so the window can come up meanwhile. Null otherwise.
+static QThread* g_coreThread = nullptr;
+static QObject* g_coreContext = nullptr; // Lives on g_coreThread
+
 // --- Async-signal-safe signal handling via self-pipe trick ---
 static int s_signalFd[2]; // pipe for self-pipe trick
 
@@ -115,12 +122,61 @@ static void recordChildPids()
 #endif
 }
 
-static void cleanup()
+// Starts Logos Core and loads the backend modules in their required order.
+// Returns whether chatsdk_module was loaded.
+static bool startCoreAndLoadModules(const QString& pluginsDir)
 {
-    static bool cleaned = false;
-    if (cleaned) return;
-    cleaned = true;
+    std::cout << "Setting plugins directory to: " << pluginsDir.toStdString() << std::endl;
+    logos_core_set_plugins_dir(pluginsDir.toUtf8().constData());
+
+    // Start the core
+    logos_core_start();
+    std::cout << "Logos Core started successfully!" << std::endl;
+    StartupTimeline::instance().mark("logos core started");
+
+    // Load plugins in required order
+    std::cout << "Loading plugins in specified order..." << std::endl;
 
+    // Load capability_module first (handles auth tokens)
+    if (logos_core_load_plugin("capability_module")) {
+        std::cout << "Successfully loaded capability_module plugin" << std::endl;
+        StartupTimeline::instance().mark("capability_module loaded");
+    } else {
+        std::cerr << "Failed to load capability_module plugin" << std::endl;
+    }
+
+    // Then load chatsdk_module
+    bool chatModuleLoaded = logos_core_load_plugin("chatsdk_module");
+    if (chatModuleLoaded) {
+        std::cout << "Successfully loaded chatsdk_module plugin" << std::endl;
+        StartupTimeline::instance().mark("chatsdk_module loaded");
+    } else {
+        std::cerr << "Failed to load chatsdk_module plugin" << std::endl;
+    }
+
+    // Record child PIDs spawned by the core (e.g. logos_host) so we can
+    // reliably terminate them during cleanup without depending on pgrep
+    // or Qt at shutdown time.
+    recordChildPids();
+
+    // Print all loaded plugins
+    char** loadedPlugins = logos_core_get_loaded_plugins();
+    QStringList plugins = convertPluginsToStringList(loadedPlugins);
+
+    if (plugins.isEmpty()) {
+        qInfo() << "No plugins loaded.";
+    } else {
+        qInfo() << "Currently loaded plugins:";
+        for (const QString &plugin : plugins) {
+            qInfo() << "  -" << plugin;
+        }
+        qInfo() << "Total plugins:" << plugins.size();
+    }
+    return chatModuleLoaded;
+}
+
+static void shutdownCore()
+{
     // Kill child processes (e.g. logos_host) BEFORE logos_core_cleanup(),
     // because the core's own termination logic can crash children and
     // abort cleanup midway, leaving stragglers.
@@ -131,19 +187,61 @@ static void cleanup()
     }
 
     logos_core_cleanup();
+}
+
+static void cleanup()
+{
+    static bool cleaned = false;
+    if (cleaned) return;
+    cleaned = true;
+
+    StartupTimeline::instance().reportIfPending();
+
+    if (g_coreThread) {
+        // The core is shut down on the thread that started it; this waits
+        // for module loading to finish if it still is
+        QMetaObject::invokeMethod(g_coreContext, &shutdownCore,
+                                  Qt::BlockingQueuedConnection);
+        g_coreThread->quit();
+        g_coreThread->wait();
+    } else {
+        shutdownCore();
+    }
 
     if (!g_instanceTmpDir.isEmpty()) {
         QDir(g_instanceTmpDir).removeRecursively();
     }
 }
 
+// CHATSDK_STARTUP picks the order of startup work:
+//   interleaved (default)  window and plugin first, then Logos Core and the
+//                          modules, all on the main thread
+//   serial                 Logos Core and the modules, then the window
+//   core-thread            Logos Core and the modules on a thread of their
+//                          own while the window comes up; liblogos is not
+//                          known to support this, so it is opt-in
+enum class StartupMode { Interleaved, Serial, CoreThread };
+
+static StartupMode startupMode(const QString& name)
+{
+    if (name == "serial") return StartupMode::Serial;
+    if (name == "core-thread") return StartupMode::CoreThread;
+    return StartupMode::Interleaved;
+}
+
 int main(int argc, char *argv[])
 {
+    const StartupMode mode = startupMode(qEnvironmentVariable("CHATSDK_STARTUP"));
+    StartupTimeline::instance().start(mode == StartupMode::Serial       ? "serial"
+                                      : mode == StartupMode::CoreThread ? "core-thread"
+                                                                        : "interleaved");
+
     // Set up per-instance temp directory before QApplication.
     setupInstanceTempDir();
 
     // Create QApplication after the temp dir setup.
     QApplication app(argc, argv);
+    StartupTimeline::instance().mark("application created");
 
     // --- Async-signal-safe signal handling via self-pipe trick ---
     // Create self-pipe
@@ -170,53 +268,40 @@ int main(int argc, char *argv[])
 
     // Set the plugins directory
     QString pluginsDir = QDir::cleanPath(QCoreApplication::applicationDirPath() + "/../modules");
-    std::cout << "Setting plugins directory to: " << pluginsDir.toStdString() << std::endl;
-    logos_core_set_plugins_dir(pluginsDir.toUtf8().constData());
-
-    // Start the core
-    logos_core_start();
-    std::cout << "Logos Core started successfully!" << std::endl;
 
-    // Load plugins in required order
-    std::cout << "Loading plugins in specified order..." << std::endl;
-    
-    // Load capability_module first (handles auth tokens)
-    if (logos_core_load_plugin("capability_module")) {
-        std::cout << "Successfully loaded capability_module plugin" << std::endl;
-    } else {
-        std::cerr << "Failed to load capability_module plugin" << std::endl;
-    }
-    
-    // Then load chatsdk_module
-    if (logos_core_load_plugin("chatsdk_module")) {
-        std::cout << "Successfully loaded chatsdk_module plugin" << std::endl;
-    } else {
-        std::cerr << "Failed to load chatsdk_module plugin" << std::endl;
+    if (mode == StartupMode::Serial) {
+        startCoreAndLoadModules(pluginsDir);
     }
 
-    // Record child PIDs spawned by the core (e.g. logos_host) so we can
-    // reliably terminate them during cleanup without depending on pgrep
-    // or Qt at shutdown time.
-    recordChildPids();
+    // Create and show the main window. Unless serial, it paints a
+    // "connecting" placeholder, then loads the UI plugin before the modules
+    // are loaded.
+    MainWindow window(mode != StartupMode::Serial);
+    window.show();
+    StartupTimeline::instance().mark("window shown");
 
-    // Print all loaded plugins
-    char** loadedPlugins = logos_core_get_loaded_plugins();
-    QStringList plugins = convertPluginsToStringList(loadedPlugins);
-    
-    if (plugins.isEmpty()) {
-        qInfo() << "No plugins loaded.";
-    } else {
-        qInfo() << "Currently loaded plugins:";
-        for (const QString &plugin : plugins) {
-            qInfo() << "  -" << plugin;
-        }
-        qInfo() << "Total plugins:" << plugins.size();
+    if (mode == StartupMode::Interleaved) {
+        // Queued behind the chat window's paint request, so it is painted
+        // before module loading takes up the main thread
+        QObject::connect(&window, &MainWindow::chatPluginLoaded, &window, [&window, pluginsDir]() {
+            window.setModulesLoaded(startCoreAndLoadModules(pluginsDir));
+        }, Qt::QueuedConnection);
+    } else if (mode == StartupMode::CoreThread) {
+        g_coreThread = new QThread(&app);
+        g_coreThread->setObjectName("LogosCore");
+        g_coreContext = new QObject();
+        g_coreContext->moveToThread(g_coreThread);
+        QObject::connect(g_coreThread, &QThread::finished, g_coreContext, &QObject::deleteLater);
+        g_coreThread->start();
+
+        QMetaObject::invokeMethod(g_coreContext, [&window, pluginsDir]() {
+            const bool chatModuleLoaded = startCoreAndLoadModules(pluginsDir);
+            QMetaObject::invokeMethod(&window, [&window, chatModuleLoaded]() {
+                window.setModulesLoaded(chatModuleLoaded);
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
     }
-    
-    // Create and show the main window
-    MainWindow window;
-    window.show();
-    
+
     // Run the application
     return app.exec();
 }
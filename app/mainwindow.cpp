@@ -1,14 +1,41 @@
 #include "mainwindow.h"
+#include "startuptimeline.h"
 #include <QApplication>
 #include <QCoreApplication>
 #include <QPluginLoader>
 #include <QDebug>
+#include <QEvent>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QDir>
 
-MainWindow::MainWindow(QWidget *parent)
+namespace {
+
+QWidget *createMessageWidget(const QString &text, QWidget *parent)
+{
+    QWidget* widget = new QWidget(parent);
+    QVBoxLayout* layout = new QVBoxLayout(widget);
+
+    QLabel* messageLabel = new QLabel(text, widget);
+    QFont font = messageLabel->font();
+    font.setPointSize(14);
+    messageLabel->setFont(font);
+    messageLabel->setAlignment(Qt::AlignCenter);
+
+    layout->addWidget(messageLabel);
+    return widget;
+}
+
+}
+
+MainWindow::MainWindow(bool modulesLoading, QWidget *parent)
     : QMainWindow(parent)
+    , m_chatWidget(nullptr)
+    , m_modulesLoading(modulesLoading)
+    // Mirrors ChatConfig::autoStartEnabled() in the plugin
+    , m_autoStart(qEnvironmentVariable("CHATSDK_AUTO_START", "1") != "0")
+    , m_firstPaintSeen(false)
+    , m_pluginLoaded(false)
 {
     setupUi();
 }
@@ -19,6 +46,37 @@ MainWindow::~MainWindow()
 
 void MainWindow::setupUi()
 {
+    if (m_modulesLoading) {
+        // A placeholder is painted straight away; the plugin is loaded after
+        // the first paint, while Logos Core is still loading modules
+        setCentralWidget(createMessageWidget("Connecting to Logos Core...", this));
+    } else {
+        loadChatPlugin();
+    }
+    centralWidget()->installEventFilter(this);
+
+    // Set window title and size
+    setWindowTitle("Logos Chat App");
+    resize(1000, 700);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && !m_firstPaintSeen) {
+        m_firstPaintSeen = true;
+        watched->removeEventFilter(this);
+        StartupTimeline::instance().markFirstPaint();
+        if (!m_pluginLoaded) {
+            QMetaObject::invokeMethod(this, "loadChatPlugin", Qt::QueuedConnection);
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::loadChatPlugin()
+{
+    m_pluginLoaded = true;
+
     // Determine the appropriate plugin extension based on the platform
     QString pluginExtension;
     #if defined(Q_OS_WIN)
@@ -36,6 +94,7 @@ void MainWindow::setupUi()
     QWidget* chatWidget = nullptr;
 
     if (loader.load()) {
+        StartupTimeline::instance().mark("chat plugin loaded");
         QObject* plugin = loader.instance();
         if (plugin) {
             // Try to create the chat widget using the plugin's createWidget method
@@ -46,28 +105,58 @@ void MainWindow::setupUi()
     }
 
     if (chatWidget) {
+        m_chatWidget = chatWidget;
+        // Connected before the widget's event loop work starts, so no phase
+        // is missed; the plugin widget is a ChatSDKWindow
+        connect(chatWidget, SIGNAL(startupPhase(QString)),
+                this, SLOT(onChatStartupPhase(QString)));
+        if (m_modulesLoading) {
+            QMetaObject::invokeMethod(chatWidget, "setModulesLoading",
+                                      Qt::DirectConnection, Q_ARG(bool, true));
+        }
         setCentralWidget(chatWidget);
+        StartupTimeline::instance().mark("chat window created");
+        checkInteractive();
     } else {
         qWarning() << "================================================";
         qWarning() << "Failed to load Chat App plugin from:" << pluginPath;
         qWarning() << "Error:" << loader.errorString();
         qWarning() << "================================================";
-        
+
         // Fallback: show a message when plugin is not found
-        QWidget* fallbackWidget = new QWidget(this);
-        QVBoxLayout* layout = new QVBoxLayout(fallbackWidget);
+        setCentralWidget(createMessageWidget("Chat App module not loaded", this));
+        StartupTimeline::instance().reportIfPending();
+    }
+    emit chatPluginLoaded();
+}
 
-        QLabel* messageLabel = new QLabel("Chat App module not loaded", fallbackWidget);
-        QFont font = messageLabel->font();
-        font.setPointSize(14);
-        messageLabel->setFont(font);
-        messageLabel->setAlignment(Qt::AlignCenter);
+void MainWindow::setModulesLoaded(bool chatModuleLoaded)
+{
+    m_modulesLoading = false;
+    if (!chatModuleLoaded) {
+        StartupTimeline::instance().reportIfPending();
+    }
+    if (m_chatWidget) {
+        QMetaObject::invokeMethod(m_chatWidget, "setModulesLoading",
+                                  Qt::DirectConnection, Q_ARG(bool, false));
+        checkInteractive();
+    }
+}
 
-        layout->addWidget(messageLabel);
-        setCentralWidget(fallbackWidget);
+void MainWindow::onChatStartupPhase(const QString &phase)
+{
+    if (phase == "chat started") {
+        StartupTimeline::instance().markInteractive(phase);
+        return;
     }
+    StartupTimeline::instance().mark(phase);
+}
 
-    // Set window title and size
-    setWindowTitle("Logos Chat App");
-    resize(1000, 700);
+void MainWindow::checkInteractive()
+{
+    // Without auto-start the user drives initialization, so the app is
+    // usable once the window is up and the modules are loaded
+    if (!m_autoStart && m_chatWidget && !m_modulesLoading) {
+        StartupTimeline::instance().markInteractive("ready to initialize");
+    }
 }
@@ -3,16 +3,43 @@
 
 #include <QMainWindow>
 
+class QEvent;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // modulesLoading: Logos Core is still loading the backend modules, and
+    // setModulesLoaded() will be called once it is done. The window then
+    // paints a placeholder first and loads the plugin after it; otherwise
+    // the plugin is loaded here.
+    MainWindow(bool modulesLoading, QWidget *parent = nullptr);
     ~MainWindow();
 
+public slots:
+    void setModulesLoaded(bool chatModuleLoaded);
+
+signals:
+    // loadChatPlugin() is done, whether or not the plugin loaded
+    void chatPluginLoaded();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void loadChatPlugin();
+    void onChatStartupPhase(const QString &phase);
+
 private:
     void setupUi();
+    void checkInteractive();
+
+    QWidget *m_chatWidget;
+    bool m_modulesLoading;
+    bool m_autoStart;
+    bool m_firstPaintSeen;
+    bool m_pluginLoaded;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,91 @@
+#include "startuptimeline.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <iostream>
+#include <cstdio>
+
+StartupTimeline &StartupTimeline::instance()
+{
+    static StartupTimeline timeline;
+    return timeline;
+}
+
+void StartupTimeline::start(const QString &mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_mode = mode;
+    m_clock.start();
+}
+
+void StartupTimeline::mark(const QString &phase)
+{
+    QMutexLocker locker(&m_mutex);
+    m_phases.append({phase, m_clock.elapsed()});
+}
+
+void StartupTimeline::markFirstPaint()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_firstPaintMs >= 0) return;
+    m_firstPaintMs = m_clock.elapsed();
+    m_phases.append({QStringLiteral("first paint"), m_firstPaintMs});
+}
+
+void StartupTimeline::markInteractive(const QString &phase)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_interactiveMs >= 0) return;
+    m_interactiveMs = m_clock.elapsed();
+    m_phases.append({phase, m_interactiveMs});
+    report();
+}
+
+void StartupTimeline::reportIfPending()
+{
+    QMutexLocker locker(&m_mutex);
+    report();
+}
+
+void StartupTimeline::report()
+{
+    if (m_reported) return;
+    m_reported = true;
+
+    std::cout << "Startup timeline (" << m_mode.toStdString() << ", ms since launch):" << std::endl;
+    for (const Phase &phase : m_phases) {
+        char ms[16];
+        std::snprintf(ms, sizeof(ms), "%7lld", static_cast<long long>(phase.ms));
+        std::cout << "  " << ms << "  " << phase.name.toStdString() << std::endl;
+    }
+    auto describe = [](qint64 ms) {
+        return ms >= 0 ? std::to_string(ms) + " ms" : std::string("not reached");
+    };
+    std::cout << "Time to first paint: " << describe(m_firstPaintMs)
+              << ", time to interactive: " << describe(m_interactiveMs) << std::endl;
+
+    const QString reportPath = qEnvironmentVariable("CHATSDK_STARTUP_REPORT");
+    if (reportPath.isEmpty()) return;
+
+    QJsonArray phases;
+    for (const Phase &phase : m_phases) {
+        phases.append(QJsonObject{{"phase", phase.name}, {"ms", phase.ms}});
+    }
+    const QJsonObject run{
+        {"mode", m_mode},
+        {"firstPaintMs", m_firstPaintMs},
+        {"interactiveMs", m_interactiveMs},
+        {"phases", phases},
+    };
+    QFile file(reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        std::cerr << "Could not write startup report to " << reportPath.toStdString()
+                  << ": " << file.errorString().toStdString() << std::endl;
+        return;
+    }
+    file.write(QJsonDocument(run).toJson(QJsonDocument::Compact));
+    file.write("\n");
+}
@@ -0,0 +1,47 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// Wall-clock phases of one launch, in ms from the top of main().
+// mark() may be called from any thread. The report lists every phase with
+// time-to-first-paint and time-to-interactive, and is also appended as one
+// JSON line to $CHATSDK_STARTUP_REPORT when that is set, so that runs can
+// be compared.
+class StartupTimeline
+{
+public:
+    static StartupTimeline &instance();
+
+    // "overlapped" or "serial", recorded with the report
+    void start(const QString &mode);
+    void mark(const QString &phase);
+    void markFirstPaint();
+    // Marks the app as usable and reports the timeline
+    void markInteractive(const QString &phase);
+    // Reports what was reached if the app never became interactive
+    void reportIfPending();
+
+private:
+    struct Phase {
+        QString name;
+        qint64 ms;
+    };
+
+    StartupTimeline() = default;
+    // Called with m_mutex held
+    void report();
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QString m_mode;
+    QVector<Phase> m_phases;
+    qint64 m_firstPaintMs = -1;
+    qint64 m_interactiveMs = -1;
+    bool m_reported = false;
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,381 @@
+#include "ChatPanel.h"
+#include "ChatSDKWindow.h"
+#include "ConversationListModel.h"
+#include "ConversationListPanel.h"
+#include "HexCodec.h"
+#include "Theme.h"
+#include <QApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+// Drives the chat UI hot paths with synthetic data. Runs headless: main()
+// selects the offscreen platform unless QT_QPA_PLATFORM is already set,
+// CHATSDK_AUTO_START=0 keeps the window from initializing chat, and the fake
+// backend replaces chatsdk_module.
+//
+// Window slots are private, so they are reached through the meta-object
+// system, the same way module callbacks reach them.
+class ChatUiBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void onChatsdkNewMessage_data();
+    void onChatsdkNewMessage();
+
+    void chatPanelAddMessage_data();
+    void chatPanelAddMessage();
+
+    void timelineResize_data();
+    void timelineResize();
+
+    void showConversationMessages_data();
+    void showConversationMessages();
+
+    void conversationListUpdate_data();
+    void conversationListUpdate();
+
+    void formatRelativeTime_data();
+    void formatRelativeTime();
+    void relativeTimeRole_data();
+    void relativeTimeRole();
+
+    void chatPanelCreation();
+    void themeSwitch();
+
+private:
+    static QVariantList newMessageEvent(const QString& conversationId, const QString& content);
+    static QVariantList newConversationEvent(const QString& conversationId);
+    static QString makeText(int index);
+
+    void addConversation(const QString& conversationId);
+    void deliver(const QString& conversationId, int count);
+    void select(const QString& conversationId);
+
+    QTemporaryDir m_storeDir;
+    ChatSDKWindow* m_window = nullptr;
+    int m_conversationCount = 0;
+};
+
+QVariantList ChatUiBenchmark::newMessageEvent(const QString& conversationId, const QString& content)
+{
+    QJsonObject obj;
+    obj["conversationId"] = conversationId;
+    obj["sender"] = "peer";
+    obj["content"] = HexCodec::encodeText(content);
+    return {QString::fromUtf8(QJsonDocument(obj).toJson(QJsonDocument::Compact))};
+}
+
+QVariantList ChatUiBenchmark::newConversationEvent(const QString& conversationId)
+{
+    QJsonObject obj;
+    obj["conversationId"] = conversationId;
+    obj["conversationType"] = "private";
+    obj["peerId"] = QString("peer-%1").arg(conversationId);
+    return {QString::fromUtf8(QJsonDocument(obj).toJson(QJsonDocument::Compact))};
+}
+
+QString ChatUiBenchmark::makeText(int index)
+{
+    // Mix of one-liners and messages that wrap over several lines
+    static const QString sentence = "The quick brown fox jumps over the lazy dog. ";
+    return QString("#%1 ").arg(index) + sentence.repeated(1 + index % 6);
+}
+
+void ChatUiBenchmark::initTestCase()
+{
+    QVERIFY(m_storeDir.isValid());
+    qputenv("CHATSDK_STORE_DIR", m_storeDir.path().toUtf8());
+
+    m_window = new ChatSDKWindow();
+    m_window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_window));
+}
+
+void ChatUiBenchmark::cleanupTestCase()
+{
+    delete m_window;
+    m_window = nullptr;
+}
+
+void ChatUiBenchmark::addConversation(const QString& conversationId)
+{
+    QMetaObject::invokeMethod(m_window, "onChatsdkNewConversation", Qt::DirectConnection,
+                              Q_ARG(QVariantList, newConversationEvent(conversationId)));
+}
+
+void ChatUiBenchmark::deliver(const QString& conversationId, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        QMetaObject::invokeMethod(m_window, "onChatsdkNewMessage", Qt::DirectConnection,
+                                  Q_ARG(QVariantList, newMessageEvent(conversationId, makeText(i))));
+    }
+}
+
+void ChatUiBenchmark::select(const QString& conversationId)
+{
+    QMetaObject::invokeMethod(m_window, "onConversationSelected", Qt::DirectConnection,
+                              Q_ARG(QString, conversationId));
+}
+
+void ChatUiBenchmark::onChatsdkNewMessage_data()
+{
+    QTest::addColumn<bool>("visible");
+    QTest::newRow("current conversation") << true;
+    QTest::newRow("background conversation") << false;
+}
+
+void ChatUiBenchmark::onChatsdkNewMessage()
+{
+    QFETCH(bool, visible);
+    const QString current = QString("bench-current-%1").arg(m_conversationCount++);
+    const QString background = QString("bench-background-%1").arg(m_conversationCount++);
+    addConversation(current);
+    addConversation(background);
+    select(current);
+
+    const QString target = visible ? current : background;
+    int index = 0;
+    QBENCHMARK {
+        QMetaObject::invokeMethod(m_window, "onChatsdkNewMessage", Qt::DirectConnection,
+                                  Q_ARG(QVariantList, newMessageEvent(target, makeText(index++))));
+        m_window->repaint();
+    }
+}
+
+void ChatUiBenchmark::chatPanelAddMessage_data()
+{
+    QTest::addColumn<int>("existing");
+    QTest::newRow("empty") << 0;
+    QTest::newRow("1k messages") << 1000;
+    QTest::newRow("10k messages") << 10000;
+}
+
+void ChatUiBenchmark::chatPanelAddMessage()
+{
+    QFETCH(int, existing);
+    ChatPanel panel;
+    Theme::instance().apply(&panel);
+    panel.resize(750, 600);
+    panel.setConversation("bench", "Bench");
+
+    QList<MessageListModel::Message> history;
+    history.reserve(existing);
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < existing; ++i) {
+        history.append({"peer", makeText(i), now, i % 3 == 0});
+    }
+    panel.setMessages(history, false);
+    panel.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&panel));
+
+    int index = existing;
+    QBENCHMARK {
+        panel.addMessage("peer", makeText(index), now, index % 3 == 0);
+        ++index;
+        panel.repaint();
+    }
+}
+
+void ChatUiBenchmark::timelineResize_data()
+{
+    QTest::addColumn<int>("existing");
+    QTest::newRow("1k messages") << 1000;
+    QTest::newRow("10k messages") << 10000;
+}
+
+// A live splitter drag: the width moves a few pixels per frame and every row
+// is measured again
+void ChatUiBenchmark::timelineResize()
+{
+    QFETCH(int, existing);
+    ChatPanel panel;
+    Theme::instance().apply(&panel);
+    panel.resize(750, 600);
+    panel.setConversation("bench", "Bench");
+
+    QList<MessageListModel::Message> history;
+    history.reserve(existing);
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < existing; ++i) {
+        history.append({"peer", makeText(i), now, i % 3 == 0});
+    }
+    panel.setMessages(history, false);
+    panel.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&panel));
+
+    int step = 0;
+    QBENCHMARK {
+        panel.resize(650 + (step++ % 50) * 4, 600);
+        QCoreApplication::processEvents();
+        panel.repaint();
+    }
+}
+
+void ChatUiBenchmark::showConversationMessages_data()
+{
+    QTest::addColumn<int>("history");
+    QTest::newRow("100 messages") << 100;
+    QTest::newRow("10k messages") << 10000;
+    QTest::newRow("100k messages") << 100000;
+}
+
+void ChatUiBenchmark::showConversationMessages()
+{
+    QFETCH(int, history);
+    const QString target = QString("bench-history-%1").arg(m_conversationCount++);
+    const QString other = QString("bench-other-%1").arg(m_conversationCount++);
+    addConversation(target);
+    addConversation(other);
+    deliver(target, history);
+
+    // Switch away and back, so every iteration pays a full conversation load
+    QBENCHMARK {
+        select(other);
+        select(target);
+        m_window->repaint();
+    }
+}
+
+void ChatUiBenchmark::conversationListUpdate_data()
+{
+    QTest::addColumn<int>("conversations");
+    QTest::newRow("50 conversations") << 50;
+    QTest::newRow("1k conversations") << 1000;
+}
+
+void ChatUiBenchmark::conversationListUpdate()
+{
+    QFETCH(int, conversations);
+    ConversationRegistry registry;
+    ConversationListPanel panel(&registry);
+    Theme::instance().apply(&panel);
+    panel.resize(250, 600);
+    const QDateTime start = QDateTime::currentDateTime().addDays(-1);
+    for (int i = 0; i < conversations; ++i) {
+        const auto handle = registry.intern(QString("c%1").arg(i));
+        registry[handle].name = QString("Chat %1").arg(i);
+        registry[handle].lastActivity = start.addSecs(i);
+        panel.addConversation(handle);
+    }
+    panel.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&panel));
+
+    int index = 0;
+    QBENCHMARK {
+        const auto handle = ConversationRegistry::Handle(index++ % conversations);
+        panel.updateConversation(handle, QDateTime::currentDateTime());
+        panel.incrementUnread(handle);
+        panel.repaint();
+    }
+}
+
+void ChatUiBenchmark::formatRelativeTime_data()
+{
+    QTest::addColumn<qint64>("age");
+    QTest::newRow("just now") << qint64(5);
+    QTest::newRow("minutes") << qint64(25 * 60);
+    QTest::newRow("hours") << qint64(5 * 3600);
+    QTest::newRow("days") << qint64(3 * 86400);
+    QTest::newRow("older") << qint64(40 * 86400);
+}
+
+void ChatUiBenchmark::formatRelativeTime()
+{
+    QFETCH(qint64, age);
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDateTime then = now.addSecs(-age);
+    QString text;
+    QBENCHMARK {
+        text = ConversationListModel::formatRelativeTime(then, now);
+    }
+    QVERIFY(!text.isEmpty());
+}
+
+void ChatUiBenchmark::relativeTimeRole_data()
+{
+    QTest::addColumn<int>("conversations");
+    QTest::newRow("1000 rows") << 1000;
+    QTest::newRow("5000 rows") << 5000;
+}
+
+// Every row's relative time, as a full repaint of the list reads it; the
+// labels are formatted when activity changes, not on each read
+void ChatUiBenchmark::relativeTimeRole()
+{
+    QFETCH(int, conversations);
+    ConversationRegistry registry;
+    ConversationListModel model(&registry);
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < conversations; ++i) {
+        const auto handle = registry.intern(QString("conv-%1").arg(i));
+        registry[handle].name = QString("Conversation %1").arg(i);
+        registry[handle].lastActivity = now.addSecs(-qint64(i) * 97);
+        model.addConversation(handle);
+    }
+
+    int length = 0;
+    QBENCHMARK {
+        for (int row = 0; row < conversations; ++row) {
+            length += model.index(row).data(ConversationListModel::RelativeTimeRole)
+                          .toString().size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+// Creating and polishing a chat panel under the themed window: the cost the
+// per-widget style sheets used to add to every panel
+void ChatUiBenchmark::chatPanelCreation()
+{
+    QWidget host;
+    Theme::instance().apply(&host);
+    host.resize(750, 600);
+    host.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&host));
+
+    QBENCHMARK {
+        ChatPanel* panel = new ChatPanel(&host);
+        panel->resize(host.size());
+        panel->show();
+        host.repaint();
+        delete panel;
+    }
+}
+
+// Dark to light and back on the full window
+void ChatUiBenchmark::themeSwitch()
+{
+    const QString target = QString("bench-theme-%1").arg(m_conversationCount++);
+    addConversation(target);
+    deliver(target, 200);
+    select(target);
+
+    Theme& theme = Theme::instance();
+    const Theme::Mode initial = theme.mode();
+    QBENCHMARK {
+        theme.setMode(theme.mode() == Theme::Dark ? Theme::Light : Theme::Dark);
+        m_window->repaint();
+    }
+    theme.setMode(initial);
+}
+
+int main(int argc, char** argv)
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("CHATSDK_AUTO_START", "0");
+    // Never started, so it stays silent; keeps the window off Logos Core
+    qputenv("CHATSDK_FAKE_BACKEND", "1");
+
+    QApplication app(argc, argv);
+    ChatUiBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "ChatUiBenchmark.moc"
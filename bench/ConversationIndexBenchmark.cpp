@@ -0,0 +1,77 @@
+#include "ConversationIndex.h"
+#include <QRandomGenerator>
+#include <QtTest>
+
+// Per-keystroke latency of the quick switcher's ConversationIndex, which
+// should stay well under a millisecond
+class ConversationIndexBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void addConversation();
+
+    void query_data();
+    void query();
+
+private:
+    static constexpr int kConversations = 5000;
+
+    QDateTime m_now;
+    ConversationIndex m_index;
+};
+
+void ConversationIndexBenchmark::initTestCase()
+{
+    QRandomGenerator rng(42);
+    m_now = QDateTime::currentDateTime();
+    for (int i = 0; i < kConversations; ++i) {
+        // Names and peers look like the ones the window makes: "Chat " plus
+        // the first characters of a hex peer id
+        QString peer;
+        for (int c = 0; c < 64; ++c) {
+            peer += QLatin1Char("0123456789abcdef"[rng.bounded(16)]);
+        }
+        m_index.addConversation(QString("conversation-%1").arg(i),
+                                QString("Chat %1").arg(peer.left(6)), peer,
+                                m_now.addSecs(-qint64(rng.bounded(90 * 86400))));
+    }
+    qInfo() << "Indexed" << m_index.size() << "conversations";
+}
+
+void ConversationIndexBenchmark::addConversation()
+{
+    int i = 0;
+    QBENCHMARK {
+        const QString id = QString("bench-%1").arg(i++);
+        m_index.addConversation(id, "Chat bench", "feedbeef", m_now);
+        m_index.removeConversation(id);
+    }
+}
+
+void ConversationIndexBenchmark::query_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::newRow("empty") << QString();
+    QTest::newRow("one char") << QString("c");
+    QTest::newRow("two chars") << QString("ch");
+    QTest::newRow("word") << QString("chat");
+    QTest::newRow("peer prefix") << QString("a3f");
+    QTest::newRow("conversation id") << QString("conversation-42");
+    QTest::newRow("gapped") << QString("cht a3");
+    QTest::newRow("no match") << QString("zzzz");
+}
+
+void ConversationIndexBenchmark::query()
+{
+    QFETCH(QString, query);
+    QList<ConversationIndex::Match> matches;
+    QBENCHMARK {
+        matches = m_index.search(query, 20, m_now);
+    }
+    QVERIFY(matches.size() <= 20);
+}
+
+QTEST_GUILESS_MAIN(ConversationIndexBenchmark)
+#include "ConversationIndexBenchmark.moc"
@@ -0,0 +1,134 @@
+#include "HexCodec.h"
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QtTest>
+
+// Compares HexCodec against the Qt calls it replaced in the message paths:
+//   outbound: QString::fromLatin1(text.toUtf8().toHex())
+//   inbound:  QRegularExpression hex match + QByteArray::fromHex + fromUtf8
+class HexCodecBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void encodeQt_data() { addSizes(); }
+    void encodeQt();
+    void encodeCodec_data() { addSizes(); }
+    void encodeCodec();
+
+    void decodeQt_data() { addSizes(); }
+    void decodeQt();
+    void decodeCodec_data() { addSizes(); }
+    void decodeCodec();
+
+    // Plain-text content must be rejected as cheaply as possible
+    void detectTextQt_data() { addSizes(); }
+    void detectTextQt();
+    void detectTextCodec_data() { addSizes(); }
+    void detectTextCodec();
+
+private:
+    static void addSizes();
+    static QString makeText(int bytes);
+};
+
+void HexCodecBenchmark::initTestCase()
+{
+    qInfo() << "HexCodec kernel:" << HexCodec::activeKernel();
+}
+
+void HexCodecBenchmark::addSizes()
+{
+    QTest::addColumn<int>("bytes");
+    for (int bytes : {16, 256, 4 * 1024, 64 * 1024, 1024 * 1024}) {
+        QTest::newRow(qPrintable(QString("%1B").arg(bytes))) << bytes;
+    }
+}
+
+QString HexCodecBenchmark::makeText(int bytes)
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ.,!?0123456789";
+    QString text(bytes, Qt::Uninitialized);
+    auto* rng = QRandomGenerator::global();
+    for (int i = 0; i < bytes; ++i) {
+        text[i] = QLatin1Char(alphabet[rng->bounded(int(sizeof(alphabet) - 1))]);
+    }
+    return text;
+}
+
+void HexCodecBenchmark::encodeQt()
+{
+    QFETCH(int, bytes);
+    const QString text = makeText(bytes);
+    QString hex;
+    QBENCHMARK {
+        hex = QString::fromLatin1(text.toUtf8().toHex());
+    }
+    QCOMPARE(hex.size(), bytes * 2);
+}
+
+void HexCodecBenchmark::encodeCodec()
+{
+    QFETCH(int, bytes);
+    const QString text = makeText(bytes);
+    QString hex;
+    QBENCHMARK {
+        hex = HexCodec::encodeText(text);
+    }
+    QCOMPARE(hex, QString::fromLatin1(text.toUtf8().toHex()));
+}
+
+void HexCodecBenchmark::decodeQt()
+{
+    QFETCH(int, bytes);
+    const QString text = makeText(bytes);
+    const QString hex = QString::fromLatin1(text.toUtf8().toHex());
+    QString content;
+    QBENCHMARK {
+        content = hex;
+        if (content.contains(QRegularExpression("^[0-9a-fA-F]+$")) &&
+            content.length() % 2 == 0) {
+            content = QString::fromUtf8(QByteArray::fromHex(content.toUtf8()));
+        }
+    }
+    QCOMPARE(content, text);
+}
+
+void HexCodecBenchmark::decodeCodec()
+{
+    QFETCH(int, bytes);
+    const QString text = makeText(bytes);
+    const QString hex = QString::fromLatin1(text.toUtf8().toHex());
+    QString content;
+    QBENCHMARK {
+        content = HexCodec::decodeContent(hex);
+    }
+    QCOMPARE(content, text);
+}
+
+void HexCodecBenchmark::detectTextQt()
+{
+    QFETCH(int, bytes);
+    // Hex-looking prefix so the check cannot bail out on the first character
+    QString text = QString::fromLatin1(makeText(bytes / 2).toUtf8().toHex()).left(bytes - 2) + "zz";
+    bool isHex = true;
+    QBENCHMARK {
+        isHex = text.contains(QRegularExpression("^[0-9a-fA-F]+$")) && text.length() % 2 == 0;
+    }
+    QVERIFY(!isHex);
+}
+
+void HexCodecBenchmark::detectTextCodec()
+{
+    QFETCH(int, bytes);
+    QString text = QString::fromLatin1(makeText(bytes / 2).toUtf8().toHex()).left(bytes - 2) + "zz";
+    bool isHex = true;
+    QBENCHMARK {
+        isHex = HexCodec::detectEncoding(text) == HexCodec::ContentEncoding::Hex;
+    }
+    QVERIFY(!isHex);
+}
+
+QTEST_GUILESS_MAIN(HexCodecBenchmark)
+#include "HexCodecBenchmark.moc"
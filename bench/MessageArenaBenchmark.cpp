@@ -0,0 +1,166 @@
+#include "MessageArena.h"
+#include <QRandomGenerator>
+#include <QtTest>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Memory per message of MessageArena against the QList<ChatMessage> it
+// replaced in MessageStore, over a million synthetic messages, and the cost
+// of appending to and reading back from the arena
+class MessageArenaBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void bytesPerMessage();
+
+    void append();
+    void at();
+
+private:
+    static constexpr int kMessages = 1000000;
+    static constexpr int kDistinctTexts = 4096;
+
+    QString makeText(QRandomGenerator& rng) const;
+    // Built the way the ingest path builds them: sender and content are
+    // separate strings for every message
+    ChatMessage makeMessage(int i) const;
+
+    QStringList m_words;
+    QStringList m_texts;
+    QDateTime m_start;
+};
+
+namespace {
+
+// Heap in use, including blocks large enough to be mmapped; -1 if unknown
+qint64 heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+} // namespace
+
+void MessageArenaBenchmark::initTestCase()
+{
+    QRandomGenerator rng(42);
+    static const char consonants[] = "bcdfghklmnprstvz";
+    static const char vowels[] = "aeiou";
+    for (int i = 0; i < 2000; ++i) {
+        QString w;
+        const int syllables = 1 + rng.bounded(3);
+        for (int s = 0; s < syllables; ++s) {
+            w += QLatin1Char(consonants[rng.bounded(int(sizeof(consonants) - 1))]);
+            w += QLatin1Char(vowels[rng.bounded(int(sizeof(vowels) - 1))]);
+        }
+        m_words.append(w);
+    }
+    // A few non-ASCII words, as real chat has
+    m_words << QString::fromUtf8("caf\xc3\xa9") << QString::fromUtf8("\xf0\x9f\x91\x8d")
+            << QString::fromUtf8("\xe3\x81\x82\xe3\x82\x8a\xe3\x81\x8c\xe3\x81\xa8\xe3\x81\x86");
+
+    for (int i = 0; i < kDistinctTexts; ++i) {
+        m_texts.append(makeText(rng));
+    }
+    m_start = QDateTime::currentDateTime().addDays(-30);
+}
+
+QString MessageArenaBenchmark::makeText(QRandomGenerator& rng) const
+{
+    // 1 to 30 words: mostly short messages, some long ones
+    const int words = 1 + rng.bounded(30);
+    QString text;
+    for (int i = 0; i < words; ++i) {
+        if (i > 0) text += QLatin1Char(' ');
+        text += m_words.at(rng.bounded(m_words.size()));
+    }
+    return text;
+}
+
+ChatMessage MessageArenaBenchmark::makeMessage(int i) const
+{
+    const bool isMe = (i % 3) == 0;
+    ChatMessage message;
+    message.sender = isMe ? QString::fromLatin1("Me") : QString::fromLatin1("Peer");
+    // A deep copy, so every message owns its content as decoded ones do
+    const QString& text = m_texts.at(i % kDistinctTexts);
+    message.content = QString(text.constData(), text.size());
+    message.timestamp = m_start.addMSecs(qint64(i) * 1500);
+    message.isMe = isMe;
+    return message;
+}
+
+void MessageArenaBenchmark::bytesPerMessage()
+{
+    if (heapInUse() < 0) {
+        QSKIP("Heap accounting needs glibc 2.33 or later");
+    }
+
+    qint64 utf8Bytes = 0;
+    for (int i = 0; i < kMessages; ++i) {
+        utf8Bytes += m_texts.at(i % kDistinctTexts).toUtf8().size();
+    }
+
+    qint64 listBytes;
+    {
+        const qint64 before = heapInUse();
+        QList<ChatMessage> list;
+        for (int i = 0; i < kMessages; ++i) {
+            list.append(makeMessage(i));
+        }
+        listBytes = heapInUse() - before;
+        QCOMPARE(list.size(), kMessages);
+    }
+
+    qint64 arenaBytes;
+    {
+        const qint64 before = heapInUse();
+        MessageArena arena;
+        for (int i = 0; i < kMessages; ++i) {
+            arena.append(makeMessage(i));
+        }
+        arenaBytes = heapInUse() - before;
+        QCOMPARE(arena.size(), kMessages);
+        QCOMPARE(arena.at(kMessages - 1).content, m_texts.at((kMessages - 1) % kDistinctTexts));
+    }
+
+    qInfo("%d messages, %.1f bytes of UTF-8 content per message", kMessages,
+          double(utf8Bytes) / kMessages);
+    qInfo("QList<ChatMessage>: %.1f bytes per message", double(listBytes) / kMessages);
+    qInfo("MessageArena:       %.1f bytes per message", double(arenaBytes) / kMessages);
+    QVERIFY(arenaBytes < listBytes);
+}
+
+void MessageArenaBenchmark::append()
+{
+    const ChatMessage message = makeMessage(1);
+    MessageArena arena;
+    QBENCHMARK {
+        arena.append(message);
+    }
+}
+
+void MessageArenaBenchmark::at()
+{
+    MessageArena arena;
+    for (int i = 0; i < kDistinctTexts; ++i) {
+        arena.append(makeMessage(i));
+    }
+    int i = 0;
+    qsizetype length = 0;
+    QBENCHMARK {
+        length += arena.at(i++ % kDistinctTexts).content.size();
+    }
+    QVERIFY(length > 0);
+}
+
+QTEST_GUILESS_MAIN(MessageArenaBenchmark)
+#include "MessageArenaBenchmark.moc"
@@ -0,0 +1,142 @@
+#include "SearchIndex.h"
+#include <QRandomGenerator>
+#include <QtTest>
+
+// Query latency of SearchIndex over a million messages, against the linear
+// QString::contains scan it replaces
+class SearchIndexBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void addMessage();
+
+    void query_data();
+    void query();
+    void queryConversation();
+    void linearScan();
+
+private:
+    static constexpr int kMessages = 1000000;
+    static constexpr int kConversations = 200;
+    static constexpr int kVocabulary = 50000;
+
+    QString word(int rank) const { return m_words.at(rank); }
+    QString makeMessage(QRandomGenerator& rng) const;
+
+    QStringList m_words;
+    QStringList m_messages;
+    SearchIndex m_index;
+};
+
+void SearchIndexBenchmark::initTestCase()
+{
+    QRandomGenerator rng(42);
+
+    // Pronounceable words so prefixes overlap the way real text does
+    static const char consonants[] = "bcdfghklmnprstvz";
+    static const char vowels[] = "aeiou";
+    QSet<QString> seen;
+    while (m_words.size() < kVocabulary) {
+        QString w;
+        const int syllables = 1 + rng.bounded(4);
+        for (int s = 0; s < syllables; ++s) {
+            w += QLatin1Char(consonants[rng.bounded(int(sizeof(consonants) - 1))]);
+            w += QLatin1Char(vowels[rng.bounded(int(sizeof(vowels) - 1))]);
+        }
+        if (!seen.contains(w)) {
+            seen.insert(w);
+            m_words.append(w);
+        }
+    }
+
+    m_messages.reserve(kMessages);
+    for (int i = 0; i < kMessages; ++i) {
+        m_messages.append(makeMessage(rng));
+        m_index.addMessage(QString("conversation-%1").arg(i % kConversations),
+                           i / kConversations, m_messages.last());
+    }
+    qInfo() << "Indexed" << m_index.documentCount() << "messages," << m_index.termCount() << "terms";
+}
+
+QString SearchIndexBenchmark::makeMessage(QRandomGenerator& rng) const
+{
+    // Roughly Zipfian: low ranks are common, high ranks rare
+    QStringList parts;
+    const int length = 3 + rng.bounded(12);
+    for (int i = 0; i < length; ++i) {
+        const double u = rng.generateDouble();
+        parts.append(word(int(kVocabulary * u * u * u)));
+    }
+    if (rng.bounded(20) == 0) {
+        parts.append(QString::fromUtf8("\xe4\xbd\xa0\xe5\xa5\xbd\xe4\xb8\x96\xe7\x95\x8c"));
+    }
+    return parts.join(' ');
+}
+
+void SearchIndexBenchmark::addMessage()
+{
+    QRandomGenerator rng(7);
+    QStringList messages;
+    for (int i = 0; i < 10000; ++i) {
+        messages.append(makeMessage(rng));
+    }
+
+    SearchIndex index;
+    qint64 row = 0;
+    QBENCHMARK_ONCE {
+        for (const QString& message : messages) {
+            index.addMessage("conversation", row++, message);
+        }
+    }
+    QCOMPARE(index.documentCount(), qint64(messages.size()));
+}
+
+void SearchIndexBenchmark::query_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::newRow("common term") << word(0) + ' ';
+    QTest::newRow("rare term") << word(kVocabulary - 1) + ' ';
+    QTest::newRow("two terms") << word(10) + ' ' + word(200) + ' ';
+    QTest::newRow("prefix") << word(5).left(3);
+    QTest::newRow("han") << QString::fromUtf8("\xe4\xb8\x96\xe7\x95\x8c");
+}
+
+void SearchIndexBenchmark::query()
+{
+    QFETCH(QString, query);
+    QList<SearchIndex::Hit> hits;
+    QBENCHMARK {
+        hits = m_index.search(query);
+    }
+    QVERIFY(!hits.isEmpty());
+}
+
+void SearchIndexBenchmark::queryConversation()
+{
+    const QString query = word(100) + ' ';
+    QList<SearchIndex::Hit> hits;
+    QBENCHMARK {
+        hits = m_index.search(query, "conversation-17");
+    }
+    QVERIFY(!hits.isEmpty());
+    for (const auto& hit : hits) {
+        QCOMPARE(hit.conversationId, QString("conversation-17"));
+    }
+}
+
+void SearchIndexBenchmark::linearScan()
+{
+    const QString needle = word(kVocabulary - 1);
+    int matches = 0;
+    QBENCHMARK_ONCE {
+        for (const QString& message : m_messages) {
+            if (message.contains(needle, Qt::CaseInsensitive)) ++matches;
+        }
+    }
+    QVERIFY(matches > 0);
+}
+
+QTEST_GUILESS_MAIN(SearchIndexBenchmark)
+#include "SearchIndexBenchmark.moc"
@@ -4,6 +4,7 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QRandomGenerator>
+#include <QStandardPaths>
 #include <cstdlib>
 
 /**
@@ -15,6 +16,15 @@
  *   - CHATSDK_CLUSTER_ID: Waku cluster ID (default: 2)
  *   - CHATSDK_SHARD_ID: Waku shard ID (default: 1)
  *   - CHATSDK_STATIC_PEER: Static peer multiaddr (optional)
+ *   - CHATSDK_PERSIST: Keep message history on disk, 0 to disable (default: 1)
+ *   - CHATSDK_STORE_DIR: Message history directory (default: app data dir)
+ *   - CHATSDK_AUTO_START: Initialize and start chat on launch, 0 to disable (default: 1)
+ *   - CHATSDK_LATENCY_DUMP: File the message latency report is written to on exit (optional)
+ *   - CHATSDK_STALL_THRESHOLD_MS: GUI-thread stall reporting threshold, 0 to disable (default: 0)
+ *   - CHATSDK_LOG_ASYNC: Write chatsdk.ui.* log output from a background thread, 1 to enable (default: 0)
+ *   - CHATSDK_LOG_RATE: Log messages per second per category, 0 for no limit (default: 200)
+ *   - CHATSDK_LOG_MAX_CHARS: Longer log messages are truncated, 0 for no limit (default: 1024)
+ *   - CHATSDK_THEME: "dark" or "light" (default: dark)
  * 
  * Configuration values from libchat.h:
  *   configJson: JSON object with fields:
@@ -54,6 +64,73 @@ inline int getEnvOrDefault(const char* envName, int defaultValue) {
     return defaultValue;
 }
 
+/**
+ * Whether message history is written to disk
+ */
+inline bool persistenceEnabled() {
+    return getEnvOrDefault("CHATSDK_PERSIST", 1) != 0;
+}
+
+/**
+ * Whether the window initializes and starts chat by itself on launch
+ */
+inline bool autoStartEnabled() {
+    return getEnvOrDefault("CHATSDK_AUTO_START", 1) != 0;
+}
+
+/**
+ * Directory holding the message store
+ */
+inline QString storeDirectory() {
+    return getEnvOrDefault("CHATSDK_STORE_DIR",
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/chatsdk_ui");
+}
+
+/**
+ * File to write the message latency report to on exit; empty for none
+ */
+inline QString latencyDumpPath() {
+    return getEnvOrDefault("CHATSDK_LATENCY_DUMP", QString());
+}
+
+/**
+ * Event-loop stall (in ms) reported by the GUI-thread watchdog; 0 disables it.
+ * Off by default: its heartbeat wakes the GUI thread even when idle.
+ */
+inline int stallThresholdMs() {
+    return getEnvOrDefault("CHATSDK_STALL_THRESHOLD_MS", 0);
+}
+
+/**
+ * Whether log output goes through the asynchronous sink (ChatLogging). Off
+ * by default: the sink installs a process-wide message handler, which is the
+ * host's to own.
+ */
+inline bool asyncLoggingEnabled() {
+    return getEnvOrDefault("CHATSDK_LOG_ASYNC", 0) != 0;
+}
+
+/**
+ * Log messages per second allowed per category; 0 for no limit
+ */
+inline int logRatePerCategory() {
+    return getEnvOrDefault("CHATSDK_LOG_RATE", 200);
+}
+
+/**
+ * Log messages longer than this are truncated; 0 for no limit
+ */
+inline int logMaxChars() {
+    return getEnvOrDefault("CHATSDK_LOG_MAX_CHARS", 1024);
+}
+
+/**
+ * Whether the window starts with the light theme instead of the dark one
+ */
+inline bool lightThemeRequested() {
+    return getEnvOrDefault("CHATSDK_THEME", QString("dark")).compare("light", Qt::CaseInsensitive) == 0;
+}
+
 /**
  * Build the configuration JSON string for chat_new()
  * 
@@ -0,0 +1,411 @@
+#include "ChatLogging.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+Q_LOGGING_CATEGORY(lcWindow, "chatsdk.ui.window", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcEvents, "chatsdk.ui.events", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcStore, "chatsdk.ui.store", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcBackend, "chatsdk.ui.backend", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcPerf, "chatsdk.ui.perf", QtInfoMsg)
+
+namespace {
+
+constexpr std::size_t kRingCapacity = 4096;  // Power of two
+constexpr int kRateSlotCount = 64;           // Distinct categories rate-limited
+constexpr qint64 kRateWindowMs = 1000;
+// Only these categories are rate-limited, truncated and written async
+constexpr char kOwnCategoryPrefix[] = "chatsdk.ui.";
+
+// Copies a context string, which is only valid during the handler call,
+// truncating it to the buffer
+template <std::size_t N>
+void copyContextString(char (&buffer)[N], const char* text)
+{
+    if (text) {
+        qstrncpy(buffer, text, N);
+    } else {
+        buffer[0] = '\0';
+    }
+}
+
+template <std::size_t N>
+const char* contextString(const char (&buffer)[N])
+{
+    return buffer[0] ? buffer : nullptr;
+}
+
+struct Record {
+    QtMsgType type = QtDebugMsg;
+    // Copied in: QML, JS and runtime-built categories pass strings that do
+    // not outlive the handler call
+    char category[64] = {};
+    char file[128] = {};
+    char function[128] = {};
+    int line = 0;
+    QString message;
+};
+
+/**
+ * Bounded multi-producer ring (Vyukov). Each cell carries a sequence number
+ * that says whose turn it is, so producers only contend on one atomic
+ * increment and never wait for each other. A single consumer drains it.
+ */
+class LogRing {
+public:
+    LogRing()
+    {
+        for (std::size_t i = 0; i < kRingCapacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(Record&& record)
+    {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & (kRingCapacity - 1)];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = std::intptr_t(sequence) - std::intptr_t(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = std::move(record);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool isEmpty() const
+    {
+        const Cell& cell = m_cells[m_dequeuePos & (kRingCapacity - 1)];
+        return cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+    // Consumer thread only
+    bool pop(Record& record)
+    {
+        Cell& cell = m_cells[m_dequeuePos & (kRingCapacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+            return false;
+        }
+        record = std::move(cell.record);
+        cell.sequence.store(m_dequeuePos + kRingCapacity, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+
+    Cell m_cells[kRingCapacity];
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(64) std::size_t m_dequeuePos = 0;
+};
+
+struct RateSlot {
+    std::atomic<const char*> category{nullptr};
+    std::atomic<qint64> windowStartMs{0};
+    std::atomic<int> count{0};
+    std::atomic<int> suppressed{0};
+};
+
+qint64 monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+thread_local bool t_onWriterThread = false;
+
+class AsyncSink {
+public:
+    void start(int maxPerSecond, int maxChars)
+    {
+        m_maxPerSecond = maxPerSecond;
+        m_maxChars = maxChars;
+        m_running.store(true, std::memory_order_release);
+        m_writer = QThread::create([this]() { writeLoop(); });
+        m_writer->setObjectName("ChatSDKLogWriter");
+        m_writer->start(QThread::LowPriority);
+        m_previous = qInstallMessageHandler(&AsyncSink::messageHandler);
+        m_active.store(true, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        // Restore first; a message already inside handle() still sees a
+        // live ring, and the writer drains it before exiting
+        qInstallMessageHandler(m_previous);
+        m_active.store(false, std::memory_order_release);
+        m_running.store(false, std::memory_order_release);
+        wakeWriter();
+        m_writer->wait();
+        delete m_writer;
+        m_writer = nullptr;
+    }
+
+    ChatLogging::SinkStats stats() const
+    {
+        ChatLogging::SinkStats stats;
+        stats.written = m_written.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped.load(std::memory_order_relaxed);
+        stats.rateLimited = m_rateLimited.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    static AsyncSink& instance()
+    {
+        // Never destroyed, so a late message cannot reach a dead sink
+        static AsyncSink* sink = new AsyncSink();
+        return *sink;
+    }
+
+private:
+    static void messageHandler(QtMsgType type, const QMessageLogContext& context,
+                               const QString& message)
+    {
+        instance().handle(type, context, message);
+    }
+
+    void handle(QtMsgType type, const QMessageLogContext& context, const QString& message)
+    {
+        if (type == QtFatalMsg || t_onWriterThread ||
+            !m_active.load(std::memory_order_acquire) || !isOwnCategory(context.category)) {
+            forward(type, context, message);
+            return;
+        }
+        if (type != QtCriticalMsg && !allow(context.category)) {
+            return;
+        }
+
+        Record record;
+        record.type = type;
+        copyContextString(record.category, context.category);
+        copyContextString(record.file, context.file);
+        copyContextString(record.function, context.function);
+        record.line = context.line;
+        record.message = message.size() > m_maxChars && m_maxChars > 0
+            ? ChatLogging::truncated(message, m_maxChars)
+            : message;
+        if (!enqueue(std::move(record))) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool enqueue(Record&& record)
+    {
+        if (!m_ring.push(std::move(record))) {
+            return false;
+        }
+        wakeWriter();
+        return true;
+    }
+
+    // The writer sets m_parked, then checks the ring; producers push, then
+    // check m_parked. The fences keep one of the two from missing the
+    // other, and whichever side clears m_parked owns the single release.
+    void wakeWriter()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_parked.load(std::memory_order_relaxed) && m_parked.exchange(false)) {
+            m_wakeup.release();
+        }
+    }
+
+    void park()
+    {
+        m_parked.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_ring.isEmpty() && m_running.load(std::memory_order_acquire)) {
+            m_wakeup.acquire();
+        } else if (!m_parked.exchange(false)) {
+            // A producer cleared it first and is releasing
+            m_wakeup.acquire();
+        }
+    }
+
+    static bool isOwnCategory(const char* category)
+    {
+        return category && qstrncmp(category, kOwnCategoryPrefix,
+                                    sizeof(kOwnCategoryPrefix) - 1) == 0;
+    }
+
+    // Fixed window of kRateWindowMs per category. Whoever rolls the window
+    // over reports what the previous one suppressed.
+    bool allow(const char* category)
+    {
+        if (m_maxPerSecond <= 0 || !category) {
+            return true;
+        }
+        RateSlot* slot = slotFor(category);
+        if (!slot) {
+            return true;
+        }
+
+        const qint64 now = monotonicMs();
+        qint64 windowStart = slot->windowStartMs.load(std::memory_order_relaxed);
+        if (now - windowStart >= kRateWindowMs &&
+            slot->windowStartMs.compare_exchange_strong(windowStart, now)) {
+            slot->count.store(0, std::memory_order_relaxed);
+            const int suppressed = slot->suppressed.exchange(0);
+            if (suppressed > 0) {
+                Record notice;
+                notice.type = QtWarningMsg;
+                copyContextString(notice.category, category);
+                notice.message = QString("%1 messages suppressed by the log rate limit "
+                                         "(%2 per second)")
+                                     .arg(suppressed)
+                                     .arg(m_maxPerSecond);
+                enqueue(std::move(notice));
+            }
+        }
+
+        if (slot->count.fetch_add(1, std::memory_order_relaxed) < m_maxPerSecond) {
+            return true;
+        }
+        slot->suppressed.fetch_add(1, std::memory_order_relaxed);
+        m_rateLimited.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Open addressing on the category name pointer; the plugin's categories
+    // are statics
+    RateSlot* slotFor(const char* category)
+    {
+        const std::size_t hash = std::hash<const void*>()(category);
+        for (int probe = 0; probe < kRateSlotCount; ++probe) {
+            RateSlot& slot = m_rateSlots[(hash + probe) % kRateSlotCount];
+            const char* owner = slot.category.load(std::memory_order_acquire);
+            if (owner == category) {
+                return &slot;
+            }
+            if (!owner) {
+                const char* expected = nullptr;
+                if (slot.category.compare_exchange_strong(expected, category) ||
+                    expected == category) {
+                    return &slot;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void forward(QtMsgType type, const QMessageLogContext& context, const QString& message)
+    {
+        if (m_previous) {
+            m_previous(type, context, message);
+        } else {
+            std::fprintf(stderr, "%s\n", qPrintable(qFormatLogMessage(type, context, message)));
+        }
+    }
+
+    void writeLoop()
+    {
+        t_onWriterThread = true;
+        for (;;) {
+            const bool stopping = !m_running.load(std::memory_order_acquire);
+            Record record;
+            while (m_ring.pop(record)) {
+                const QMessageLogContext context(contextString(record.file), record.line,
+                                                 contextString(record.function),
+                                                 contextString(record.category));
+                forward(record.type, context, record.message);
+                m_written.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (stopping) {
+                break;
+            }
+            // Sleeps until a record is pushed or the sink stops
+            park();
+        }
+    }
+
+    LogRing m_ring;
+    RateSlot m_rateSlots[kRateSlotCount];
+    QtMessageHandler m_previous = nullptr;
+    QThread* m_writer = nullptr;
+    int m_maxPerSecond = 0;
+    int m_maxChars = 0;
+    std::atomic<bool> m_active{false};
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_parked{false};
+    QSemaphore m_wakeup;
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_rateLimited{0};
+};
+
+QMutex s_installMutex;
+int s_installCount = 0;
+
+} // namespace
+
+namespace ChatLogging {
+
+void installAsyncSink(int maxPerSecondPerCategory, int maxMessageChars)
+{
+    QMutexLocker locker(&s_installMutex);
+    if (s_installCount++ == 0) {
+        AsyncSink::instance().start(maxPerSecondPerCategory, maxMessageChars);
+    }
+}
+
+void releaseAsyncSink()
+{
+    QMutexLocker locker(&s_installMutex);
+    if (s_installCount > 0 && --s_installCount == 0) {
+        AsyncSink::instance().stop();
+    }
+}
+
+SinkStats sinkStats()
+{
+    return AsyncSink::instance().stats();
+}
+
+QString truncated(const QString& text, int maxChars)
+{
+    if (maxChars <= 0 || text.size() <= maxChars) {
+        return text;
+    }
+    return text.left(maxChars) + QString("... (+%1 chars)").arg(text.size() - maxChars);
+}
+
+QString truncated(const QVariantList& data, int maxChars)
+{
+    QStringList parts;
+    int budget = maxChars;
+    for (const QVariant& value : data) {
+        if (budget <= 0) {
+            parts.append("...");
+            break;
+        }
+        const QString text = truncated(value.toString(), budget);
+        budget -= text.size();
+        parts.append(text);
+    }
+    return "[" + parts.join(", ") + "]";
+}
+
+} // namespace ChatLogging
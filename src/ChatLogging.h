@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QLoggingCategory>
+#include <QString>
+#include <QVariantList>
+
+// Debug output is off by default in every category; turn it on with e.g.
+// QT_LOGGING_RULES="chatsdk.ui.events.debug=true". qCDebug() checks the
+// category before evaluating its arguments, so a disabled category costs a
+// load and a branch.
+Q_DECLARE_LOGGING_CATEGORY(lcWindow)   // chatsdk.ui.window: lifecycle, results
+Q_DECLARE_LOGGING_CATEGORY(lcEvents)   // chatsdk.ui.events: per-message hot path
+Q_DECLARE_LOGGING_CATEGORY(lcStore)    // chatsdk.ui.store: message store
+Q_DECLARE_LOGGING_CATEGORY(lcBackend)  // chatsdk.ui.backend: fake backend
+Q_DECLARE_LOGGING_CATEGORY(lcPerf)     // chatsdk.ui.perf: stall watchdog
+
+/**
+ * Asynchronous log sink, opt-in.
+ *
+ * Installing it replaces the process-wide Qt message handler, but only
+ * messages in the plugin's own chatsdk.ui.* categories are handled here;
+ * everything else, from the host or other plugins, goes to the previously
+ * installed handler unchanged and at once.
+ *
+ * For the plugin's messages, the handler only truncates the message,
+ * applies a per-category rate limit and pushes the record into a bounded
+ * lock-free ring buffer. A writer thread hands records to the previously
+ * installed handler, so output format and destination do not change. When
+ * the ring is full, messages are dropped and counted rather than blocking
+ * the caller. Fatal messages, and messages logged from the writer thread,
+ * go to the previous handler directly.
+ *
+ * Configured through CHATSDK_LOG_ASYNC, CHATSDK_LOG_RATE and
+ * CHATSDK_LOG_MAX_CHARS (see ChatConfig).
+ */
+namespace ChatLogging {
+
+struct SinkStats {
+    quint64 written = 0;
+    quint64 dropped = 0;      // Ring buffer full
+    quint64 rateLimited = 0;  // Over the per-category rate
+};
+
+// Reference counted; the last release drains the ring buffer and restores
+// the previous handler
+void installAsyncSink(int maxPerSecondPerCategory, int maxMessageChars);
+void releaseAsyncSink();
+SinkStats sinkStats();
+
+// Shortened payloads for log lines: the first maxChars characters and the
+// number cut off
+QString truncated(const QString& text, int maxChars = 160);
+QString truncated(const QVariantList& data, int maxChars = 160);
+
+} // namespace ChatLogging
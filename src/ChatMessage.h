@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+
+// A single chat message as kept by the store and shown in the timeline
+struct ChatMessage {
+    // Delivery of an outgoing message. The store keeps the last one
+    // recorded, so a restart shows what was known when the app closed.
+    enum class SendState : quint8 {
+        Sent,
+        Pending,     // In the outbox, or handed over and awaiting its result
+        Failed,      // Gave up after the last retry
+        Unconfirmed  // Was pending when an earlier session ended; never stored
+    };
+
+    QString sender;
+    QString content;
+    QDateTime timestamp;
+    bool isMe = false;
+    SendState sendState = SendState::Sent;
+};
@@ -1,15 +1,42 @@
 #include "ChatPanel.h"
-#include "MessageBubble.h"
+#include "MessageBubbleDelegate.h"
+#include "StallWatchdog.h"
+#include "TimelineScrollController.h"
+#include "Theme.h"
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QResizeEvent>
 #include <QStackedWidget>
 #include <QScrollBar>
 #include <QTimer>
+#include <algorithm>
+
+namespace {
+// Ask for another page once the view is this close to either end
+constexpr int kPageThresholdPx = 200;
+// Rows are measured again once the viewport has kept its size this long
+constexpr int kResizeSettleMs = 150;
+}
 
 ChatPanel::ChatPanel(QWidget* parent)
     : QWidget(parent)
+    , m_hasOlderMessages(false)
+    , m_olderRequestPending(false)
+    , m_hasNewerMessages(false)
+    , m_newerRequestPending(false)
+    , m_scroller(nullptr)
+    , m_resizeTimer(nullptr)
+    , m_nextUpdateId(1)
 {
     setupUI();
 }
 
+QWidget* ChatPanel::timelineViewport() const
+{
+    return m_messageView->viewport();
+}
+
 void ChatPanel::setupUI()
 {
     m_mainLayout = new QVBoxLayout(this);
@@ -31,16 +58,12 @@ void ChatPanel::setupUI()
 void ChatPanel::setupEmptyState()
 {
     m_emptyStateWidget = new QWidget(this);
-    m_emptyStateWidget->setStyleSheet("background-color: #0A0A0A;");
+    m_emptyStateWidget->setObjectName(Theme::EmptyState);
     QVBoxLayout* emptyLayout = new QVBoxLayout(m_emptyStateWidget);
 
     m_emptyStateLabel = new QLabel("Select a conversation or start a new one", m_emptyStateWidget);
     m_emptyStateLabel->setAlignment(Qt::AlignCenter);
-    QFont emptyFont("JetBrains Mono", 14);
-    emptyFont.setStyleHint(QFont::Monospace);
-    emptyFont.setItalic(true);
-    m_emptyStateLabel->setFont(emptyFont);
-    m_emptyStateLabel->setStyleSheet("color: #6B7280; background: transparent;");
+    m_emptyStateLabel->setFont(Theme::instance().emptyStateFont());
 
     emptyLayout->addStretch();
     emptyLayout->addWidget(m_emptyStateLabel);
@@ -54,112 +77,80 @@ void ChatPanel::setupChatState()
     m_chatLayout->setContentsMargins(0, 0, 0, 0);
     m_chatLayout->setSpacing(0);
 
-    // Title header - terminal theme
+    // Title header
     QWidget* headerWidget = new QWidget(m_chatStateWidget);
+    headerWidget->setObjectName(Theme::PanelHeader);
     headerWidget->setFixedHeight(50);
-    headerWidget->setStyleSheet("background-color: #0A0A0A; border-bottom: 1px solid #2a2a2a;");
     QHBoxLayout* headerLayout = new QHBoxLayout(headerWidget);
     headerLayout->setContentsMargins(15, 0, 15, 0);
 
     m_titleLabel = new QLabel("", headerWidget);
-    m_titleLabel->setStyleSheet("color: #FAFAFA; background: transparent;");
-    QFont titleFont("JetBrains Mono", 14);
-    titleFont.setStyleHint(QFont::Monospace);
-    titleFont.setBold(true);
-    m_titleLabel->setFont(titleFont);
+    m_titleLabel->setObjectName(Theme::PanelTitle);
+    m_titleLabel->setFont(Theme::instance().titleFont());
     headerLayout->addWidget(m_titleLabel);
     headerLayout->addStretch();
 
-    // Messages scroll area - terminal theme
-    m_scrollArea = new QScrollArea(m_chatStateWidget);
-    m_scrollArea->setWidgetResizable(true);
-    m_scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    m_scrollArea->setStyleSheet(
-        "QScrollArea {"
-        "  border: none;"
-        "  background-color: #0A0A0A;"
-        "}"
-        "QScrollBar:vertical {"
-        "  background-color: #0A0A0A;"
-        "  width: 8px;"
-        "  margin: 0px;"
-        "}"
-        "QScrollBar::handle:vertical {"
-        "  background-color: #2a2a2a;"
-        "  border-radius: 4px;"
-        "  min-height: 20px;"
-        "}"
-        "QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {"
-        "  height: 0px;"
-        "}"
-    );
-
-    m_messagesContainer = new QWidget(m_scrollArea);
-    m_messagesContainer->setStyleSheet("background-color: #0A0A0A;");
-    m_messagesLayout = new QVBoxLayout(m_messagesContainer);
-    m_messagesLayout->setContentsMargins(16, 16, 16, 16);
-    m_messagesLayout->setSpacing(5);
-    m_messagesLayout->addStretch();
-
-    m_scrollArea->setWidget(m_messagesContainer);
-
-    // Input area - terminal theme
+    // Message timeline. Rows are painted by the delegate, so only the visible
+    // messages cost anything beyond their model record.
+    m_messageModel = new MessageListModel(this);
+    m_messageDelegate = new MessageBubbleDelegate(this);
+
+    m_messageView = new QListView(m_chatStateWidget);
+    m_messageView->setObjectName(Theme::Timeline);
+    m_messageView->setModel(m_messageModel);
+    m_messageView->setItemDelegate(m_messageDelegate);
+    m_messageView->setUniformItemSizes(false);
+    // Rows are not laid out again per resize event; see eventFilter()
+    m_messageView->setResizeMode(QListView::Fixed);
+    m_messageView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_messageView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_messageView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_messageView->setFocusPolicy(Qt::ClickFocus);
+    m_messageView->setContextMenuPolicy(Qt::ActionsContextMenu);
+    m_messageView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_messageView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+    // Bubbles are painted, not QLabels, so offer copy instead of text selection
+    QAction* copyAction = new QAction("Copy", m_messageView);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    connect(copyAction, &QAction::triggered, this, &ChatPanel::copySelectedMessages);
+    m_messageView->addAction(copyAction);
+
+    // Follows new messages only while the view is at the bottom
+    m_scroller = new TimelineScrollController(m_messageView, this);
+    m_messageView->addAction(m_scroller->jumpAction());
+
+    connect(m_messageView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &ChatPanel::onScrolled);
+
+    m_resizeTimer = new QTimer(this);
+    m_resizeTimer->setSingleShot(true);
+    m_resizeTimer->setInterval(kResizeSettleMs);
+    connect(m_resizeTimer, &QTimer::timeout, this, &ChatPanel::onResizeSettled);
+    m_messageView->viewport()->installEventFilter(this);
+
+    // Input area
     m_inputWidget = new QWidget(m_chatStateWidget);
+    m_inputWidget->setObjectName(Theme::Composer);
     m_inputWidget->setFixedHeight(68);
-    m_inputWidget->setStyleSheet("background-color: #0A0A0A; border-top: 1px solid #2a2a2a;");
     m_inputLayout = new QHBoxLayout(m_inputWidget);
     m_inputLayout->setContentsMargins(15, 10, 15, 10);
     m_inputLayout->setSpacing(10);
 
     m_messageInput = new QLineEdit(m_inputWidget);
     m_messageInput->setPlaceholderText("Type a message...");
-    m_messageInput->setStyleSheet(
-        "QLineEdit {"
-        "  border: 1px solid #2a2a2a;"
-        "  border-radius: 4px;"
-        "  padding: 10px 15px;"
-        "  background-color: #0F0F0F;"
-        "  color: #FAFAFA;"
-        "  font-size: 13px;"
-        "}"
-        "QLineEdit:focus {"
-        "  border-color: #10B981;"
-        "}"
-        "QLineEdit::placeholder {"
-        "  color: #4B5563;"
-        "}"
-    );
 
     m_sendButton = new QPushButton(">>", m_inputWidget);
+    m_sendButton->setObjectName(Theme::AccentButton);
     m_sendButton->setFixedWidth(48);
-    m_sendButton->setStyleSheet(
-        "QPushButton {"
-        "  background-color: #10B981;"
-        "  color: #0A0A0A;"
-        "  border: none;"
-        "  border-radius: 4px;"
-        "  font-size: 16px;"
-        "  font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #34D399;"
-        "}"
-        "QPushButton:pressed {"
-        "  background-color: #059669;"
-        "}"
-        "QPushButton:disabled {"
-        "  background-color: #1F1F1F;"
-        "  color: #4B5563;"
-        "}"
-    );
 
     m_inputLayout->addWidget(m_messageInput, 1);
     m_inputLayout->addWidget(m_sendButton);
 
     // Add widgets to chat layout
     m_chatLayout->addWidget(headerWidget);
-    m_chatLayout->addWidget(m_scrollArea, 1);
+    m_chatLayout->addWidget(m_messageView, 1);
     m_chatLayout->addWidget(m_inputWidget);
 
     // Connect signals
@@ -207,29 +198,217 @@ void ChatPanel::clearConversation()
 void ChatPanel::addMessage(const QString& sender, const QString& content, 
                            const QDateTime& timestamp, bool isMe)
 {
-    Q_UNUSED(sender);
-    
-    // Insert message before the stretch
-    int insertIndex = m_messagesLayout->count() - 1;
-    if (insertIndex < 0) insertIndex = 0;
+    addMessage({sender, content, timestamp, isMe});
+}
 
-    MessageBubble* bubble = new MessageBubble(content, timestamp, isMe, m_messagesContainer);
-    m_messagesLayout->insertWidget(insertIndex, bubble);
+void ChatPanel::addMessage(const MessageListModel::Message& message)
+{
+    afterPendingPages([this, message]() {
+        m_scroller->noteAppend(1, message.isMe);
+        m_messageModel->appendMessage(message);
+    });
+}
 
-    // Scroll to bottom after a short delay to ensure layout is updated
-    QTimer::singleShot(10, this, &ChatPanel::scrollToBottom);
+void ChatPanel::setSendState(int row, ChatMessage::SendState state)
+{
+    afterPendingPages([this, row, state]() { m_messageModel->setSendState(row, state); });
 }
 
-void ChatPanel::clearMessages()
+void ChatPanel::addMessages(const QList<MessageListModel::Message>& messages)
 {
-    // Remove all widgets except the stretch
-    while (m_messagesLayout->count() > 1) {
-        QLayoutItem* item = m_messagesLayout->takeAt(0);
-        if (item->widget()) {
-            delete item->widget();
+    if (messages.isEmpty()) return;
+
+    afterPendingPages([this, messages]() {
+        StallWatchdog::Scope stallScope("ChatPanel::addMessages", messages.size(), "messages");
+        // One model insertion for the whole batch; the scroll controller
+        // settles the scroll position once per frame
+        m_scroller->noteAppend(messages.size(), false);
+        m_messageModel->appendMessages(messages);
+    });
+}
+
+void ChatPanel::setMessages(const QList<MessageListModel::Message>& messages, bool hasOlder)
+{
+    // Replaces whatever was still waiting
+    m_deferredUpdates.clear();
+    afterLayouts(messages, [this, messages, hasOlder]() {
+        StallWatchdog::Scope stallScope("ChatPanel::setMessages", messages.size(), "messages");
+        m_hasOlderMessages = hasOlder;
+        m_olderRequestPending = false;
+        m_hasNewerMessages = false;
+        m_newerRequestPending = false;
+        m_scroller->reset();
+        m_messageModel->setMessages(messages);
+
+        // A short first page may not fill the view, in which case there is
+        // nothing to scroll and the next page has to be asked for directly
+        QTimer::singleShot(10, this, [this]() {
+            scrollToBottom();
+            requestOlderIfNeeded();
+        });
+    });
+}
+
+void ChatPanel::prependMessages(const QList<MessageListModel::Message>& messages, bool hasOlder)
+{
+    afterLayouts(messages, [this, messages, hasOlder]() {
+        StallWatchdog::Scope stallScope("ChatPanel::prependMessages", messages.size(),
+                                        "messages");
+        m_hasOlderMessages = hasOlder;
+        m_olderRequestPending = false;
+        if (messages.isEmpty()) return;
+
+        // Rows below the insertion point are unchanged, so holding the
+        // distance to the bottom keeps the same messages on screen. The new
+        // rows are shaped, so they are laid out here and the position is put
+        // back at once, whether or not the scroll range changes.
+        QScrollBar* scrollBar = m_messageView->verticalScrollBar();
+        const int fromBottom = scrollBar->maximum() - scrollBar->value();
+        m_scroller->notePrepend(messages.size());
+        m_messageModel->prependMessages(messages);
+        m_messageView->doItemsLayout();
+        scrollBar->setValue(scrollBar->maximum() - fromBottom);
+
+        QTimer::singleShot(0, this, &ChatPanel::requestOlderIfNeeded);
+    });
+}
+
+void ChatPanel::appendNewerMessages(const QList<MessageListModel::Message>& messages, bool hasNewer)
+{
+    afterLayouts(messages, [this, messages, hasNewer]() {
+        StallWatchdog::Scope stallScope("ChatPanel::appendNewerMessages", messages.size(),
+                                        "messages");
+        m_hasNewerMessages = hasNewer;
+        m_newerRequestPending = false;
+
+        // Rows go below the viewport, so the scroll position already holds
+        m_messageModel->appendMessages(messages);
+        QTimer::singleShot(0, this, &ChatPanel::requestNewerIfNeeded);
+    });
+}
+
+void ChatPanel::showMessagesAround(const QList<MessageListModel::Message>& messages,
+                                   bool hasOlder, bool hasNewer, int focusRow)
+{
+    m_deferredUpdates.clear();
+    afterLayouts(messages, [this, messages, hasOlder, hasNewer, focusRow]() {
+        StallWatchdog::Scope stallScope("ChatPanel::showMessagesAround", messages.size(),
+                                        "messages");
+        m_hasOlderMessages = hasOlder;
+        m_olderRequestPending = false;
+        m_hasNewerMessages = hasNewer;
+        m_newerRequestPending = false;
+        m_scroller->reset();
+        m_messageModel->setMessages(messages);
+
+        // scrollTo() runs the view's pending layout itself
+        const QModelIndex focus = m_messageModel->index(focusRow, 0);
+        if (!focus.isValid()) return;
+        m_messageView->scrollTo(focus, QAbstractItemView::PositionAtCenter);
+        m_messageView->selectionModel()->setCurrentIndex(
+            focus, QItemSelectionModel::ClearAndSelect);
+    });
+}
+
+ChatPanel::TimelineState ChatPanel::timelineState()
+{
+    // A page still being shaped is shown now rather than lost
+    applyAllUpdates();
+
+    const QScrollBar* scrollBar = m_messageView->verticalScrollBar();
+    TimelineState state;
+    state.messages = m_messageModel->messages();
+    state.hasOlder = m_hasOlderMessages;
+    state.hasNewer = m_hasNewerMessages;
+    state.atBottom = m_scroller->isAtBottom();
+    state.scrollValue = scrollBar->value();
+    return state;
+}
+
+void ChatPanel::restoreTimeline(const TimelineState& state)
+{
+    m_deferredUpdates.clear();
+    // Rows were shaped before unless the cache has dropped them since
+    afterLayouts(state.messages, [this, state]() {
+        StallWatchdog::Scope stallScope("ChatPanel::restoreTimeline", state.messages.size(),
+                                        "messages");
+        m_hasOlderMessages = state.hasOlder;
+        m_olderRequestPending = false;
+        m_hasNewerMessages = state.hasNewer;
+        m_newerRequestPending = false;
+        m_scroller->reset();
+        m_messageModel->setMessages(state.messages);
+
+        // Laid out here, from cached layouts, so the position is put back
+        // at once; waiting for a range change misses a range that stays put
+        m_messageView->doItemsLayout();
+        QScrollBar* scrollBar = m_messageView->verticalScrollBar();
+        scrollBar->setValue(state.atBottom ? scrollBar->maximum() : state.scrollValue);
+    });
+}
+
+void ChatPanel::prefetchLayouts(const QList<MessageListModel::Message>& messages)
+{
+    m_messageDelegate->prefetchLayouts(messages, m_messageView);
+}
+
+void ChatPanel::afterLayouts(const QList<MessageListModel::Message>& page,
+                             std::function<void()> apply)
+{
+    const quint64 id = m_nextUpdateId++;
+    m_deferredUpdates.append({id, false, std::move(apply)});
+    // The delegate is ours, so its callback cannot outlive this panel
+    if (m_messageDelegate->prefetchLayouts(page, m_messageView,
+                                           [this, id]() { onLayoutsReady(id); })) {
+        m_deferredUpdates.last().ready = true;
+    }
+    applyReadyUpdates();
+}
+
+void ChatPanel::afterPendingPages(std::function<void()> apply)
+{
+    if (m_deferredUpdates.isEmpty()) {
+        apply();
+        return;
+    }
+    m_deferredUpdates.append({m_nextUpdateId++, true, std::move(apply)});
+}
+
+void ChatPanel::onLayoutsReady(quint64 updateId)
+{
+    // Updates dropped by a later replacement are not found
+    for (DeferredUpdate& update : m_deferredUpdates) {
+        if (update.id == updateId) {
+            update.ready = true;
+            break;
         }
-        delete item;
     }
+    applyReadyUpdates();
+}
+
+void ChatPanel::applyReadyUpdates()
+{
+    while (!m_deferredUpdates.isEmpty() && m_deferredUpdates.first().ready) {
+        m_deferredUpdates.takeFirst().apply();
+    }
+}
+
+void ChatPanel::applyAllUpdates()
+{
+    while (!m_deferredUpdates.isEmpty()) {
+        m_deferredUpdates.takeFirst().apply();
+    }
+}
+
+void ChatPanel::clearMessages()
+{
+    m_deferredUpdates.clear();
+    m_hasOlderMessages = false;
+    m_olderRequestPending = false;
+    m_hasNewerMessages = false;
+    m_newerRequestPending = false;
+    m_scroller->reset();
+    m_messageModel->clear();
 }
 
 void ChatPanel::onSendClicked()
@@ -239,11 +418,10 @@ void ChatPanel::onSendClicked()
         return;
     }
 
+    // The receiver adds it, pending, before this returns; sending happens
+    // off the GUI thread, so the input is free again at once
     emit messageSent(m_currentConversationId, content);
 
-    // Add the message to the UI immediately (optimistic update)
-    addMessage("Me", content, QDateTime::currentDateTime(), true);
-
     m_messageInput->clear();
     m_messageInput->setFocus();
 }
@@ -253,8 +431,86 @@ void ChatPanel::onReturnPressed()
     onSendClicked();
 }
 
+bool ChatPanel::eventFilter(QObject* watched, QEvent* event)
+{
+    // While the window is dragged, text keeps wrapping at the width the rows
+    // were measured at, so each step only moves the visible bubbles
+    if (watched == m_messageView->viewport() && event->type() == QEvent::Resize) {
+        const int oldWidth = static_cast<QResizeEvent*>(event)->oldSize().width();
+        if (!m_resizeTimer->isActive() && oldWidth > 0) {
+            m_messageDelegate->setLayoutWidth(oldWidth);
+        }
+        m_resizeTimer->start();
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ChatPanel::onResizeSettled()
+{
+    StallWatchdog::Scope stallScope("ChatPanel::onResizeSettled", m_messageModel->rowCount(),
+                                    "messages");
+    m_messageDelegate->setLayoutWidth(0);
+    m_messageView->doItemsLayout();
+}
+
 void ChatPanel::scrollToBottom()
 {
-    QScrollBar* scrollBar = m_scrollArea->verticalScrollBar();
-    scrollBar->setValue(scrollBar->maximum());
+    StallWatchdog::Scope stallScope("ChatPanel::scrollToBottom");
+    m_scroller->scrollToBottom();
+}
+
+void ChatPanel::onScrolled(int value)
+{
+    // Deferred so pages are not inserted from inside a scroll update
+    if (value <= kPageThresholdPx && m_hasOlderMessages && !m_olderRequestPending) {
+        QTimer::singleShot(0, this, &ChatPanel::requestOlderIfNeeded);
+    }
+    const int fromBottom = m_messageView->verticalScrollBar()->maximum() - value;
+    if (fromBottom <= kPageThresholdPx && m_hasNewerMessages && !m_newerRequestPending) {
+        QTimer::singleShot(0, this, &ChatPanel::requestNewerIfNeeded);
+    }
+}
+
+void ChatPanel::requestOlderIfNeeded()
+{
+    // Asked again once the page being shaped is in
+    if (!m_hasOlderMessages || m_olderRequestPending || m_currentConversationId.isEmpty() ||
+        !m_deferredUpdates.isEmpty()) {
+        return;
+    }
+    if (m_messageView->verticalScrollBar()->value() > kPageThresholdPx) {
+        return;
+    }
+
+    m_olderRequestPending = true;
+    emit olderMessagesRequested(m_currentConversationId);
+}
+
+void ChatPanel::requestNewerIfNeeded()
+{
+    if (!m_hasNewerMessages || m_newerRequestPending || m_currentConversationId.isEmpty() ||
+        !m_deferredUpdates.isEmpty()) {
+        return;
+    }
+    const QScrollBar* scrollBar = m_messageView->verticalScrollBar();
+    if (scrollBar->maximum() - scrollBar->value() > kPageThresholdPx) {
+        return;
+    }
+
+    m_newerRequestPending = true;
+    emit newerMessagesRequested(m_currentConversationId);
+}
+
+void ChatPanel::copySelectedMessages()
+{
+    QModelIndexList selected = m_messageView->selectionModel()->selectedRows();
+    if (selected.isEmpty()) return;
+
+    std::sort(selected.begin(), selected.end());
+    QStringList lines;
+    lines.reserve(selected.size());
+    for (const QModelIndex& index : selected) {
+        lines.append(index.data(MessageListModel::ContentRole).toString());
+    }
+    QApplication::clipboard()->setText(lines.join('\n'));
 }
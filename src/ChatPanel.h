@@ -6,9 +6,15 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QScrollArea>
+#include <QListView>
 #include <QStackedWidget>
 #include <QDateTime>
+#include <functional>
+#include "MessageListModel.h"
+
+class MessageBubbleDelegate;
+class QTimer;
+class TimelineScrollController;
 
 class ChatPanel : public QWidget {
     Q_OBJECT
@@ -17,25 +23,77 @@ public:
     explicit ChatPanel(QWidget* parent = nullptr);
     ~ChatPanel() = default;
 
+    // Viewport the timeline is painted on
+    QWidget* timelineViewport() const;
+
 signals:
+    // The receiver stores and sends the message, and adds it to the timeline
+    // with addMessage() when the newest page is shown
     void messageSent(const QString& conversationId, const QString& content);
+    // Scrolled near the top of the loaded history; answer with prependMessages()
+    void olderMessagesRequested(const QString& conversationId);
+    // Scrolled near the bottom of a page that is not the newest; answer with
+    // appendNewerMessages()
+    void newerMessagesRequested(const QString& conversationId);
 
 public slots:
     void setConversation(const QString& id, const QString& name);
     void clearConversation();
     void addMessage(const QString& sender, const QString& content, 
                     const QDateTime& timestamp, bool isMe);
+    void addMessage(const MessageListModel::Message& message);
+    // Delivery state of the outgoing message at a row of the loaded page
+    void setSendState(int row, ChatMessage::SendState state);
+    void addMessages(const QList<MessageListModel::Message>& messages);
+    // Replace the timeline with the newest page of a conversation
+    void setMessages(const QList<MessageListModel::Message>& messages, bool hasOlder);
+    // Insert an older page above the loaded rows, keeping the viewport still
+    void prependMessages(const QList<MessageListModel::Message>& messages, bool hasOlder);
+    void appendNewerMessages(const QList<MessageListModel::Message>& messages, bool hasNewer);
+    // Replace the timeline with a page from the middle of the history and
+    // centre and select focusRow (a row of that page)
+    void showMessagesAround(const QList<MessageListModel::Message>& messages,
+                            bool hasOlder, bool hasNewer, int focusRow);
+
+    // What the timeline shows, kept while another conversation is open so
+    // that switching back does not reload it
+    struct TimelineState {
+        QList<MessageListModel::Message> messages;
+        bool hasOlder = false;
+        bool hasNewer = false;
+        bool atBottom = true;  // Follows new messages; scrollValue is ignored
+        int scrollValue = 0;
+    };
+    // Applies updates still waiting for a page's layouts first
+    TimelineState timelineState();
+    void restoreTimeline(const TimelineState& state);
+    // Shapes a page that may be shown soon, off the GUI thread
+    void prefetchLayouts(const QList<MessageListModel::Message>& messages);
     void clearMessages();
 
 private slots:
     void onSendClicked();
     void onReturnPressed();
+    void onScrolled(int value);
+    void onResizeSettled();
 
 private:
+    bool eventFilter(QObject* watched, QEvent* event) override;
     void setupUI();
     void setupEmptyState();
     void setupChatState();
     void scrollToBottom();
+    void requestOlderIfNeeded();
+    void requestNewerIfNeeded();
+    void copySelectedMessages();
+    // Page loads are shaped on the thread pool before their rows reach the
+    // model; until then the old rows stay. Later updates queue behind them,
+    // so rows keep the indices the caller used.
+    void afterLayouts(const QList<MessageListModel::Message>& page, std::function<void()> apply);
+    void afterPendingPages(std::function<void()> apply);
+    void onLayoutsReady(quint64 updateId);
+    void applyReadyUpdates();
+    void applyAllUpdates();
 
     QString m_currentConversationId;
     QString m_currentConversationName;
@@ -52,9 +110,22 @@ private:
     QWidget* m_chatStateWidget;
     QVBoxLayout* m_chatLayout;
     QLabel* m_titleLabel;
-    QScrollArea* m_scrollArea;
-    QWidget* m_messagesContainer;
-    QVBoxLayout* m_messagesLayout;
+    QListView* m_messageView;
+    MessageListModel* m_messageModel;
+    MessageBubbleDelegate* m_messageDelegate;
+    bool m_hasOlderMessages;
+    bool m_olderRequestPending;
+    bool m_hasNewerMessages;  // Timeline shows a page that is not the newest
+    bool m_newerRequestPending;
+    TimelineScrollController* m_scroller;
+    QTimer* m_resizeTimer;  // Restarted by each viewport resize
+    struct DeferredUpdate {
+        quint64 id;
+        bool ready;  // Its page is shaped (always true for non-page updates)
+        std::function<void()> apply;
+    };
+    QList<DeferredUpdate> m_deferredUpdates;  // In call order
+    quint64 m_nextUpdateId;
     QWidget* m_inputWidget;
     QHBoxLayout* m_inputLayout;
     QLineEdit* m_messageInput;
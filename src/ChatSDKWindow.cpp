@@ -1,63 +1,240 @@
 #include "ChatSDKWindow.h"
 #include "ChatConfig.h"
+#include "ChatLogging.h"
 #include "ChatPanel.h"
+#include "ConversationIndex.h"
 #include "ConversationListPanel.h"
+#include "EventDecoder.h"
+#include "FakeChatBackend.h"
+#include "HexCodec.h"
+#include "LatencyMonitor.h"
+#include "LogosChatBackend.h"
+#include "MessageStore.h"
+#include "Outbox.h"
+#include "QuickSwitcher.h"
+#include "SearchDialog.h"
+#include "SearchIndex.h"
+#include "StallWatchdog.h"
+#include "Theme.h"
 #include <QAction>
 #include <QClipboard>
 #include <QDebug>
-#include <QApplication>
 #include <QGuiApplication>
-#include <QPalette>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QFileDialog>
 #include <QInputDialog>
 #include <QLineEdit>
 #include <QTextEdit>
 #include <QVBoxLayout>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QMenu>
 #include <QMessageBox>
-#include <QRegularExpression>
+#include <QPlainTextEdit>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QLabel>
+#include <QElapsedTimer>
+#include <memory>
+#include <utility>
+
+namespace {
+// Latency readout refresh interval while it is shown
+constexpr int kLatencyOverlayIntervalMs = 1000;
+// Messages read from the store per timeline page
+constexpr qint64 kHistoryPageSize = 50;
+// Conversations whose timeline is kept for an instant switch back
+constexpr int kTimelineCacheSize = 8;
+// Hovered pages are kept apart, so they never push out opened ones
+constexpr int kPrefetchCacheSize = 2;
+// A hovered row is prefetched once the pointer has rested on it this long
+constexpr int kHoverSettleMs = 150;
+// Restored messages read from the store at a time while indexing
+constexpr qint64 kIndexBackfillChunk = 500;
+constexpr int kSearchResultLimit = 100;
+constexpr int kQuickSwitchResultLimit = 20;
+}
 
 ChatSDKWindow::ChatSDKWindow(LogosAPI *logosAPI, QWidget *parent)
-    : QMainWindow(parent), m_logosAPI(logosAPI), m_ownsLogosAPI(false),
-      m_logos(nullptr), m_chatInitialized(false), m_chatRunning(false),
-  m_pendingBundleRequest(false), m_autoStartOnLaunch(true),
+    : ChatSDKWindow(static_cast<IChatBackend *>(nullptr), parent) {
+  // chatsdk_module may still be loading; subscribing to it waits until
+  // chat is initialized
+  m_logosAPI = logosAPI;
+  m_createBackendOnDemand = true;
+}
+
+ChatSDKWindow::ChatSDKWindow(IChatBackend *backend, QWidget *parent)
+    : QMainWindow(parent), m_backend(backend), m_logosAPI(nullptr),
+      m_createBackendOnDemand(false), m_modulesLoading(false),
+      m_chatInitialized(false), m_chatRunning(false),
+  m_pendingBundleRequest(false), m_autoStartOnLaunch(ChatConfig::autoStartEnabled()),
   m_initChatAction(nullptr), m_startChatAction(nullptr),
-  m_stopChatAction(nullptr) {
-  // Create our own LogosAPI if none was provided
-  if (!m_logosAPI) {
-    m_logosAPI = new LogosAPI("core", this);
-    m_ownsLogosAPI = true;
+  m_stopChatAction(nullptr), m_latencyLabel(nullptr), m_latencyTimer(nullptr),
+  m_latency(nullptr), m_watchdog(nullptr), m_inboundQueue(nullptr),
+  m_decoder(nullptr), m_decoderThread(nullptr), m_store(nullptr),
+  m_searchIndex(nullptr), m_searchDialog(nullptr),
+  m_conversationIndex(nullptr), m_quickSwitcher(nullptr), m_outbox(nullptr),
+  m_currentConversation(ConversationRegistry::kInvalid),
+  m_loadedHistoryStart(0), m_loadedHistoryEnd(0),
+  m_timelineCache(kTimelineCacheSize),
+  m_prefetchedTimelines(kPrefetchCacheSize), m_hoverTimer(nullptr),
+  m_readPool(nullptr), m_closing(false), m_asyncLogging(false) {
+  m_startupClock.start();
+
+  // The plugin's log output leaves the GUI thread before anything else logs
+  if (ChatConfig::asyncLoggingEnabled()) {
+    ChatLogging::installAsyncSink(ChatConfig::logRatePerCategory(),
+                                  ChatConfig::logMaxChars());
+    m_asyncLogging = true;
   }
 
-  // Initialize LogosModules
-  m_logos = new LogosModules(m_logosAPI);
+  // Started first so that stalls during setup are attributed too
+  m_watchdog = new StallWatchdog(ChatConfig::stallThresholdMs(), 64, this);
+
+  // Module callbacks are coalesced and drained once per event-loop turn
+  m_inboundQueue = new InboundEventQueue(this);
+  connect(m_inboundQueue, &InboundEventQueue::drainRequested, this,
+          &ChatSDKWindow::drainInboundEvents);
+
+  // JSON parsing and content decoding run on a dedicated worker thread
+  m_decoderThread = new QThread(this);
+  m_decoderThread->setObjectName("ChatSDKEventDecoder");
+  m_decoder = new EventDecoder(m_inboundQueue);
+  m_decoder->moveToThread(m_decoderThread);
+  connect(m_decoderThread, &QThread::finished, m_decoder,
+          &QObject::deleteLater);
+  m_decoderThread->start();
+
+  // Opening the store only reads the manifest and index sizes
+  m_store = new MessageStore();
+  if (ChatConfig::persistenceEnabled()) {
+    m_store->open(ChatConfig::storeDirectory());
+  }
+  m_searchIndex = new SearchIndex();
+  m_conversationIndex = new ConversationIndex();
+  // Reads the store off the GUI thread: one thread for the search index
+  // backfill, one for prefetches
+  m_readPool = new QThreadPool(this);
+  m_readPool->setMaxThreadCount(2);
+  m_latency = new LatencyMonitor(this);
 
   setupUI();
   setupMenu();
+  if (m_backend) {
+    attachBackend();
+  }
+  restoreConversations();
+  qCInfo(lcPerf) << "ChatSDKWindow: Window built in"
+                 << m_startupClock.elapsed() << "ms";
+
+  // A host that is still loading the modules calls setModulesLoading(true)
+  // right after construction, before this runs
+  if (m_autoStartOnLaunch) {
+    QTimer::singleShot(0, this, [this]() {
+      if (m_autoStartOnLaunch && !m_modulesLoading) {
+        onInitChat();
+      }
+    });
+  }
+}
+
+bool ChatSDKWindow::ensureBackend() {
+  if (!m_backend && m_createBackendOnDemand) {
+    m_backend = createBackend(m_logosAPI);
+    attachBackend();
+  }
+  return m_backend != nullptr;
+}
+
+void ChatSDKWindow::attachBackend() {
+  // Sends leave the GUI thread through the outbox
+  m_outbox = new Outbox(m_backend, this);
+  connect(m_outbox, &Outbox::stateChanged, this,
+          &ChatSDKWindow::onOutboxStateChanged);
   setupEventHandlers();
+}
+
+void ChatSDKWindow::setModulesLoading(bool loading) {
+  if (m_modulesLoading == loading) {
+    return;
+  }
+  m_modulesLoading = loading;
+  updateChatMenuState();
+
+  if (loading) {
+    m_statusBar->showMessage("Connecting to Logos Core...");
+    return;
+  }
+  m_statusBar->clearMessage();
+  if (m_autoStartOnLaunch) {
+    onInitChat();
+  }
+}
+
+void ChatSDKWindow::reportStartupPhase(const QString &phase) {
+  if (m_startupPhasesSeen.contains(phase)) {
+    return;
+  }
+  m_startupPhasesSeen.append(phase);
+  qCInfo(lcPerf) << "ChatSDKWindow: Startup phase" << phase << "at"
+                 << m_startupClock.elapsed() << "ms";
+  emit startupPhase(phase);
+}
 
-  QTimer::singleShot(0, this, [this]() { onInitChat(); });
+IChatBackend *ChatSDKWindow::createBackend(LogosAPI *logosAPI) {
+  if (FakeChatBackend::enabledInEnvironment()) {
+    qCInfo(lcWindow) << "ChatSDKWindow: Using the local fake chat backend";
+    return new FakeChatBackend();
+  }
+  return new LogosChatBackend(logosAPI);
 }
 
 ChatSDKWindow::~ChatSDKWindow() {
-  // Stop and cleanup chat if running
-  if (m_chatRunning && m_logos) {
-    m_logos->chatsdk_module.stopChat();
+  const QString latencyDumpPath = ChatConfig::latencyDumpPath();
+  if (!latencyDumpPath.isEmpty()) {
+    QString error;
+    if (!m_latency->dumpToFile(latencyDumpPath, &error)) {
+      qCWarning(lcPerf) << "ChatSDKWindow: Could not write latency report to"
+                        << latencyDumpPath << ":" << error;
+    }
+  }
+
+  // The send in progress, if any, finishes before the backend goes away
+  if (m_outbox) {
+    m_outbox->shutdown();
   }
 
-  delete m_logos;
-  m_logos = nullptr;
+  // Stop and cleanup chat if running. The backend goes first so no
+  // callback can reach the decoder after it is gone.
+  if (m_chatRunning && m_backend) {
+    m_backend->stopChat();
+  }
+  delete m_backend;
+  m_backend = nullptr;
+
+  // Stop decoding before anything it posts to goes away
+  if (m_decoderThread) {
+    m_decoderThread->quit();
+    m_decoderThread->wait();
+  }
 
-  // Only delete LogosAPI if we created it ourselves
-  if (m_ownsLogosAPI) {
-    delete m_logosAPI;
+  // Nothing may still be reading the store when it goes; the backfill stops
+  // at its next slice
+  m_closing.store(true, std::memory_order_relaxed);
+  m_readPool->waitForDone();
+
+  // Writes out whatever is still queued
+  delete m_store;
+  m_store = nullptr;
+  delete m_searchIndex;
+  m_searchIndex = nullptr;
+  delete m_conversationIndex;
+  m_conversationIndex = nullptr;
+
+  // Flushes what is still buffered and hands logging back
+  if (m_asyncLogging) {
+    ChatLogging::releaseAsyncSink();
   }
-  m_logosAPI = nullptr;
 }
 
 void ChatSDKWindow::setupUI() {
@@ -66,30 +243,18 @@ void ChatSDKWindow::setupUI() {
   setMinimumSize(800, 600);
   resize(1000, 700);
 
-  // Set application-wide monospace font
-  QFont appFont("JetBrains Mono", 12);
-  appFont.setStyleHint(QFont::Monospace);
-  QApplication::setFont(appFont);
-
-  // Dark title bar (macOS and general)
-  QPalette darkPalette = palette();
-  darkPalette.setColor(QPalette::Window, QColor("#000000"));
-  darkPalette.setColor(QPalette::WindowText, QColor("#FAFAFA"));
-  setPalette(darkPalette);
-  setStyleSheet("QMainWindow { background-color: #000000; }");
+  // Font, palette and one style sheet for the whole window. Set on the
+  // window rather than the application so a host app is left alone.
+  Theme::instance().apply(this);
+  connect(&Theme::instance(), &Theme::changed, this,
+          &ChatSDKWindow::onThemeChanged);
 
-  // Create splitter - terminal theme
+  // Create splitter
   m_splitter = new QSplitter(Qt::Horizontal, this);
   m_splitter->setHandleWidth(1);
-  m_splitter->setStyleSheet("QSplitter {"
-                            "  background-color: #0A0A0A;"
-                            "}"
-                            "QSplitter::handle {"
-                            "  background-color: #2a2a2a;"
-                            "}");
 
   // Create panels
-  m_conversationList = new ConversationListPanel(m_splitter);
+  m_conversationList = new ConversationListPanel(&m_conversations, m_splitter);
   m_chatPanel = new ChatPanel(m_splitter);
 
   // Set panel sizes (left: 250px, right: rest)
@@ -105,33 +270,52 @@ void ChatSDKWindow::setupUI() {
 
   setCentralWidget(m_splitter);
 
-  // Create status bar - terminal theme
+  // Create status bar
   m_statusBar = new QStatusBar(this);
-  m_statusBar->setStyleSheet("QStatusBar {"
-                             "  background-color: #0A0A0A;"
-                             "  color: #6B7280;"
-                             "  border-top: 1px solid #2a2a2a;"
-                             "}");
   setStatusBar(m_statusBar);
   m_statusBar->showMessage("Ready");
 
   // Create identity display label in status bar right side
   m_identityLabel = new QLabel(this);
-  m_identityLabel->setStyleSheet("color: #6B7280; margin-right: 15px;");
   m_identityLabel->setText("ID: loading...");
   m_identityLabel->setMinimumWidth(120);
   m_identityLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
   m_statusBar->addPermanentWidget(m_identityLabel);
 
+  // Latency readout (Help > Show Message Latency)
+  m_latencyLabel = new QLabel(this);
+  m_latencyLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  m_latencyLabel->hide();
+  m_statusBar->insertPermanentWidget(0, m_latencyLabel);
+  m_latencyTimer = new QTimer(this);
+  m_latencyTimer->setInterval(kLatencyOverlayIntervalMs);
+  connect(m_latencyTimer, &QTimer::timeout, this,
+          &ChatSDKWindow::updateLatencyOverlay);
+  m_latency->watchPaints(m_chatPanel->timelineViewport());
+
+  m_hoverTimer = new QTimer(this);
+  m_hoverTimer->setSingleShot(true);
+  m_hoverTimer->setInterval(kHoverSettleMs);
+  connect(m_hoverTimer, &QTimer::timeout, this,
+          &ChatSDKWindow::prefetchHoveredConversation);
+
   // Connect signals
   connect(m_conversationList, &ConversationListPanel::conversationSelected,
           this, &ChatSDKWindow::onConversationSelected);
+  connect(m_conversationList, &ConversationListPanel::conversationHovered,
+          this, &ChatSDKWindow::onConversationHovered);
+  connect(m_conversationList, &ConversationListPanel::conversationPinned,
+          this, &ChatSDKWindow::onConversationPinned);
   connect(m_conversationList, &ConversationListPanel::newConversationRequested,
           this, &ChatSDKWindow::onNewConversationRequested);
   connect(m_conversationList, &ConversationListPanel::myBundleRequested, this,
           &ChatSDKWindow::onMyBundleRequested);
   connect(m_chatPanel, &ChatPanel::messageSent, this,
           &ChatSDKWindow::onMessageSent);
+  connect(m_chatPanel, &ChatPanel::olderMessagesRequested, this,
+          &ChatSDKWindow::onOlderMessagesRequested);
+  connect(m_chatPanel, &ChatPanel::newerMessagesRequested, this,
+          &ChatSDKWindow::onNewerMessagesRequested);
 }
 
 void ChatSDKWindow::setupMenu() {
@@ -162,92 +346,213 @@ void ChatSDKWindow::setupMenu() {
           &ChatSDKWindow::onStopChat);
   m_stopChatAction->setEnabled(false); // Disabled until started
 
+  chatMenu->addSeparator();
+  QAction *searchAction = chatMenu->addAction("Search &Messages...");
+  searchAction->setShortcut(QKeySequence::Find);
+  connect(searchAction, &QAction::triggered, this,
+          &ChatSDKWindow::onSearchRequested);
+
+  QAction *quickSwitchAction = chatMenu->addAction("&Switch Conversation...");
+  quickSwitchAction->setShortcut(QKeySequence("Ctrl+K"));
+  connect(quickSwitchAction, &QAction::triggered, this,
+          &ChatSDKWindow::onQuickSwitcherRequested);
+
+  // View menu
+  QMenu *viewMenu = menuBar()->addMenu("&View");
+
+  QAction *lightThemeAction = viewMenu->addAction("&Light Theme");
+  lightThemeAction->setCheckable(true);
+  lightThemeAction->setChecked(Theme::instance().mode() == Theme::Light);
+  lightThemeAction->setShortcut(QKeySequence("Ctrl+Shift+T"));
+  connect(lightThemeAction, &QAction::toggled, this,
+          &ChatSDKWindow::onLightThemeToggled);
+
   // Help menu
   QMenu *helpMenu = menuBar()->addMenu("&Help");
 
+  QAction *latencyAction = helpMenu->addAction("Show Message &Latency");
+  latencyAction->setCheckable(true);
+  latencyAction->setShortcut(QKeySequence("Ctrl+Shift+L"));
+  connect(latencyAction, &QAction::toggled, this,
+          &ChatSDKWindow::onLatencyOverlayToggled);
+
+  QAction *dumpLatencyAction = helpMenu->addAction("&Save Latency Report...");
+  connect(dumpLatencyAction, &QAction::triggered, this,
+          &ChatSDKWindow::onDumpLatencyRequested);
+
+  QAction *stallsAction = helpMenu->addAction("Show GUI S&talls...");
+  stallsAction->setEnabled(m_watchdog->isRunning());
+  connect(stallsAction, &QAction::triggered, this,
+          &ChatSDKWindow::onShowStallsRequested);
+
+  helpMenu->addSeparator();
   QAction *aboutAction = helpMenu->addAction("&About");
   connect(aboutAction, &QAction::triggered, this,
           &ChatSDKWindow::onAboutAction);
 }
 
 void ChatSDKWindow::setupEventHandlers() {
-  if (!m_logos) {
-    qWarning() << "ChatSDKWindow: LogosModules not available, event handlers "
-                  "not set up";
-    return;
-  }
-
-  // Subscribe to chatsdk module events
-  m_logos->chatsdk_module.on(
-      "chatsdkInitResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkInitResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkStartResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkStartResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkStopResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkStopResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkCreateIntroBundleResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkCreateIntroBundleResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkNewMessage", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkNewMessage(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkNewConversation", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkNewConversation(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkNewPrivateConversationResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this,
-            [this, data]() { onChatsdkNewPrivateConversationResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkSendMessageResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkSendMessageResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  m_logos->chatsdk_module.on(
-      "chatsdkGetIdResult", [this](const QVariantList &data) {
-        QMetaObject::invokeMethod(
-            this, [this, data]() { onChatsdkGetIdResult(data); },
-            Qt::QueuedConnection);
-      });
-
-  qDebug() << "ChatSDKWindow: Event handlers set up successfully";
+  // Subscribe to chatsdk module events. Callbacks only hand the raw data to
+  // the decoder thread, which forwards decoded events to the inbound queue;
+  // the queue schedules a single drain for everything that arrives before it
+  // runs.
+  const QStringList eventNames = {
+      "chatsdkInitResult",
+      "chatsdkStartResult",
+      "chatsdkStopResult",
+      "chatsdkCreateIntroBundleResult",
+      "chatsdkNewMessage",
+      "chatsdkNewConversation",
+      "chatsdkNewPrivateConversationResult",
+      "chatsdkSendMessageResult",
+      "chatsdkGetIdResult",
+  };
+  for (const QString &eventName : eventNames) {
+    m_backend->on(
+        eventName, [this, eventName](const QVariantList &data) {
+          m_decoder->submit(eventName, data, LatencyMonitor::now());
+        });
+  }
+
+  qCDebug(lcWindow) << "ChatSDKWindow: Event handlers set up successfully";
+}
+
+InboundEventQueue::Stats ChatSDKWindow::ingestStats() const {
+  return m_inboundQueue->stats();
+}
+
+void ChatSDKWindow::onLatencyOverlayToggled(bool visible) {
+  m_latencyLabel->setVisible(visible);
+  if (visible) {
+    updateLatencyOverlay();
+    m_latencyTimer->start();
+  } else {
+    m_latencyTimer->stop();
+  }
+}
+
+void ChatSDKWindow::onLightThemeToggled(bool light) {
+  Theme::instance().setMode(light ? Theme::Light : Theme::Dark);
+}
+
+void ChatSDKWindow::onThemeChanged() {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onThemeChanged");
+  // One sheet swap at the root; bubbles and rows read their colors from the
+  // theme when they are repainted
+  Theme::instance().apply(this);
+}
+
+void ChatSDKWindow::updateLatencyOverlay() {
+  m_latencyLabel->setText(m_latency->summary());
+  m_latencyLabel->setToolTip(m_latency->report());
+}
+
+void ChatSDKWindow::onDumpLatencyRequested() {
+  const QString path = QFileDialog::getSaveFileName(
+      this, "Save Latency Report", "chatsdk_latency.txt",
+      "Text files (*.txt);;All files (*)");
+  if (path.isEmpty()) {
+    return;
+  }
+
+  QString error;
+  if (m_latency->dumpToFile(path, &error)) {
+    m_statusBar->showMessage(QString("Latency report saved to %1").arg(path),
+                             3000);
+  } else {
+    QMessageBox::warning(this, "Save Failed",
+                         QString("Could not save the latency report:\n%1")
+                             .arg(error));
+  }
+}
+
+void ChatSDKWindow::onShowStallsRequested() {
+  const auto stalls = m_watchdog->stalls();
+  QStringList lines;
+  for (auto it = stalls.crbegin(); it != stalls.crend(); ++it) {
+    lines.append(StallWatchdog::formatStall(*it));
+  }
+  if (m_watchdog->thresholdMs() <= 0) {
+    lines.append("Stall reporting is off; set CHATSDK_STALL_THRESHOLD_MS to enable it.");
+  } else if (lines.isEmpty()) {
+    lines.append(QString("No stalls over %1 ms.").arg(m_watchdog->thresholdMs()));
+  }
+
+  QDialog dialog(this);
+  dialog.setWindowTitle("GUI Stalls (newest first)");
+  dialog.resize(720, 360);
+  QVBoxLayout *layout = new QVBoxLayout(&dialog);
+  QPlainTextEdit *text = new QPlainTextEdit(lines.join('\n'), &dialog);
+  text->setReadOnly(true);
+  text->setLineWrapMode(QPlainTextEdit::NoWrap);
+  QDialogButtonBox *buttons =
+      new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  layout->addWidget(text);
+  layout->addWidget(buttons);
+  dialog.exec();
+}
+
+void ChatSDKWindow::drainInboundEvents() {
+  QElapsedTimer drainTimer;
+  drainTimer.start();
+
+  const QVector<InboundEventQueue::Event> events = m_inboundQueue->takeAll();
+  if (events.isEmpty())
+    return;
+  StallWatchdog::Scope stallScope("ChatSDKWindow::drainInboundEvents",
+                                  events.size(), "events");
+
+  // New messages are applied to the store as they come; the resulting UI
+  // work is flushed once. Other events flush first so that ordering with
+  // respect to messages is preserved.
+  IngestBatch batch;
+  for (const auto &event : events) {
+    if (event.name == "chatsdkNewMessage") {
+      ingestNewMessage(event.message, batch);
+    } else if (event.name == "chatsdkNewConversation") {
+      flushIngestBatch(batch);
+      applyNewConversation(event.conversation);
+    } else {
+      flushIngestBatch(batch);
+      dispatchInboundEvent(event);
+    }
+  }
+  flushIngestBatch(batch);
+
+  m_inboundQueue->recordDrain(events.size(), drainTimer.nsecsElapsed());
+}
+
+void ChatSDKWindow::dispatchInboundEvent(
+    const InboundEventQueue::Event &event) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::dispatchInboundEvent");
+  const QString &name = event.name;
+  if (name == "chatsdkInitResult") {
+    onChatsdkInitResult(event.data);
+  } else if (name == "chatsdkStartResult") {
+    onChatsdkStartResult(event.data);
+  } else if (name == "chatsdkStopResult") {
+    onChatsdkStopResult(event.data);
+  } else if (name == "chatsdkCreateIntroBundleResult") {
+    onChatsdkCreateIntroBundleResult(event.data);
+  } else if (name == "chatsdkNewMessage") {
+    onChatsdkNewMessage(event.data);
+  } else if (name == "chatsdkNewConversation") {
+    onChatsdkNewConversation(event.data);
+  } else if (name == "chatsdkNewPrivateConversationResult") {
+    onChatsdkNewPrivateConversationResult(event.data);
+  } else if (name == "chatsdkSendMessageResult") {
+    onChatsdkSendMessageResult(event.sendResult);
+  } else if (name == "chatsdkGetIdResult") {
+    onChatsdkGetIdResult(event.data);
+  } else {
+    qCWarning(lcEvents) << "ChatSDKWindow: Unhandled event" << name;
+  }
 }
 
 void ChatSDKWindow::updateChatMenuState() {
   if (m_initChatAction) {
-    m_initChatAction->setEnabled(!m_chatInitialized);
+    m_initChatAction->setEnabled(!m_chatInitialized && !m_modulesLoading);
   }
   if (m_startChatAction) {
     m_startChatAction->setEnabled(m_chatInitialized && !m_chatRunning);
@@ -257,41 +562,414 @@ void ChatSDKWindow::updateChatMenuState() {
   }
 }
 
+void ChatSDKWindow::restoreConversations() {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::restoreConversations");
+  const auto conversations = m_store->conversations();
+  for (const auto &meta : conversations) {
+    const auto handle = m_conversations.intern(meta.id);
+    auto &conversation = m_conversations[handle];
+    conversation.name = meta.name;
+    conversation.peerId = meta.peerId;
+    conversation.lastActivity = meta.lastActivity;
+    conversation.pinned = meta.pinned;
+    m_conversationList->addConversation(handle);
+    m_conversationIndex->addConversation(meta.id, meta.name, meta.peerId,
+                                         meta.lastActivity);
+    if (meta.messageCount > 0) {
+      m_indexBackfill.append({meta.id, meta.messageCount});
+    }
+  }
+
+  if (!conversations.isEmpty()) {
+    m_statusBar->showMessage(
+        QString("Restored %1 conversations").arg(conversations.size()), 3000);
+  }
+
+  if (!m_indexBackfill.isEmpty()) {
+    backfillSearchIndex();
+  }
+}
+
+void ChatSDKWindow::indexMessage(const QString &conversationId, qint64 row,
+                                 const QString &content) {
+  m_searchIndex->addMessage(conversationId, row, content);
+}
+
+void ChatSDKWindow::backfillSearchIndex() {
+  // Restored history is read and tokenized on a worker into an index of its
+  // own. Messages that arrive meanwhile go to m_searchIndex as usual and are
+  // appended to the restored ones when the worker is done, which keeps the
+  // documents in history order.
+  const auto backfill = std::exchange(m_indexBackfill, {});
+  MessageStore *store = m_store;
+  m_readPool->start([this, store, backfill]() {
+    auto restored = std::make_shared<SearchIndex>();
+    for (const auto &[conversationId, end] : backfill) {
+      for (qint64 row = 0; row < end; row += kIndexBackfillChunk) {
+        if (m_closing.load(std::memory_order_relaxed)) {
+          return;
+        }
+        const qint64 count = qMin(kIndexBackfillChunk, end - row);
+        const auto messages = store->readMessages(conversationId, row, count);
+        for (qsizetype i = 0; i < messages.size(); ++i) {
+          restored->addMessage(conversationId, row + i, messages.at(i).content);
+        }
+        if (messages.size() < count) {
+          break;
+        }
+      }
+    }
+    QMetaObject::invokeMethod(
+        this, [this, restored]() { adoptBackfilledIndex(*restored); },
+        Qt::QueuedConnection);
+  });
+}
+
+void ChatSDKWindow::adoptBackfilledIndex(SearchIndex &restored) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::adoptBackfilledIndex",
+                                  m_searchIndex->documentCount(), "messages");
+  restored.append(*m_searchIndex);
+  *m_searchIndex = std::move(restored);
+  // Conversations are numbered afresh in the adopted index
+  for (IngestKeys &keys : m_ingestKeys) {
+    keys.search = -1;
+  }
+}
+
+bool ChatSDKWindow::isCurrentConversation(
+    const QString &conversationId) const {
+  return m_currentConversation != ConversationRegistry::kInvalid &&
+         m_conversations.idOf(m_currentConversation) == conversationId;
+}
+
+QList<ChatMessage> ChatSDKWindow::readTimeline(const QString &conversationId,
+                                               qint64 first,
+                                               qint64 count) const {
+  // The store has the last recorded state; the outbox knows which sends are
+  // still in progress
+  QList<ChatMessage> messages = m_store->readMessages(conversationId, first, count);
+  applySendStates(conversationId, first, messages);
+  return messages;
+}
+
+void ChatSDKWindow::applySendStates(const QString &conversationId,
+                                    qint64 first,
+                                    QList<ChatMessage> &messages) const {
+  if (m_outbox) {
+    m_outbox->applyStates(conversationId, first, messages);
+  } else {
+    Outbox::markUnconfirmed(messages);
+  }
+}
+
 void ChatSDKWindow::showConversationMessages(const QString &conversationId) {
-  m_chatPanel->clearMessages();
+  StallWatchdog::Scope stallScope("ChatSDKWindow::showConversationMessages",
+                                  kHistoryPageSize, "rows");
+  // Only the newest page is read; older pages follow as the user scrolls up
+  const qint64 count = m_store->messageCount(conversationId);
+  m_loadedHistoryStart = qMax<qint64>(0, count - kHistoryPageSize);
+  m_loadedHistoryEnd = count;
+  m_chatPanel->setMessages(
+      readTimeline(conversationId, m_loadedHistoryStart,
+                   count - m_loadedHistoryStart),
+      m_loadedHistoryStart > 0);
+}
 
-  if (!m_messages.contains(conversationId)) {
+void ChatSDKWindow::onOlderMessagesRequested(const QString &conversationId) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onOlderMessagesRequested",
+                                  kHistoryPageSize, "rows");
+  if (!isCurrentConversation(conversationId)) {
     return;
   }
 
-  const auto &messages = m_messages[conversationId];
-  for (const auto &message : messages) {
-    m_chatPanel->addMessage(message.sender, message.content, message.timestamp,
-                            message.isMe);
+  const qint64 first = qMax<qint64>(0, m_loadedHistoryStart - kHistoryPageSize);
+  const auto messages =
+      readTimeline(conversationId, first, m_loadedHistoryStart - first);
+  m_loadedHistoryStart = first;
+  m_chatPanel->prependMessages(messages, first > 0);
+}
+
+void ChatSDKWindow::onNewerMessagesRequested(const QString &conversationId) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onNewerMessagesRequested",
+                                  kHistoryPageSize, "rows");
+  if (!isCurrentConversation(conversationId)) {
+    return;
   }
+
+  const qint64 count = m_store->messageCount(conversationId);
+  const qint64 last = qMin(count, m_loadedHistoryEnd + kHistoryPageSize);
+  const auto messages = readTimeline(conversationId, m_loadedHistoryEnd,
+                                     last - m_loadedHistoryEnd);
+  m_loadedHistoryEnd = last;
+  m_chatPanel->appendNewerMessages(messages, last < count);
 }
 
 void ChatSDKWindow::onConversationSelected(const QString &conversationId) {
-  if (!m_conversations.contains(conversationId)) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onConversationSelected");
+  if (activateConversation(conversationId) &&
+      !restoreCachedTimeline(conversationId)) {
+    showConversationMessages(conversationId);
+  }
+}
+
+void ChatSDKWindow::onConversationHovered(const QString &conversationId) {
+  // Rows the pointer only passes over on its way are not read
+  m_hoveredConversationId = conversationId;
+  m_hoverTimer->start();
+}
+
+void ChatSDKWindow::prefetchHoveredConversation() {
+  const QString conversationId = m_hoveredConversationId;
+  const auto handle = m_conversations.find(conversationId);
+  if (handle == ConversationRegistry::kInvalid ||
+      handle == m_currentConversation || m_timelineCache.contains(handle) ||
+      m_prefetchedTimelines.contains(handle) || m_prefetching.contains(handle)) {
+    return;
+  }
+  m_prefetching.insert(handle);
+
+  // The page a click would load, read off the GUI thread and shaped ahead of
+  // the click
+  MessageStore *store = m_store;
+  m_readPool->start([this, store, conversationId, handle]() {
+    const qint64 count = store->messageCount(conversationId);
+    const qint64 first = qMax<qint64>(0, count - kHistoryPageSize);
+    const QList<ChatMessage> messages =
+        store->readMessages(conversationId, first, count - first);
+    QMetaObject::invokeMethod(
+        this,
+        [this, handle, conversationId, first, messages]() {
+          adoptPrefetchedTimeline(handle, conversationId, first, messages);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void ChatSDKWindow::adoptPrefetchedTimeline(
+    ConversationRegistry::Handle handle, const QString &conversationId,
+    qint64 first, QList<ChatMessage> messages) {
+  m_prefetching.remove(handle);
+  // Opened while it was being read
+  if (handle == m_currentConversation || m_timelineCache.contains(handle)) {
+    return;
+  }
+
+  // Messages that arrived since the read are appended when it is restored
+  auto *cached = new CachedTimeline;
+  applySendStates(conversationId, first, messages);
+  cached->historyStart = first;
+  cached->historyEnd = first + messages.size();
+  cached->state.messages = messages;
+  cached->state.hasOlder = first > 0;
+  m_chatPanel->prefetchLayouts(cached->state.messages);
+  m_prefetchedTimelines.insert(handle, cached);
+}
+
+void ChatSDKWindow::onConversationPinned(const QString &conversationId,
+                                         bool pinned) {
+  qCDebug(lcWindow) << "ChatSDKWindow: conversation" << conversationId
+                    << (pinned ? "pinned" : "unpinned");
+  m_store->setConversationPinned(conversationId, pinned);
+}
+
+void ChatSDKWindow::stashCurrentTimeline() {
+  if (m_currentConversation == ConversationRegistry::kInvalid) {
     return;
   }
+  auto *cached = new CachedTimeline;
+  cached->state = m_chatPanel->timelineState();
+  cached->historyStart = m_loadedHistoryStart;
+  cached->historyEnd = m_loadedHistoryEnd;
+  m_timelineCache.insert(m_currentConversation, cached);
+}
+
+bool ChatSDKWindow::restoreCachedTimeline(const QString &conversationId) {
+  const auto handle = m_conversations.find(conversationId);
+  CachedTimeline *cached = m_timelineCache.take(handle);
+  if (!cached) {
+    cached = m_prefetchedTimelines.take(handle);
+  }
+  if (!cached) {
+    return false;
+  }
+
+  // Messages that arrived while the conversation was in the background are
+  // appended when the newest page was the one shown; an older page picks
+  // them up through paging as before
+  const qint64 count = m_store->messageCount(conversationId);
+  const qint64 missed =
+      cached->state.hasNewer ? 0 : count - cached->historyEnd;
+  if (missed > kHistoryPageSize) {
+    delete cached;
+    return false;
+  }
+  if (missed > 0) {
+    cached->state.messages.append(
+        readTimeline(conversationId, cached->historyEnd, missed));
+    cached->historyEnd = count;
+  }
+
+  m_loadedHistoryStart = cached->historyStart;
+  m_loadedHistoryEnd = cached->historyEnd;
+  m_chatPanel->restoreTimeline(cached->state);
+  delete cached;
+  return true;
+}
 
-  m_currentConversationId = conversationId;
-  m_conversationList->clearUnread(conversationId);
-  const auto &convo = m_conversations[conversationId];
+bool ChatSDKWindow::activateConversation(const QString &conversationId) {
+  const auto handle = m_conversations.find(conversationId);
+  if (handle == ConversationRegistry::kInvalid) {
+    return false;
+  }
+
+  if (handle != m_currentConversation) {
+    stashCurrentTimeline();
+  }
+  m_currentConversation = handle;
+  m_conversationList->clearUnread(handle);
+  const auto &convo = m_conversations.at(handle);
   m_chatPanel->setConversation(conversationId, convo.name);
-  showConversationMessages(conversationId);
-  
+  if (m_searchDialog) {
+    m_searchDialog->setCurrentConversation(convo.name);
+  }
+
   // Update status bar to show peer identity if available
   QString statusMessage = QString("Conversation: %1").arg(convo.name);
-  if (m_peerIdentities.contains(conversationId)) {
-    QString peerId = m_peerIdentities[conversationId];
-    statusMessage = QString("Chatting with: %1").arg(peerId.left(6));
+  if (!convo.peerId.isEmpty()) {
+    statusMessage = QString("Chatting with: %1").arg(convo.peerId.left(6));
   }
   m_statusBar->showMessage(statusMessage, 3000);
+  return true;
+}
+
+void ChatSDKWindow::onSearchRequested() {
+  if (!m_searchDialog) {
+    m_searchDialog = new SearchDialog(this);
+    connect(m_searchDialog, &SearchDialog::queryChanged, this,
+            &ChatSDKWindow::onSearchQueryChanged);
+    connect(m_searchDialog, &SearchDialog::resultActivated, this,
+            &ChatSDKWindow::onSearchResultActivated);
+  }
+
+  m_searchDialog->setCurrentConversation(
+      m_currentConversation == ConversationRegistry::kInvalid
+          ? QString()
+          : m_conversations.at(m_currentConversation).name);
+  m_searchDialog->show();
+  m_searchDialog->raise();
+  m_searchDialog->activateWindow();
+  m_searchDialog->focusQuery();
+}
+
+void ChatSDKWindow::onSearchQueryChanged(const QString &query,
+                                         bool currentConversationOnly) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onSearchQueryChanged",
+                                  query.size(), "chars");
+  QElapsedTimer searchTimer;
+  searchTimer.start();
+
+  const auto hits = m_searchIndex->search(
+      query,
+      currentConversationOnly &&
+              m_currentConversation != ConversationRegistry::kInvalid
+          ? m_conversations.idOf(m_currentConversation)
+          : QString(),
+      kSearchResultLimit);
+
+  // Only the hits shown are read back from the store
+  QList<SearchDialog::Result> results;
+  results.reserve(hits.size());
+  for (const auto &hit : hits) {
+    const auto messages = m_store->readMessages(hit.conversationId, hit.row, 1);
+    if (messages.isEmpty()) {
+      continue;
+    }
+    const auto &message = messages.first();
+    const auto handle = m_conversations.find(hit.conversationId);
+    const QString name = handle == ConversationRegistry::kInvalid
+                             ? QString()
+                             : m_conversations.at(handle).name;
+    results.append({hit.conversationId, hit.row,
+                    QString("%1 \xc2\xb7 %2 \xc2\xb7 %3")
+                        .arg(name.isEmpty() ? hit.conversationId.left(8) : name,
+                             message.sender,
+                             message.timestamp.toString("MMM d, h:mm AP")),
+                    message.content.left(200).simplified()});
+  }
+
+  m_searchDialog->setResults(results, searchTimer.nsecsElapsed() / 1000);
+}
+
+void ChatSDKWindow::onQuickSwitcherRequested() {
+  if (!m_quickSwitcher) {
+    m_quickSwitcher = new QuickSwitcher(this);
+    connect(m_quickSwitcher, &QuickSwitcher::queryChanged, this,
+            &ChatSDKWindow::onQuickSwitchQueryChanged);
+    connect(m_quickSwitcher, &QuickSwitcher::conversationChosen, this,
+            &ChatSDKWindow::onQuickSwitchChosen);
+  }
+
+  // Centred over the top of the window, like a command palette
+  const QRect area = geometry();
+  m_quickSwitcher->resize(qMin(560, area.width() - 40), 360);
+  m_quickSwitcher->move(area.center().x() - m_quickSwitcher->width() / 2,
+                        area.top() + 80);
+  m_quickSwitcher->show();
+  m_quickSwitcher->start();
+}
+
+void ChatSDKWindow::onQuickSwitchQueryChanged(const QString &query) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onQuickSwitchQueryChanged",
+                                  query.size(), "chars");
+  const auto matches =
+      m_conversationIndex->search(query, kQuickSwitchResultLimit);
+
+  QList<QuickSwitcher::Result> results;
+  results.reserve(matches.size());
+  for (const auto &match : matches) {
+    const auto handle = m_conversations.find(match.conversationId);
+    if (handle == ConversationRegistry::kInvalid) {
+      continue;
+    }
+    const auto &info = m_conversations.at(handle);
+    results.append({match.conversationId,
+                    info.name.isEmpty() ? match.conversationId.left(8)
+                                        : info.name,
+                    info.peerId.isEmpty() ? match.conversationId.left(16)
+                                          : info.peerId.left(16)});
+  }
+  m_quickSwitcher->setResults(results);
+}
+
+void ChatSDKWindow::onQuickSwitchChosen(const QString &conversationId) {
+  m_conversationList->selectConversation(m_conversations.find(conversationId));
+  onConversationSelected(conversationId);
+}
+
+void ChatSDKWindow::onSearchResultActivated(const QString &conversationId,
+                                            qint64 row) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onSearchResultActivated");
+  if (!activateConversation(conversationId)) {
+    return;
+  }
+  m_timelineCache.remove(m_currentConversation);
+  m_prefetchedTimelines.remove(m_currentConversation);
+  m_conversationList->selectConversation(m_currentConversation);
+
+  // Load a page centred on the hit; the panel pages further either way
+  const qint64 count = m_store->messageCount(conversationId);
+  m_loadedHistoryStart = qBound<qint64>(0, row - kHistoryPageSize / 2,
+                                        qMax<qint64>(0, count - kHistoryPageSize));
+  m_loadedHistoryEnd = qMin(count, m_loadedHistoryStart + kHistoryPageSize);
+  m_chatPanel->showMessagesAround(
+      readTimeline(conversationId, m_loadedHistoryStart,
+                   m_loadedHistoryEnd - m_loadedHistoryStart),
+      m_loadedHistoryStart > 0, m_loadedHistoryEnd < count,
+      static_cast<int>(row - m_loadedHistoryStart));
 }
 
 void ChatSDKWindow::onNewConversationRequested() {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onNewConversationRequested");
   // Check if chat is initialized and running
   if (!m_chatInitialized || !m_chatRunning) {
     QMessageBox::warning(this, "Chat Not Running",
@@ -300,7 +978,7 @@ void ChatSDKWindow::onNewConversationRequested() {
     return;
   }
 
-  if (!m_logos) {
+  if (!m_backend) {
     QMessageBox::warning(this, "Error", "LogosAPI not available.");
     return;
   }
@@ -357,10 +1035,9 @@ void ChatSDKWindow::onNewConversationRequested() {
 
   // Create the private conversation with an initial greeting message
   // Content must be hex-encoded for the libchat API
-  QString initialMessageHex =
-      QString::fromLatin1(initialMessage.toUtf8().toHex());
+  QString initialMessageHex = HexCodec::encodeText(initialMessage);
 
-  bool success = m_logos->chatsdk_module.newPrivateConversation(
+  bool success = m_backend->newPrivateConversation(
       bundle, initialMessageHex);
 
   if (!success) {
@@ -374,6 +1051,7 @@ void ChatSDKWindow::onNewConversationRequested() {
 }
 
 void ChatSDKWindow::onMyBundleRequested() {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onMyBundleRequested");
   // Check if chat is initialized and running
   if (!m_chatInitialized || !m_chatRunning) {
     QMessageBox::warning(this, "Chat Not Running",
@@ -382,7 +1060,7 @@ void ChatSDKWindow::onMyBundleRequested() {
     return;
   }
 
-  if (!m_logos) {
+  if (!m_backend) {
     QMessageBox::warning(this, "Error",
                          "LogosAPI not available. Cannot retrieve bundle.");
     return;
@@ -393,7 +1071,7 @@ void ChatSDKWindow::onMyBundleRequested() {
   m_statusBar->showMessage("Requesting intro bundle...");
 
   // Call the actual createIntroBundle
-  bool success = m_logos->chatsdk_module.createIntroBundle();
+  bool success = m_backend->createIntroBundle();
   if (!success) {
     m_pendingBundleRequest = false;
     QMessageBox::warning(
@@ -408,7 +1086,13 @@ void ChatSDKWindow::onMyBundleRequested() {
 // ============================================================================
 
 void ChatSDKWindow::onInitChat() {
-  if (!m_logos) {
+  if (m_modulesLoading) {
+    // Auto-start, if pending, runs when loading finishes
+    m_statusBar->showMessage("Still connecting to Logos Core...");
+    return;
+  }
+
+  if (!ensureBackend()) {
     QMessageBox::warning(
         this, "Error",
         "LogosAPI not available. Cannot initialize chat.\n\n"
@@ -426,11 +1110,12 @@ void ChatSDKWindow::onInitChat() {
   QString configJson = ChatConfig::buildConfigJson();
   QString configDesc = ChatConfig::getConfigDescription(configJson);
 
-  qDebug() << "ChatSDKWindow: Initializing chat with config:" << configJson;
+  qCDebug(lcWindow) << "ChatSDKWindow: Initializing chat with config:"
+                    << configJson;
   m_statusBar->showMessage(
       QString("Initializing chat... (%1)").arg(configDesc));
 
-  bool success = m_logos->chatsdk_module.initChat(configJson);
+  bool success = m_backend->initChat(configJson);
   if (!success) {
     QMessageBox::warning(
         this, "Initialization Failed",
@@ -441,7 +1126,7 @@ void ChatSDKWindow::onInitChat() {
 }
 
 void ChatSDKWindow::onStartChat() {
-  if (!m_logos) {
+  if (!m_backend) {
     QMessageBox::warning(this, "Error", "LogosAPI not available.");
     return;
   }
@@ -458,13 +1143,13 @@ void ChatSDKWindow::onStartChat() {
     return;
   }
 
-  qDebug() << "ChatSDKWindow: Starting chat...";
+  qCDebug(lcWindow) << "ChatSDKWindow: Starting chat...";
   m_statusBar->showMessage("Starting chat...");
 
   // Set the event callback before starting
-  m_logos->chatsdk_module.setEventCallback();
+  m_backend->setEventCallback();
 
-  bool success = m_logos->chatsdk_module.startChat();
+  bool success = m_backend->startChat();
   if (!success) {
     QMessageBox::warning(this, "Start Failed",
                          "Failed to start chat. Check the logs for details.");
@@ -474,7 +1159,7 @@ void ChatSDKWindow::onStartChat() {
 }
 
 void ChatSDKWindow::onStopChat() {
-  if (!m_logos) {
+  if (!m_backend) {
     QMessageBox::warning(this, "Error", "LogosAPI not available.");
     return;
   }
@@ -484,10 +1169,10 @@ void ChatSDKWindow::onStopChat() {
     return;
   }
 
-  qDebug() << "ChatSDKWindow: Stopping chat...";
+  qCDebug(lcWindow) << "ChatSDKWindow: Stopping chat...";
   m_statusBar->showMessage("Stopping chat...");
 
-  bool success = m_logos->chatsdk_module.stopChat();
+  bool success = m_backend->stopChat();
   if (!success) {
     QMessageBox::warning(this, "Stop Failed",
                          "Failed to stop chat. Check the logs for details.");
@@ -501,7 +1186,8 @@ void ChatSDKWindow::onStopChat() {
 // ============================================================================
 
 void ChatSDKWindow::onChatsdkInitResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Init result received:" << data;
+  qCDebug(lcWindow) << "ChatSDKWindow: Init result received:"
+                    << ChatLogging::truncated(data);
 
   // data format: [success (bool), returnCode (int), message (QString),
   // timestamp (QString)]
@@ -513,6 +1199,11 @@ void ChatSDKWindow::onChatsdkInitResult(const QVariantList &data) {
     m_chatInitialized = true;
     m_statusBar->showMessage("Chat initialized successfully", 5000);
     updateChatMenuState();
+    reportStartupPhase("chat initialized");
+
+    // The identity exists once chat is initialized, so it is asked for
+    // alongside starting instead of after it
+    m_backend->getId();
 
     if (m_autoStartOnLaunch) {
       m_autoStartOnLaunch = false;
@@ -539,7 +1230,8 @@ void ChatSDKWindow::onChatsdkInitResult(const QVariantList &data) {
 }
 
 void ChatSDKWindow::onChatsdkStartResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Start result received:" << data;
+  qCDebug(lcWindow) << "ChatSDKWindow: Start result received:"
+                    << ChatLogging::truncated(data);
 
   // data format: [success (bool), returnCode (int), message (QString),
   // timestamp (QString)]
@@ -551,8 +1243,12 @@ void ChatSDKWindow::onChatsdkStartResult(const QVariantList &data) {
     m_chatRunning = true;
     m_statusBar->showMessage("Chat started - connected to network", 5000);
     updateChatMenuState();
+    reportStartupPhase("chat started");
 
-    m_logos->chatsdk_module.getId();
+    // Asked again in case the module had none to give before starting
+    if (m_myIdentity.isEmpty()) {
+      m_backend->getId();
+    }
   } else {
     m_statusBar->showMessage(
         QString("Chat start failed (code: %1)").arg(returnCode), 5000);
@@ -564,7 +1260,8 @@ void ChatSDKWindow::onChatsdkStartResult(const QVariantList &data) {
 }
 
 void ChatSDKWindow::onChatsdkStopResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Stop result received:" << data;
+  qCDebug(lcWindow) << "ChatSDKWindow: Stop result received:"
+                    << ChatLogging::truncated(data);
 
   // data format: [success (bool), returnCode (int), message (QString),
   // timestamp (QString)]
@@ -582,7 +1279,9 @@ void ChatSDKWindow::onChatsdkStopResult(const QVariantList &data) {
 }
 
 void ChatSDKWindow::onChatsdkCreateIntroBundleResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Create intro bundle result received:" << data;
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onChatsdkCreateIntroBundleResult");
+  qCDebug(lcWindow) << "ChatSDKWindow: Create intro bundle result received:"
+                    << ChatLogging::truncated(data);
 
   if (!m_pendingBundleRequest) {
     // Bundle request wasn't from us
@@ -624,111 +1323,157 @@ void ChatSDKWindow::onChatsdkCreateIntroBundleResult(const QVariantList &data) {
 }
 
 void ChatSDKWindow::onChatsdkNewMessage(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: New message received:" << data;
-
-  if (data.isEmpty())
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onChatsdkNewMessage",
+                                  data.isEmpty() ? 0 : data[0].toString().size(),
+                                  "chars");
+  InboundMessage message;
+  if (!EventDecoder::decodeMessage(data, &message))
     return;
 
-  // Parse the JSON message
-  QString jsonStr = data[0].toString();
-  QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
-  if (!doc.isObject())
-    return;
+  IngestBatch batch;
+  ingestNewMessage(message, batch);
+  flushIngestBatch(batch);
+}
 
-  QJsonObject obj = doc.object();
-  QString conversationId = obj["conversationId"].toString();
-  if (conversationId.isEmpty()) {
-    conversationId = obj["conversation_id"].toString();
+ChatSDKWindow::IngestKeys &
+ChatSDKWindow::ingestKeysFor(ConversationRegistry::Handle handle) {
+  if (m_ingestKeys.size() <= handle) {
+    m_ingestKeys.resize(m_conversations.size());
   }
-
-  QString content = obj["content"].toString();
-  // If content looks like hex, decode it
-  if (content.contains(QRegularExpression("^[0-9a-fA-F]+$")) &&
-      content.length() % 2 == 0) {
-    QByteArray contentBytes = QByteArray::fromHex(content.toUtf8());
-    content = QString::fromUtf8(contentBytes);
+  IngestKeys &keys = m_ingestKeys[handle];
+  if (keys.store < 0) {
+    keys.store = m_store->conversationKey(m_conversations.idOf(handle));
+  }
+  if (keys.search < 0) {
+    keys.search = m_searchIndex->internConversation(m_conversations.idOf(handle));
   }
+  return keys;
+}
 
-  QString sender = obj["sender"].toString();
-  if (sender.isEmpty()) {
-    sender = obj["from"].toString();
+void ChatSDKWindow::ingestNewMessage(const InboundMessage &message,
+                                     IngestBatch &batch) {
+  const QString &conversationId = message.conversationId;
+  const QString &sender = message.sender;
+  const QString &content = message.content;
+
+  // Messages delivered straight to the slot have no receipt stamp
+  const qint64 dispatchedNs = message.receivedNs ? LatencyMonitor::now() : 0;
+
+  // This lookup is the only time the id is hashed: the window's bookkeeping
+  // goes by handle, and the store and the search index by the keys cached
+  // for it. The message is stored immediately; the conversation's activity
+  // is recorded once per batch, in the flush.
+  const QDateTime &receivedAt = message.receivedAt;
+  const auto handle = m_conversations.find(conversationId);
+  qint64 row = 0;
+  if (handle != ConversationRegistry::kInvalid) {
+    batch.activity[handle].lastActivity = receivedAt;
+    const IngestKeys &keys = ingestKeysFor(handle);
+    row = m_store->append(keys.store, {sender, content, receivedAt, false});
+    m_searchIndex->addMessage(quint32(keys.search), row, content);
+  } else {
+    row = m_store->append(conversationId, {sender, content, receivedAt, false});
+    indexMessage(conversationId, row, content);
   }
-  if (sender.isEmpty()) {
-    sender = "Peer";
+  const qint64 storedNs = dispatchedNs ? LatencyMonitor::now() : 0;
+  if (dispatchedNs) {
+    m_latency->recordStored(message.receivedNs, dispatchedNs, storedNs);
+  }
+
+  // If this is the currently selected conversation, show the message. When
+  // an older page is on screen it arrives later through paging instead.
+  if (handle == ConversationRegistry::kInvalid) {
+    // Not listed; kept in the store only
+  } else if (handle == m_currentConversation) {
+    if (row == m_loadedHistoryEnd) {
+      batch.currentConversationMessages.append(
+          {sender, content, receivedAt, false});
+      m_loadedHistoryEnd = row + 1;
+      if (dispatchedNs) {
+        m_latency->expectPaint(message.receivedNs, storedNs);
+      }
+    }
+  } else {
+    batch.activity[handle].unreadIncrement++;
   }
 
-  // Update conversation list with new activity
-  QDateTime receivedAt = QDateTime::currentDateTime();
-  if (m_conversations.contains(conversationId)) {
-    m_conversations[conversationId].lastActivity = receivedAt;
-    m_conversationList->updateConversation(conversationId, receivedAt);
+  batch.lastSender = sender;
+  batch.messageCount++;
+}
+
+void ChatSDKWindow::flushIngestBatch(IngestBatch &batch) {
+  if (batch.messageCount == 0)
+    return;
+  StallWatchdog::Scope stallScope("ChatSDKWindow::flushIngestBatch",
+                                  batch.messageCount, "messages");
+
+  // Activity is persisted and indexed once per conversation in the batch
+  for (auto it = batch.activity.constBegin(); it != batch.activity.constEnd();
+       ++it) {
+    const QString &conversationId = m_conversations.idOf(it.key());
+    m_store->touchConversation(conversationId, it.value().lastActivity);
+    m_conversationIndex->touch(conversationId, it.value().lastActivity);
   }
 
-  m_messages[conversationId].append({sender, content, receivedAt, false});
+  // One list refresh, one timeline append (with one scroll) per batch
+  m_conversationList->applyActivity(batch.activity);
+  m_chatPanel->addMessages(batch.currentConversationMessages);
 
-  // If this is the currently selected conversation, show the message
-  if (conversationId == m_currentConversationId) {
-    m_chatPanel->addMessage(sender, content, receivedAt, false);
+  // Show notification
+  if (batch.messageCount == 1) {
+    m_statusBar->showMessage(
+        QString("New message from %1").arg(batch.lastSender), 3000);
   } else {
-    m_conversationList->incrementUnread(conversationId);
+    m_statusBar->showMessage(
+        QString("%1 new messages").arg(batch.messageCount), 3000);
   }
 
-  // Show notification
-  m_statusBar->showMessage(QString("New message from %1").arg(sender), 3000);
+  batch = IngestBatch();
 }
 
 void ChatSDKWindow::onChatsdkNewConversation(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: New conversation received:" << data;
-
-  if (data.isEmpty())
+  InboundConversation conversation;
+  if (!EventDecoder::decodeConversation(data, &conversation))
     return;
 
-  // Parse the JSON
-  QString jsonStr = data[0].toString();
-  QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
-  if (!doc.isObject())
-    return;
+  applyNewConversation(conversation);
+}
 
-  QJsonObject obj = doc.object();
-  QString conversationId = obj["conversationId"].toString();
-  QString conversationType = obj["conversationType"].toString();
-  QString peerId;
+void ChatSDKWindow::applyNewConversation(
+    const InboundConversation &conversation) {
+  const QString &conversationId = conversation.conversationId;
+  const QString &conversationType = conversation.conversationType;
+  const QString &peerId = conversation.peerId;
 
-  if (conversationId.isEmpty()) {
-    return;
-  }
-
-  if (m_conversations.contains(conversationId)) {
-    m_conversationList->updateConversation(conversationId,
+  bool added = false;
+  const auto handle = m_conversations.intern(conversationId, &added);
+  if (!added) {
+    m_conversationList->updateConversation(handle,
                                            QDateTime::currentDateTime());
     return;
   }
 
-  // Try to extract peer identity
-  if (obj.contains("peerId")) {
-    peerId = obj["peerId"].toString();
-  } else if (obj.contains("peerIdentity")) {
-    peerId = obj["peerIdentity"].toString();
-  }
-
   // Use peer identity (first 6 chars) or fallback to conversation ID (first 8 chars)
   QString displayName;
   if (!peerId.isEmpty()) {
-    m_peerIdentities[conversationId] = peerId;
     displayName = peerId.left(6);
-    qDebug() << "ChatSDKWindow: Peer identity:" << displayName;
+    qCDebug(lcWindow) << "ChatSDKWindow: Peer identity:" << displayName;
   } else {
     displayName = conversationId.left(8);
   }
 
+  auto &convo = m_conversations[handle];
+  convo.name = QString("Chat %1").arg(displayName);
+  convo.peerId = peerId;
+  convo.lastActivity = QDateTime::currentDateTime();
+
   // Add to conversation list
-  m_conversationList->addConversation(
-      conversationId, QString("Chat %1").arg(displayName),
-      QDateTime::currentDateTime());
+  m_conversationList->addConversation(handle);
 
-  m_conversations[conversationId] = {
-      QString("Chat %1").arg(displayName), peerId,
-      QDateTime::currentDateTime()};
+  m_store->upsertConversation(conversationId, convo.name, peerId,
+                              convo.lastActivity);
+  m_conversationIndex->addConversation(conversationId, convo.name, peerId,
+                                       convo.lastActivity);
 
   // WORKAROUND: If there's a pending initial message from newPrivateConversation,
   // add it to this conversation (the first new one created).
@@ -737,15 +1482,16 @@ void ChatSDKWindow::onChatsdkNewConversation(const QVariantList &data) {
   bool initiatedLocally = !m_pendingInitialMessage.isEmpty();
   if (initiatedLocally) {
     QDateTime createdAt = QDateTime::currentDateTime();
-    m_messages[conversationId].append(
-        {"Me", m_pendingInitialMessage, createdAt, true});
+    const qint64 row = m_store->append(
+        conversationId, {"Me", m_pendingInitialMessage, createdAt, true});
+    indexMessage(conversationId, row, m_pendingInitialMessage);
     m_pendingInitialMessage.clear();
     shouldAutoSelect = true;
   }
 
   // Auto-select if this is a conversation we initiated
   if (shouldAutoSelect) {
-    m_conversationList->selectConversation(conversationId);
+    m_conversationList->selectConversation(handle);
     onConversationSelected(conversationId);
   }
 
@@ -756,7 +1502,8 @@ void ChatSDKWindow::onChatsdkNewConversation(const QVariantList &data) {
 
 void ChatSDKWindow::onChatsdkNewPrivateConversationResult(
     const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: New private conversation result:" << data;
+  qCDebug(lcWindow) << "ChatSDKWindow: New private conversation result:"
+                    << ChatLogging::truncated(data);
 
   // data format: [success (bool), returnCode (int), conversationJson (QString),
   // timestamp (QString)]
@@ -783,24 +1530,24 @@ void ChatSDKWindow::onChatsdkNewPrivateConversationResult(
   m_statusBar->showMessage("Conversation created successfully", 3000);
 }
 
-void ChatSDKWindow::onChatsdkSendMessageResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Send message result:" << data;
-
-  // data format: [success (bool), returnCode (int), resultJson (QString),
-  // timestamp (QString)]
-  bool success = data.size() > 0 ? data[0].toBool() : false;
-  int returnCode = data.size() > 1 ? data[1].toInt() : -1;
+void ChatSDKWindow::onChatsdkSendMessageResult(
+    const InboundSendResult &result) {
+  if (!result.success) {
+    qCDebug(lcEvents) << "ChatSDKWindow: Send failed with code"
+                      << result.returnCode;
+  }
 
-  if (success) {
-    m_statusBar->showMessage("Message sent", 2000);
-  } else {
-    m_statusBar->showMessage(
-        QString("Failed to send message (code: %1)").arg(returnCode), 3000);
+  // The module's results carry no client id; the outbox then matches them
+  // in send order, within the conversation when the result names one
+  if (m_outbox) {
+    m_outbox->handleResult(result.conversationId, result.clientId,
+                           result.success);
   }
 }
 
 void ChatSDKWindow::onChatsdkGetIdResult(const QVariantList &data) {
-  qDebug() << "ChatSDKWindow: Get ID result:" << data;
+  qCDebug(lcWindow) << "ChatSDKWindow: Get ID result:"
+                    << ChatLogging::truncated(data);
 
   // data format: [identity (QString), timestamp (QString)]
   if (data.size() > 0) {
@@ -808,14 +1555,17 @@ void ChatSDKWindow::onChatsdkGetIdResult(const QVariantList &data) {
     if (!identity.isEmpty()) {
       m_myIdentity = identity;
       m_identityLabel->setText(QString("ID: %1").arg(identity));
-      qDebug() << "ChatSDKWindow: My identity set to:" << identity;
+      qCDebug(lcWindow) << "ChatSDKWindow: My identity set to:" << identity;
+      reportStartupPhase("identity received");
     }
   }
 }
 
 void ChatSDKWindow::onMessageSent(const QString &conversationId,
                                   const QString &content) {
-  if (!m_chatRunning || !m_logos) {
+  StallWatchdog::Scope stallScope("ChatSDKWindow::onMessageSent",
+                                  content.size(), "chars");
+  if (!m_chatRunning || !m_backend) {
     m_statusBar->showMessage("Cannot send - chat not running", 3000);
     return;
   }
@@ -825,25 +1575,75 @@ void ChatSDKWindow::onMessageSent(const QString &conversationId,
     return;
   }
 
-  qDebug() << "ChatSDKWindow: Sending message to conversation:"
-           << conversationId << "content:" << content;
+  // Content stays out of the log; its length is enough to follow the flow
+  qCDebug(lcEvents) << "ChatSDKWindow: Sending message to conversation:"
+                    << conversationId << "chars:" << content.size();
 
   QDateTime sentAt = QDateTime::currentDateTime();
-  m_messages[conversationId].append({"Me", content, sentAt, true});
-
-  // Content must be hex-encoded for the libchat API
-  QString contentHex = QString::fromLatin1(content.toUtf8().toHex());
+  const ChatMessage message{"Me", content, sentAt, true,
+                            ChatMessage::SendState::Pending};
+  const qint64 row = m_store->append(conversationId, message);
+  indexMessage(conversationId, row, content);
+
+  // Content must be hex-encoded for the libchat API. The outbox hands it to
+  // the backend on its own thread; the result comes back through
+  // onChatsdkSendMessageResult and then onOutboxStateChanged.
+  const quint64 clientId = m_outbox->enqueue(
+      conversationId, row, HexCodec::encodeText(content));
+  qCDebug(lcEvents) << "ChatSDKWindow: Queued message" << clientId
+                    << "at row" << row;
+
+  // Sending counts as activity: the conversation moves up the list
+  const auto handle = m_conversations.find(conversationId);
+  if (handle != ConversationRegistry::kInvalid) {
+    m_store->touchConversation(conversationId, sentAt);
+    m_conversationIndex->touch(conversationId, sentAt);
+    m_conversationList->updateConversation(handle, sentAt);
+  }
 
-  // Send via the chatsdk_module
-  bool success =
-      m_logos->chatsdk_module.sendMessage(conversationId, contentHex);
+  // Shown at once, pending, if the newest page is loaded; otherwise jump to
+  // the newest page, which now includes it
+  if (handle != ConversationRegistry::kInvalid &&
+      handle == m_currentConversation) {
+    if (row == m_loadedHistoryEnd) {
+      m_loadedHistoryEnd = row + 1;
+      m_chatPanel->addMessage(message);
+    } else {
+      showConversationMessages(conversationId);
+    }
+  }
+}
 
-  if (success) {
-    m_statusBar->showMessage("Sending message...", 2000);
-  } else {
+void ChatSDKWindow::onOutboxStateChanged(const QString &conversationId,
+                                         qint64 row, quint64 clientId,
+                                         ChatMessage::SendState state) {
+  if (state == ChatMessage::SendState::Failed) {
+    qCWarning(lcBackend) << "ChatSDKWindow: Message" << clientId
+                         << "could not be sent";
     m_statusBar->showMessage("Failed to send message", 3000);
   }
-  // Result will come via onChatsdkSendMessageResult
+  // Kept with the message, so it survives a restart
+  m_store->setSendState(conversationId, row, state);
+
+  if (isCurrentConversation(conversationId)) {
+    if (row >= m_loadedHistoryStart && row < m_loadedHistoryEnd) {
+      m_chatPanel->setSendState(static_cast<int>(row - m_loadedHistoryStart),
+                                state);
+    }
+    return;
+  }
+  // A stashed timeline is kept current, so switching back shows it
+  const auto handle = m_conversations.find(conversationId);
+  CachedTimeline *cached = nullptr;
+  if (handle != ConversationRegistry::kInvalid) {
+    cached = m_timelineCache.object(handle);
+    if (!cached) {
+      cached = m_prefetchedTimelines.object(handle);
+    }
+  }
+  if (cached && row >= cached->historyStart && row < cached->historyEnd) {
+    cached->state.messages[row - cached->historyStart].sendState = state;
+  }
 }
 
 void ChatSDKWindow::onAboutAction() {
@@ -4,31 +4,90 @@
 #include <QSplitter>
 #include <QStatusBar>
 #include <QMenuBar>
-#include <QMap>
 #include <QDateTime>
 #include <QAction>
 #include <QLabel>
-#include <QMutex>
-#include "logos_api.h"
-#include "logos_sdk.h"
+#include <QHash>
+#include <QCache>
+#include <QSet>
+#include <QElapsedTimer>
+#include <atomic>
+#include "ChatPanel.h"
+#include "ConversationListModel.h"
+#include "ConversationRegistry.h"
+#include "InboundEventQueue.h"
+#include "MessageListModel.h"
 
+class ConversationIndex;
 class ConversationListPanel;
-class ChatPanel;
+class EventDecoder;
+class IChatBackend;
+class LatencyMonitor;
+class LogosAPI;
+class MessageStore;
+class Outbox;
+class QuickSwitcher;
+class SearchDialog;
+class SearchIndex;
+class StallWatchdog;
+class QThread;
+class QThreadPool;
+class QTimer;
 
 class ChatSDKWindow : public QMainWindow {
     Q_OBJECT
 
 public:
+    // Talks to chatsdk_module through logosAPI (or a LogosAPI of its own),
+    // or to FakeChatBackend when CHATSDK_FAKE_BACKEND=1. The backend is
+    // created when chat is first initialized, so the window can be built
+    // before the modules are loaded.
     explicit ChatSDKWindow(LogosAPI* logosAPI = nullptr, QWidget* parent = nullptr);
+    // Uses the given backend and takes ownership of it
+    explicit ChatSDKWindow(IChatBackend* backend, QWidget* parent = nullptr);
     ~ChatSDKWindow();
 
+    // Batch size / drain time counters for inbound event ingestion
+    InboundEventQueue::Stats ingestStats() const;
+    // Receipt-to-paint latency of incoming messages, per stage
+    const LatencyMonitor* latencyMonitor() const { return m_latency; }
+    // GUI-thread stalls with the handlers that were running
+    const StallWatchdog* stallWatchdog() const { return m_watchdog; }
+
+public slots:
+    // While true the window shows that it is connecting to Logos Core and
+    // holds back initialization; auto-start runs once it is set false
+    void setModulesLoading(bool loading);
+
+signals:
+    // "chat initialized", "chat started" and "identity received", as each
+    // first happens, for the host's startup timeline
+    void startupPhase(const QString& phase);
+
 private slots:
     // Menu actions
     void onConversationSelected(const QString& conversationId);
+    void onConversationHovered(const QString& conversationId);
+    void prefetchHoveredConversation();
+    void onConversationPinned(const QString& conversationId, bool pinned);
     void onNewConversationRequested();
     void onMyBundleRequested();
     void onMessageSent(const QString& conversationId, const QString& content);
+    void onOlderMessagesRequested(const QString& conversationId);
+    void onNewerMessagesRequested(const QString& conversationId);
+    void onSearchRequested();
+    void onSearchQueryChanged(const QString& query, bool currentConversationOnly);
+    void onSearchResultActivated(const QString& conversationId, qint64 row);
+    void onQuickSwitcherRequested();
+    void onQuickSwitchQueryChanged(const QString& query);
+    void onQuickSwitchChosen(const QString& conversationId);
     void onAboutAction();
+    void onLatencyOverlayToggled(bool visible);
+    void onDumpLatencyRequested();
+    void onShowStallsRequested();
+    void onLightThemeToggled(bool light);
+    void onThemeChanged();
+    void updateLatencyOverlay();
     
     // Chat lifecycle menu actions
     void onInitChat();
@@ -43,27 +102,79 @@ private slots:
     void onChatsdkNewMessage(const QVariantList& data);
     void onChatsdkNewConversation(const QVariantList& data);
     void onChatsdkNewPrivateConversationResult(const QVariantList& data);
-    void onChatsdkSendMessageResult(const QVariantList& data);
+    void onChatsdkSendMessageResult(const InboundSendResult& result);
     void onChatsdkGetIdResult(const QVariantList& data);
+    void onOutboxStateChanged(const QString& conversationId, qint64 row, quint64 clientId,
+                              ChatMessage::SendState state);
+
+    // Drains every event queued since the last drain in one pass
+    void drainInboundEvents();
 
 private:
+    // UI work accumulated while ingesting a batch of new messages
+    struct IngestBatch {
+        QList<MessageListModel::Message> currentConversationMessages;
+        QHash<ConversationRegistry::Handle, ConversationListModel::ActivityUpdate> activity;
+        QString lastSender;
+        int messageCount = 0;
+    };
+
+    // A listed conversation's keys in the store and the search index, so
+    // ingesting a message hashes its id only for the registry lookup
+    struct IngestKeys {
+        int store = -1;     // MessageStore::ConversationKey, -1 until first used
+        qint64 search = -1; // Reset when m_searchIndex is replaced
+    };
+
+    static IChatBackend* createBackend(LogosAPI* logosAPI);
+    // Creates the backend on first use when it was not given up front
+    bool ensureBackend();
+    void attachBackend();
+    void reportStartupPhase(const QString& phase);
     void setupUI();
     void setupMenu();
     void setupEventHandlers();
     void updateChatMenuState();
+    void restoreConversations();
+    bool activateConversation(const QString& conversationId);
+    // Compares ids without a registry lookup
+    bool isCurrentConversation(const QString& conversationId) const;
     void showConversationMessages(const QString& conversationId);
+    // Store rows with the outbox's delivery state applied
+    QList<ChatMessage> readTimeline(const QString& conversationId, qint64 first,
+                                    qint64 count) const;
+    void applySendStates(const QString& conversationId, qint64 first,
+                         QList<ChatMessage>& messages) const;
+    // GUI thread side of prefetchHoveredConversation()
+    void adoptPrefetchedTimeline(ConversationRegistry::Handle handle,
+                                 const QString& conversationId, qint64 first,
+                                 QList<ChatMessage> messages);
+    void stashCurrentTimeline();
+    bool restoreCachedTimeline(const QString& conversationId);
+    void indexMessage(const QString& conversationId, qint64 row, const QString& content);
+    // Indexes m_indexBackfill on m_readPool
+    void backfillSearchIndex();
+    // GUI thread side of backfillSearchIndex(); takes over restored's contents
+    void adoptBackfilledIndex(SearchIndex& restored);
+    void dispatchInboundEvent(const InboundEventQueue::Event& event);
+    void ingestNewMessage(const InboundMessage& message, IngestBatch& batch);
+    IngestKeys& ingestKeysFor(ConversationRegistry::Handle handle);
+    void applyNewConversation(const InboundConversation& conversation);
+    void flushIngestBatch(IngestBatch& batch);
 
-    // LogosAPI integration
-    LogosAPI* m_logosAPI;
-    bool m_ownsLogosAPI;  // Track if we created the LogosAPI ourselves
-    LogosModules* m_logos;
+    // chatsdk_module, or a stand-in for it
+    IChatBackend* m_backend;
+    LogosAPI* m_logosAPI;          // For the backend created on first use
+    bool m_createBackendOnDemand;  // False when a backend was passed in
+    bool m_modulesLoading;
+    QElapsedTimer m_startupClock;  // From construction, for startupPhase
+    QStringList m_startupPhasesSeen;
     bool m_chatInitialized;
     bool m_chatRunning;
     bool m_pendingBundleRequest;
     bool m_autoStartOnLaunch;
   QString m_pendingInitialMessage;  // Workaround for issue #86
   QString m_myIdentity;
-  QMap<QString, QString> m_peerIdentities;  // conversationId -> peerId
     QSplitter* m_splitter;
     ConversationListPanel* m_conversationList;
     ChatPanel* m_chatPanel;
@@ -74,21 +185,44 @@ private:
     QAction* m_startChatAction;
     QAction* m_stopChatAction;
     QLabel* m_identityLabel;
+    QLabel* m_latencyLabel;   // Status bar latency readout, hidden by default
+    QTimer* m_latencyTimer;   // Refreshes m_latencyLabel while it is shown
+    LatencyMonitor* m_latency;
+    StallWatchdog* m_watchdog;
+    InboundEventQueue* m_inboundQueue;
+    EventDecoder* m_decoder;
+    QThread* m_decoderThread;
+    MessageStore* m_store;  // Message history, on disk unless CHATSDK_PERSIST=0
+    SearchIndex* m_searchIndex;
+    SearchDialog* m_searchDialog;
+    ConversationIndex* m_conversationIndex;  // Names and peer ids for the quick switcher
+    QuickSwitcher* m_quickSwitcher;
+    Outbox* m_outbox;  // Pipelined sends with delivery state; null without a backend
+    // Restored history still to be indexed: conversation -> rows before restore
+    QList<QPair<QString, qint64>> m_indexBackfill;
 
-    // Store conversation messages
-    struct ConversationInfo {
-        QString name;
-        QString peerId;
-        QDateTime lastActivity;
-    };
-    struct MessageInfo {
-        QString sender;
-        QString content;
-        QDateTime timestamp;
-        bool isMe;
+    // Conversation metadata, shared with the conversation list; messages
+    // live in m_store
+    ConversationRegistry m_conversations;
+    QVector<IngestKeys> m_ingestKeys;  // Indexed by registry handle
+    // Currently selected conversation, or ConversationRegistry::kInvalid
+    ConversationRegistry::Handle m_currentConversation;
+    qint64 m_loadedHistoryStart;  // First store row shown in the timeline
+    qint64 m_loadedHistoryEnd;    // One past the last store row shown
+    // Timelines of recently shown conversations, least recently used dropped
+    // first; the current one is not in here while it is shown
+    struct CachedTimeline {
+        ChatPanel::TimelineState state;
+        qint64 historyStart = 0;
+        qint64 historyEnd = 0;
     };
-    QMap<QString, ConversationInfo> m_conversations;
-    QMap<QString, QList<MessageInfo>> m_messages;
-    QString m_currentConversationId;  // Currently selected conversation
-    QMutex m_conversationsMutex;  // Protect conversation and message maps from concurrent access
+    QCache<ConversationRegistry::Handle, CachedTimeline> m_timelineCache;
+    // Newest pages of hovered conversations, kept apart from m_timelineCache
+    QCache<ConversationRegistry::Handle, CachedTimeline> m_prefetchedTimelines;
+    QSet<ConversationRegistry::Handle> m_prefetching;  // Being read on m_readPool
+    QTimer* m_hoverTimer;  // Restarted by each hover; prefetches when it fires
+    QString m_hoveredConversationId;
+    QThreadPool* m_readPool;  // Off-GUI store reads; waited for before m_store goes
+    std::atomic<bool> m_closing;  // Set by the destructor to cut reads on m_readPool short
+    bool m_asyncLogging;  // Holds a ChatLogging::installAsyncSink() reference
 };
@@ -0,0 +1,311 @@
+#include "ConversationIndex.h"
+#include <QSet>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Match quality tiers; a field other than the name scores kSecondaryFieldPenalty less
+constexpr int kExactScore = 1000;
+constexpr int kPrefixScore = 900;
+constexpr int kWordPrefixScore = 800;
+constexpr int kSubstringScore = 700;
+constexpr int kSubsequenceMinScore = 300;
+constexpr int kSubsequenceMaxScore = 600;
+constexpr int kTrigramMinScore = 100;
+constexpr int kTrigramMaxScore = 300;
+constexpr int kSecondaryFieldPenalty = 50;
+// Words starting with a long query's first letter checked for a subsequence
+// match when the trigrams come up short
+constexpr int kMaxSubsequenceWords = 512;
+// Activity today adds up to this much, so recency breaks ties within a tier
+// without lifting a weak match over a clearly better one
+constexpr double kRecencyWeight = 60.0;
+constexpr double kMsPerDay = 86400.0 * 1000.0;
+// Entry::lastActivityMs of a conversation without activity
+constexpr qint64 kNoActivity = std::numeric_limits<qint64>::min();
+
+quint64 trigramAt(const QString& text, int i)
+{
+    return (quint64(text.at(i).unicode()) << 32) | (quint64(text.at(i + 1).unicode()) << 16) |
+           quint64(text.at(i + 2).unicode());
+}
+
+QSet<quint64> trigramsOf(const QStringList& fields)
+{
+    QSet<quint64> trigrams;
+    for (const QString& field : fields) {
+        for (int i = 0; i + 3 <= field.size(); ++i) {
+            trigrams.insert(trigramAt(field, i));
+        }
+    }
+    return trigrams;
+}
+
+bool startsWord(const QString& text, int pos)
+{
+    return pos == 0 || !text.at(pos - 1).isLetterOrNumber();
+}
+
+int fieldQuality(const QString& field, const QString& query)
+{
+    if (field == query) return kExactScore;
+    if (field.startsWith(query)) return kPrefixScore;
+
+    int pos = field.indexOf(query);
+    if (pos >= 0) {
+        for (; pos >= 0; pos = field.indexOf(query, pos + 1)) {
+            if (startsWord(field, pos)) return kWordPrefixScore;
+        }
+        return kSubstringScore;
+    }
+
+    // Letters in order with gaps: the tighter the span, the better
+    int first = -1;
+    int at = 0;
+    for (const QChar c : query) {
+        at = field.indexOf(c, at);
+        if (at < 0) return 0;
+        if (first < 0) first = at;
+        ++at;
+    }
+    const int span = at - first;
+    return kSubsequenceMinScore +
+           (kSubsequenceMaxScore - kSubsequenceMinScore) * query.size() / span;
+}
+
+} // namespace
+
+void ConversationIndex::addConversation(const QString& id, const QString& name,
+                                        const QString& peerId, const QDateTime& lastActivity)
+{
+    int slot = m_slotById.value(id, -1);
+    if (slot >= 0) {
+        unindexEntry(slot);
+    } else if (!m_freeSlots.isEmpty()) {
+        slot = m_freeSlots.takeLast();
+    } else {
+        slot = m_entries.size();
+        m_entries.append(Entry());
+    }
+
+    Entry& entry = m_entries[slot];
+    entry.id = id;
+    entry.fields = QStringList{name.toCaseFolded(), peerId.toCaseFolded(), id.toCaseFolded()};
+    entry.lastActivityMs = activityMs(lastActivity);
+    entry.live = true;
+    m_slotById.insert(id, slot);
+    indexEntry(slot);
+}
+
+void ConversationIndex::removeConversation(const QString& id)
+{
+    auto it = m_slotById.find(id);
+    if (it == m_slotById.end()) return;
+    const int slot = it.value();
+    m_slotById.erase(it);
+
+    unindexEntry(slot);
+    m_entries[slot] = Entry();
+    m_freeSlots.append(slot);
+}
+
+void ConversationIndex::touch(const QString& id, const QDateTime& lastActivity)
+{
+    const int slot = m_slotById.value(id, -1);
+    if (slot >= 0) {
+        m_entries[slot].lastActivityMs = activityMs(lastActivity);
+    }
+}
+
+QStringList ConversationIndex::words(const QString& field)
+{
+    QStringList result;
+    if (field.isEmpty()) return result;
+
+    result.append(field);
+    int start = -1;
+    for (int i = 0; i <= field.size(); ++i) {
+        const bool inWord = i < field.size() && field.at(i).isLetterOrNumber();
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            // The whole field is already in; so is a word starting at 0
+            if (start > 0) {
+                result.append(field.mid(start, i - start));
+            }
+            start = -1;
+        }
+    }
+    result.removeDuplicates();
+    return result;
+}
+
+void ConversationIndex::indexEntry(int slot)
+{
+    const Entry& entry = m_entries.at(slot);
+    for (const quint64 trigram : trigramsOf(entry.fields)) {
+        m_trigrams[trigram].append(slot);
+    }
+
+    QStringList entryWords;
+    for (const QString& field : entry.fields) {
+        entryWords += words(field);
+    }
+    entryWords.removeDuplicates();
+    for (const QString& word : entryWords) {
+        const std::pair<QString, int> key(word, slot);
+        m_words.insert(std::lower_bound(m_words.begin(), m_words.end(), key), key);
+    }
+}
+
+void ConversationIndex::unindexEntry(int slot)
+{
+    const Entry& entry = m_entries.at(slot);
+    for (const quint64 trigram : trigramsOf(entry.fields)) {
+        auto it = m_trigrams.find(trigram);
+        if (it == m_trigrams.end()) continue;
+        it->removeOne(slot);
+        if (it->isEmpty()) {
+            m_trigrams.erase(it);
+        }
+    }
+
+    QStringList entryWords;
+    for (const QString& field : entry.fields) {
+        entryWords += words(field);
+    }
+    entryWords.removeDuplicates();
+    for (const QString& word : entryWords) {
+        const std::pair<QString, int> key(word, slot);
+        auto it = std::lower_bound(m_words.begin(), m_words.end(), key);
+        if (it != m_words.end() && *it == key) {
+            m_words.erase(it);
+        }
+    }
+}
+
+int ConversationIndex::matchQuality(const QStringList& fields, const QString& query)
+{
+    int best = 0;
+    for (int i = 0; i < fields.size(); ++i) {
+        int quality = fieldQuality(fields.at(i), query);
+        if (quality > 0 && i > 0) {
+            quality -= kSecondaryFieldPenalty;
+        }
+        best = qMax(best, quality);
+    }
+    return best;
+}
+
+qint64 ConversationIndex::activityMs(const QDateTime& lastActivity)
+{
+    return lastActivity.isValid() ? lastActivity.toMSecsSinceEpoch() : kNoActivity;
+}
+
+int ConversationIndex::recencyBonus(qint64 lastActivityMs, qint64 nowMs)
+{
+    if (lastActivityMs == kNoActivity) return 0;
+    const double days = qMax<qint64>(0, nowMs - lastActivityMs) / kMsPerDay;
+    return qRound(kRecencyWeight / (1.0 + days));
+}
+
+QList<ConversationIndex::Match> ConversationIndex::search(QStringView query, int limit,
+                                                           const QDateTime& now) const
+{
+    QList<Match> matches;
+    if (limit <= 0) return matches;
+
+    const QString folded = query.trimmed().toString().toCaseFolded();
+    const qint64 nowMs = now.toMSecsSinceEpoch();
+    auto rank = [&matches, limit]() {
+        const auto last = matches.begin() + qMin<qsizetype>(limit, matches.size());
+        std::partial_sort(matches.begin(), last, matches.end(),
+                          [](const Match& a, const Match& b) { return a.score > b.score; });
+        matches.erase(last, matches.end());
+    };
+
+    if (folded.isEmpty()) {
+        for (const Entry& entry : m_entries) {
+            if (entry.live) {
+                matches.append({entry.id, recencyBonus(entry.lastActivityMs, nowMs)});
+            }
+        }
+        rank();
+        return matches;
+    }
+
+    // Candidates from the indexes: trigram hits, or word prefixes for
+    // queries shorter than a trigram
+    std::vector<int> hits(m_entries.size(), 0);
+    int queryTrigrams = 0;
+    if (folded.size() < 3) {
+        auto it = std::lower_bound(m_words.begin(), m_words.end(),
+                                   std::make_pair(folded, std::numeric_limits<int>::min()));
+        for (; it != m_words.end() && it->first.startsWith(folded); ++it) {
+            hits[it->second] = 1;
+        }
+    } else {
+        const QSet<quint64> trigrams = trigramsOf({folded});
+        queryTrigrams = trigrams.size();
+        for (const quint64 trigram : trigrams) {
+            const auto it = m_trigrams.constFind(trigram);
+            if (it == m_trigrams.constEnd()) continue;
+            for (const int slot : *it) {
+                ++hits[slot];
+            }
+        }
+    }
+
+    for (int slot = 0; slot < m_entries.size(); ++slot) {
+        if (hits[slot] == 0) continue;
+        const Entry& entry = m_entries.at(slot);
+        int quality = matchQuality(entry.fields, folded);
+        // Shares most of the query's trigrams, though not in order
+        if (quality == 0 && queryTrigrams > 0 && 2 * hits[slot] >= queryTrigrams) {
+            quality = kTrigramMinScore +
+                      (kTrigramMaxScore - kTrigramMinScore) * hits[slot] / queryTrigrams;
+        }
+        if (quality > 0) {
+            matches.append({entry.id, quality + recencyBonus(entry.lastActivityMs, nowMs)});
+        }
+    }
+
+    // Too few word prefixes for a short query: letters typed with gaps or
+    // inside a word
+    if (folded.size() < 3 && matches.size() < limit) {
+        for (int slot = 0; slot < m_entries.size(); ++slot) {
+            const Entry& entry = m_entries.at(slot);
+            if (hits[slot] != 0 || !entry.live) continue;
+            const int quality = matchQuality(entry.fields, folded);
+            if (quality > 0) {
+                matches.append({entry.id, quality + recencyBonus(entry.lastActivityMs, nowMs)});
+            }
+        }
+    }
+
+    // Too few trigram matches for a longer query: letters typed with gaps
+    // share no trigram ("jsmth" for "john smith"). Conversations with a word
+    // starting with the query's first letter are checked for a subsequence,
+    // up to kMaxSubsequenceWords words.
+    if (folded.size() >= 3 && matches.size() < limit) {
+        const QString first = folded.left(1);
+        auto it = std::lower_bound(m_words.begin(), m_words.end(),
+                                   std::make_pair(first, std::numeric_limits<int>::min()));
+        for (int scanned = 0; it != m_words.end() && it->first.startsWith(first) &&
+                              scanned < kMaxSubsequenceWords;
+             ++it, ++scanned) {
+            const int slot = it->second;
+            if (hits[slot] != 0) continue;
+            hits[slot] = 1;
+            const Entry& entry = m_entries.at(slot);
+            const int quality = matchQuality(entry.fields, folded);
+            if (quality > 0) {
+                matches.append({entry.id, quality + recencyBonus(entry.lastActivityMs, nowMs)});
+            }
+        }
+    }
+
+    rank();
+    return matches;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <utility>
+#include <vector>
+
+/**
+ * Fuzzy lookup of conversations by name, peer id or conversation id, for
+ * the quick switcher.
+ *
+ * Each conversation's fields are case-folded once when it is added. Two
+ * indexes are kept up to date as conversations come and go: every trigram
+ * of every field maps to the conversations containing it, and a sorted list
+ * of the fields' words answers queries too short to have a trigram by
+ * binary search. A query of three or more characters only scores the
+ * conversations sharing a trigram with it, so its cost follows the number
+ * of candidates rather than the number of conversations. A shorter query
+ * also scores the remaining conversations as a subsequence match when the
+ * word prefixes give fewer than asked for; a longer one with too few
+ * trigram matches does the same for a bounded number of words starting
+ * with its first letter.
+ *
+ * Matches rank by quality (whole field, prefix, word prefix, substring,
+ * subsequence, shared trigrams; names above peer and conversation ids) and
+ * then by how recently the conversation was active. Activity is kept as
+ * milliseconds since the epoch, so scoring does no date arithmetic.
+ */
+class ConversationIndex {
+public:
+    struct Match {
+        QString conversationId;
+        int score;
+    };
+
+    ConversationIndex() = default;
+
+    // Adding a known id replaces its fields
+    void addConversation(const QString& id, const QString& name, const QString& peerId,
+                         const QDateTime& lastActivity);
+    void removeConversation(const QString& id);
+    void touch(const QString& id, const QDateTime& lastActivity);
+
+    // Best matches first. An empty query lists the most recently active.
+    QList<Match> search(QStringView query, int limit = 20,
+                        const QDateTime& now = QDateTime::currentDateTime()) const;
+
+    int size() const { return m_slotById.size(); }
+
+private:
+    struct Entry {
+        QString id;
+        QStringList fields;  // Case-folded name, peer id, conversation id
+        qint64 lastActivityMs = 0;  // kNoActivity when never active
+        bool live = false;
+    };
+
+    using Postings = QVector<int>;
+
+    static QStringList words(const QString& field);
+    static int matchQuality(const QStringList& fields, const QString& query);
+    static qint64 activityMs(const QDateTime& lastActivity);
+    static int recencyBonus(qint64 lastActivityMs, qint64 nowMs);
+
+    void indexEntry(int slot);
+    void unindexEntry(int slot);
+
+    QVector<Entry> m_entries;
+    QVector<int> m_freeSlots;
+    QHash<QString, int> m_slotById;
+
+    QHash<quint64, Postings> m_trigrams;
+    // (word, slot), sorted by word, for one- and two-character queries
+    std::vector<std::pair<QString, int>> m_words;
+};
@@ -0,0 +1,102 @@
+#include "ConversationItemDelegate.h"
+#include "ConversationListModel.h"
+#include "Theme.h"
+#include <QFontMetrics>
+#include <QPainter>
+
+namespace {
+
+constexpr int kRowHeight = 50;
+constexpr int kPaddingH = 15;
+constexpr int kSpacing = 8;
+constexpr int kBadgeSize = 20;
+constexpr int kPinMarkerWidth = 3;
+
+} // namespace
+
+ConversationItemDelegate::ConversationItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void ConversationItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                     const QModelIndex& index) const
+{
+    const QString name = index.data(ConversationListModel::NameRole).toString();
+    const QString relativeTime = index.data(ConversationListModel::RelativeTimeRole).toString();
+    const int unreadCount = index.data(ConversationListModel::UnreadCountRole).toInt();
+    const bool pinned = index.data(ConversationListModel::PinnedRole).toBool();
+    const Theme& theme = Theme::instance();
+    const Theme::Colors& colors = theme.colors();
+
+    painter->save();
+
+    // Row background and divider
+    if (option.state & (QStyle::State_Selected | QStyle::State_MouseOver)) {
+        painter->fillRect(option.rect, colors.hover);
+    }
+    painter->setPen(colors.border);
+    painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
+
+    // Pinned rows carry an accent strip along the left edge
+    if (pinned) {
+        painter->fillRect(QRect(option.rect.left(), option.rect.top(),
+                                kPinMarkerWidth, option.rect.height() - 1),
+                          colors.accent);
+    }
+
+    QRect content = option.rect.adjusted(kPaddingH, 0, -kPaddingH, 0);
+
+    // Unread badge on the right
+    if (unreadCount > 0) {
+        const QRect badgeRect(content.right() - kBadgeSize + 1,
+                              content.center().y() - kBadgeSize / 2,
+                              kBadgeSize, kBadgeSize);
+        painter->setRenderHint(QPainter::Antialiasing, true);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(colors.badge);
+        painter->drawEllipse(badgeRect);
+
+        QFont badgeFont = option.font;
+        badgeFont.setPixelSize(10);
+        badgeFont.setBold(true);
+        painter->setFont(badgeFont);
+        painter->setPen(colors.onBadge);
+        painter->drawText(badgeRect, Qt::AlignCenter,
+                          unreadCount > 99 ? QString("99+") : QString::number(unreadCount));
+
+        content.setRight(badgeRect.left() - kSpacing);
+    }
+
+    // Name (bold) above relative time (muted)
+    const QFont& nameFont = theme.listNameFont();
+    const QFont& timeFont = theme.listTimeFont();
+
+    const QFontMetrics nameMetrics(nameFont);
+    const QFontMetrics timeMetrics(timeFont);
+    const int textHeight = nameMetrics.height() + timeMetrics.height();
+    const int top = content.top() + (content.height() - textHeight) / 2;
+
+    const QRect nameRect(content.left(), top, content.width(), nameMetrics.height());
+    const QRect timeRect(content.left(), nameRect.bottom() + 1,
+                         content.width(), timeMetrics.height());
+
+    painter->setFont(nameFont);
+    painter->setPen(colors.text);
+    painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      nameMetrics.elidedText(name, Qt::ElideRight, nameRect.width()));
+
+    painter->setFont(timeFont);
+    painter->setPen(colors.textFaint);
+    painter->drawText(timeRect, Qt::AlignLeft | Qt::AlignVCenter, relativeTime);
+
+    painter->restore();
+}
+
+QSize ConversationItemDelegate::sizeHint(const QStyleOptionViewItem& option,
+                                         const QModelIndex& index) const
+{
+    Q_UNUSED(option);
+    Q_UNUSED(index);
+    return QSize(0, kRowHeight);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+
+/**
+ * Paints a conversation row: name, relative time and an unread badge,
+ * with an accent strip on the left when the conversation is pinned.
+ *
+ * Replaces the per-row container widget and rich-text QLabel that used to
+ * be rebuilt on every update.
+ */
+class ConversationItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit ConversationItemDelegate(QObject* parent = nullptr);
+    ~ConversationItemDelegate() = default;
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option,
+                   const QModelIndex& index) const override;
+};
@@ -0,0 +1,356 @@
+#include "ConversationListModel.h"
+#include "StallWatchdog.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr qint64 kMinuteMs = 60 * 1000;
+
+} // namespace
+
+ConversationListModel::ConversationListModel(ConversationRegistry* registry, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_registry(registry)
+    , m_refreshAtMs(-1)
+{
+    // Labels change on minute boundaries at the finest; a second of slack
+    // lets the system batch the wakeup with others
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_refreshTimer, &QTimer::timeout,
+            this, &ConversationListModel::refreshRelativeTimes);
+}
+
+int ConversationListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_rows.size();
+}
+
+QVariant ConversationListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const Row& row = m_rows.at(index.row());
+    const ConversationRegistry::Conversation& conversation = m_registry->at(row.handle);
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return conversation.name;
+    case IdRole:
+        return conversation.id;
+    case LastActivityRole:
+        return conversation.lastActivity;
+    case RelativeTimeRole:
+        return row.relativeTime;
+    case UnreadCountRole:
+        return conversation.unreadCount;
+    case PinnedRole:
+        return conversation.pinned;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ConversationListModel::roleNames() const
+{
+    return {
+        {IdRole, "conversationId"},
+        {NameRole, "name"},
+        {LastActivityRole, "lastActivity"},
+        {RelativeTimeRole, "relativeTime"},
+        {UnreadCountRole, "unreadCount"},
+        {PinnedRole, "pinned"},
+    };
+}
+
+QModelIndex ConversationListModel::indexOf(Handle handle) const
+{
+    const int row = rowOf(handle);
+    return row < 0 ? QModelIndex() : index(row);
+}
+
+void ConversationListModel::addConversation(Handle handle)
+{
+    if (contains(handle)) {
+        setLastActivity(handle, m_registry->at(handle).lastActivity);
+        return;
+    }
+    if (m_rowByHandle.size() <= handle) {
+        m_rowByHandle.resize(handle + 1, -1);
+    }
+
+    Row entry;
+    entry.handle = handle;
+    updateRelativeTime(entry, QDateTime::currentDateTime());
+
+    // Restored conversations arrive newest first, so this is usually the end
+    const int row = int(std::partition_point(m_rows.cbegin(), m_rows.cend(),
+                                             [this, &entry](const Row& other) {
+                                                 return !sortsBefore(entry, other);
+                                             }) - m_rows.cbegin());
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.insert(row, entry);
+    reindexRows(row, m_rows.size() - 1);
+    endInsertRows();
+    scheduleRefresh();
+}
+
+void ConversationListModel::setLastActivity(Handle handle, const QDateTime& lastActivity)
+{
+    const int row = rowOf(handle);
+    if (row < 0) return;
+
+    (*m_registry)[handle].lastActivity = lastActivity;
+    updateRelativeTime(m_rows[row], QDateTime::currentDateTime());
+    emitRowChanged(placeRow(row), {LastActivityRole, RelativeTimeRole});
+    scheduleRefresh();
+}
+
+void ConversationListModel::setPinned(Handle handle, bool pinned)
+{
+    const int row = rowOf(handle);
+    if (row < 0) return;
+
+    ConversationRegistry::Conversation& conversation = (*m_registry)[handle];
+    if (conversation.pinned == pinned) return;
+    conversation.pinned = pinned;
+    emitRowChanged(placeRow(row), {PinnedRole});
+}
+
+void ConversationListModel::removeConversation(Handle handle)
+{
+    const int row = rowOf(handle);
+    if (row < 0) return;
+
+    if (m_rows.at(row).relativeTimeDue >= 0) {
+        m_refreshQueue.remove(m_rows.at(row).relativeTimeDue, handle);
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.removeAt(row);
+    m_rowByHandle[handle] = -1;
+    reindexRows(row, m_rows.size() - 1);
+    endRemoveRows();
+}
+
+void ConversationListModel::clear()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_rowByHandle.clear();
+    m_refreshQueue.clear();
+    endResetModel();
+    scheduleRefresh();
+}
+
+void ConversationListModel::incrementUnread(Handle handle)
+{
+    const int row = rowOf(handle);
+    if (row < 0) return;
+
+    (*m_registry)[handle].unreadCount++;
+    emitRowChanged(row, {UnreadCountRole});
+}
+
+void ConversationListModel::clearUnread(Handle handle)
+{
+    const int row = rowOf(handle);
+    if (row < 0) return;
+
+    ConversationRegistry::Conversation& conversation = (*m_registry)[handle];
+    if (conversation.unreadCount == 0) return;
+    conversation.unreadCount = 0;
+    emitRowChanged(row, {UnreadCountRole});
+}
+
+void ConversationListModel::applyActivity(const QHash<Handle, ActivityUpdate>& updates)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    for (auto it = updates.constBegin(); it != updates.constEnd(); ++it) {
+        const int row = rowOf(it.key());
+        if (row < 0) continue;
+
+        ConversationRegistry::Conversation& conversation = (*m_registry)[it.key()];
+        conversation.unreadCount += it.value().unreadIncrement;
+        if (it.value().lastActivity.isValid()) {
+            conversation.lastActivity = it.value().lastActivity;
+            updateRelativeTime(m_rows[row], now);
+            placeRow(row);
+        }
+    }
+
+    // Rows are where they belong now; a single notification covers the batch
+    int firstRow = -1;
+    int lastRow = -1;
+    for (auto it = updates.constBegin(); it != updates.constEnd(); ++it) {
+        const int row = rowOf(it.key());
+        if (row < 0) continue;
+        firstRow = firstRow < 0 ? row : qMin(firstRow, row);
+        lastRow = qMax(lastRow, row);
+    }
+    if (firstRow >= 0) {
+        emit dataChanged(index(firstRow), index(lastRow),
+                         {LastActivityRole, RelativeTimeRole, UnreadCountRole});
+    }
+    scheduleRefresh();
+}
+
+void ConversationListModel::emitRowChanged(int row, const QList<int>& roles)
+{
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, roles);
+}
+
+bool ConversationListModel::sortsBefore(const Row& a, const Row& b) const
+{
+    const ConversationRegistry::Conversation& first = m_registry->at(a.handle);
+    const ConversationRegistry::Conversation& second = m_registry->at(b.handle);
+    if (first.pinned != second.pinned) return first.pinned;
+    return first.lastActivity > second.lastActivity;
+}
+
+int ConversationListModel::placeRow(int row)
+{
+    const Row& moving = m_rows.at(row);
+    auto above = [this, &moving](const Row& other) { return sortsBefore(other, moving); };
+
+    // Rows with an equal key stay below the moved one: it was touched last
+    int destination;
+    int target;
+    if (row > 0 && !above(m_rows.at(row - 1))) {
+        destination = int(std::partition_point(m_rows.cbegin(), m_rows.cbegin() + row, above) -
+                          m_rows.cbegin());
+        target = destination;
+    } else if (row + 1 < m_rows.size() && above(m_rows.at(row + 1))) {
+        destination = int(std::partition_point(m_rows.cbegin() + row + 1, m_rows.cend(), above) -
+                          m_rows.cbegin());
+        target = destination - 1;
+    } else {
+        return row;
+    }
+    if (target == row) return row;
+
+    beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+    m_rows.move(row, target);
+    reindexRows(qMin(row, target), qMax(row, target));
+    endMoveRows();
+    return target;
+}
+
+void ConversationListModel::reindexRows(int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        m_rowByHandle[m_rows.at(i).handle] = i;
+    }
+}
+
+bool ConversationListModel::updateRelativeTime(Row& row, const QDateTime& now)
+{
+    const QDateTime& lastActivity = m_registry->at(row.handle).lastActivity;
+    if (row.relativeTimeDue >= 0) {
+        m_refreshQueue.remove(row.relativeTimeDue, row.handle);
+    }
+    row.relativeTimeDue = nextRelativeTimeChange(lastActivity, now);
+    if (row.relativeTimeDue >= 0) {
+        m_refreshQueue.insert(row.relativeTimeDue, row.handle);
+    }
+
+    QString relativeTime = formatRelativeTime(lastActivity, now);
+    if (relativeTime == row.relativeTime) {
+        return false;
+    }
+    row.relativeTime = relativeTime;
+    return true;
+}
+
+void ConversationListModel::scheduleRefresh()
+{
+    if (m_refreshQueue.isEmpty()) {
+        m_refreshTimer.stop();
+        m_refreshAtMs = -1;
+        return;
+    }
+
+    // Round up to a minute boundary, so rows that fall due within the same
+    // minute are refreshed by one wakeup
+    const qint64 due = m_refreshQueue.firstKey();
+    const qint64 refreshAt = (due + kMinuteMs - 1) / kMinuteMs * kMinuteMs;
+    if (m_refreshTimer.isActive() && m_refreshAtMs <= refreshAt) {
+        return;
+    }
+    m_refreshAtMs = refreshAt;
+    const qint64 delay = refreshAt - QDateTime::currentMSecsSinceEpoch();
+    m_refreshTimer.start(int(qBound<qint64>(0, delay, std::numeric_limits<int>::max())));
+}
+
+void ConversationListModel::refreshRelativeTimes()
+{
+    StallWatchdog::Scope stallScope("ConversationListModel::refreshRelativeTimes",
+                                    m_refreshQueue.size(), "queued");
+    m_refreshAtMs = -1;
+    const QDateTime now = QDateTime::currentDateTime();
+    const qint64 nowMs = now.toMSecsSinceEpoch();
+
+    // Only rows whose label is due are touched; updateRelativeTime() requeues
+    // each of them at its next change, which is always later than now
+    int firstRow = -1;
+    int lastRow = -1;
+    while (!m_refreshQueue.isEmpty() && m_refreshQueue.firstKey() <= nowMs) {
+        const int row = rowOf(m_refreshQueue.first());
+        if (row < 0) {
+            m_refreshQueue.erase(m_refreshQueue.begin());
+            continue;
+        }
+        if (updateRelativeTime(m_rows[row], now)) {
+            firstRow = firstRow < 0 ? row : qMin(firstRow, row);
+            lastRow = qMax(lastRow, row);
+        }
+    }
+
+    if (firstRow >= 0) {
+        emit dataChanged(index(firstRow), index(lastRow), {RelativeTimeRole});
+    }
+    scheduleRefresh();
+}
+
+QString ConversationListModel::formatRelativeTime(const QDateTime& dateTime, const QDateTime& now)
+{
+    qint64 secs = dateTime.secsTo(now);
+
+    if (secs < 60) {
+        return "Just now";
+    } else if (secs < 3600) {
+        int mins = secs / 60;
+        return QString("%1 min ago").arg(mins);
+    } else if (secs < 86400) {
+        int hours = secs / 3600;
+        return QString("%1 hour%2 ago").arg(hours).arg(hours > 1 ? "s" : "");
+    } else if (secs < 172800) {
+        return "Yesterday";
+    } else {
+        return dateTime.toString("MMM d");
+    }
+}
+
+qint64 ConversationListModel::nextRelativeTimeChange(const QDateTime& dateTime,
+                                                     const QDateTime& now)
+{
+    if (!dateTime.isValid()) return -1;
+
+    // Bucket boundaries of formatRelativeTime(), in seconds after dateTime
+    const qint64 secs = qMax<qint64>(0, dateTime.secsTo(now));
+    qint64 boundary;
+    if (secs < 3600) {
+        boundary = (secs / 60 + 1) * 60;
+    } else if (secs < 86400) {
+        boundary = (secs / 3600 + 1) * 3600;
+    } else if (secs < 172800) {
+        boundary = 172800;
+    } else {
+        return -1;
+    }
+    return dateTime.toMSecsSinceEpoch() + boundary * 1000;
+}
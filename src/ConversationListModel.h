@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QMultiMap>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include "ConversationRegistry.h"
+
+/**
+ * List model for the conversation panel.
+ *
+ * Each conversation is one row; activity and unread updates only emit
+ * dataChanged for the affected row instead of rebuilding any widgets.
+ *
+ * Names, activity, unread counts and pins are not copied into the model:
+ * a row holds the conversation's ConversationRegistry handle and reads its
+ * record, and the setters below write to that record. Rows are found by
+ * handle through a vector, without hashing the conversation id.
+ *
+ * Rows are kept ordered: pinned conversations first, then by last activity,
+ * newest first. When a row's activity or pin changes, its new place is found
+ * by binary search and it is moved there with beginMoveRows(), so views keep
+ * their selection and only the rows it passes over are renumbered.
+ *
+ * The relative time of each row is formatted once and kept with the row,
+ * along with the moment its label next changes ("Just now" -> "1 min ago",
+ * "59 min ago" -> "1 hour ago", ...). One timer, rounded up to the next
+ * minute boundary, wakes for the earliest of those moments and reformats
+ * only the rows that are due, so a quiet list costs nothing between them.
+ */
+class ConversationListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        NameRole,
+        LastActivityRole,
+        RelativeTimeRole,
+        UnreadCountRole,
+        PinnedRole
+    };
+
+    // Per-conversation changes accumulated over one ingestion batch
+    struct ActivityUpdate {
+        QDateTime lastActivity;
+        int unreadIncrement = 0;
+    };
+
+    using Handle = ConversationRegistry::Handle;
+
+    // registry must outlive the model
+    explicit ConversationListModel(ConversationRegistry* registry, QObject* parent = nullptr);
+    ~ConversationListModel() = default;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool contains(Handle handle) const { return rowOf(handle) >= 0; }
+    QModelIndex indexOf(Handle handle) const;
+
+    // Adds a row for a conversation whose record is already filled in
+    void addConversation(Handle handle);
+    void setLastActivity(Handle handle, const QDateTime& lastActivity);
+    void setPinned(Handle handle, bool pinned);
+    void removeConversation(Handle handle);
+    void clear();
+    void incrementUnread(Handle handle);
+    void clearUnread(Handle handle);
+    void applyActivity(const QHash<Handle, ActivityUpdate>& updates);
+
+    static QString formatRelativeTime(const QDateTime& dateTime,
+                                      const QDateTime& now = QDateTime::currentDateTime());
+    // When formatRelativeTime() next returns something else for dateTime,
+    // in ms since the epoch, or -1 once the label is a fixed date
+    static qint64 nextRelativeTimeChange(const QDateTime& dateTime, const QDateTime& now);
+
+private:
+    struct Row {
+        Handle handle = ConversationRegistry::kInvalid;
+        QString relativeTime;     // formatRelativeTime(lastActivity), cached
+        qint64 relativeTimeDue = -1;  // Key in m_refreshQueue, -1 if not queued
+    };
+
+    // -1 if the conversation has no row
+    int rowOf(Handle handle) const { return m_rowByHandle.value(handle, -1); }
+    void emitRowChanged(int row, const QList<int>& roles);
+    // True if a sorts above b
+    bool sortsBefore(const Row& a, const Row& b) const;
+    // Moves the row to its sorted place after its sort key changed; returns
+    // the row it ends up at
+    int placeRow(int row);
+    void reindexRows(int first, int last);
+    // Reformats the row's relative time and requeues it; true if the label changed
+    bool updateRelativeTime(Row& row, const QDateTime& now);
+    void scheduleRefresh();
+    void refreshRelativeTimes();
+
+    ConversationRegistry* m_registry;
+    QVector<Row> m_rows;
+    QVector<int> m_rowByHandle;  // Row of each handle, -1 if none
+    QMultiMap<qint64, Handle> m_refreshQueue;  // Label change time -> conversation
+    QTimer m_refreshTimer;
+    qint64 m_refreshAtMs;  // When m_refreshTimer fires, -1 while stopped
+};
@@ -1,8 +1,13 @@
 #include "ConversationListPanel.h"
-#include <QFont>
+#include "ConversationItemDelegate.h"
+#include "StallWatchdog.h"
+#include "Theme.h"
+#include <QMenu>
+#include <QScrollBar>
 
-ConversationListPanel::ConversationListPanel(QWidget* parent)
+ConversationListPanel::ConversationListPanel(ConversationRegistry* registry, QWidget* parent)
     : QWidget(parent)
+    , m_registry(registry)
 {
     setupUI();
 }
@@ -13,95 +18,50 @@ void ConversationListPanel::setupUI()
     m_mainLayout->setContentsMargins(0, 0, 0, 0);
     m_mainLayout->setSpacing(0);
 
-    // Set terminal background for the entire panel
-    setStyleSheet("background-color: #0A0A0A;");
+    // Panel background comes from the window's theme style sheet
+    setAttribute(Qt::WA_StyledBackground, true);
 
     // Header with title and new conversation button
     QWidget* headerWidget = new QWidget(this);
+    headerWidget->setObjectName(Theme::PanelHeader);
     headerWidget->setFixedHeight(50);
-    headerWidget->setStyleSheet("background-color: #0A0A0A; border-bottom: 1px solid #2a2a2a;");
     m_headerLayout = new QHBoxLayout(headerWidget);
     m_headerLayout->setContentsMargins(15, 0, 15, 0);
 
     m_titleLabel = new QLabel("> \xce\xbb chat", headerWidget);
-    m_titleLabel->setStyleSheet("color: #FAFAFA; background: transparent;");
-    QFont titleFont("JetBrains Mono", 14);
-    titleFont.setStyleHint(QFont::Monospace);
-    titleFont.setBold(true);
-    m_titleLabel->setFont(titleFont);
+    m_titleLabel->setObjectName(Theme::PanelTitle);
+    m_titleLabel->setFont(Theme::instance().titleFont());
 
     m_newConversationButton = new QPushButton(headerWidget);
+    m_newConversationButton->setObjectName(Theme::AccentButton);
     m_newConversationButton->setText("+ new");
     m_newConversationButton->setFixedHeight(32);
     m_newConversationButton->setToolTip("New Conversation");
-    m_newConversationButton->setStyleSheet(
-        "QPushButton {"
-        "  background-color: #10B981;"
-        "  border: none;"
-        "  border-radius: 4px;"
-        "  font-size: 12px;"
-        "  font-weight: bold;"
-        "  color: #0A0A0A;"
-        "  padding: 6px 12px;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #34D399;"
-        "}"
-        "QPushButton:pressed {"
-        "  background-color: #059669;"
-        "}"
-    );
 
     m_headerLayout->addWidget(m_titleLabel);
     m_headerLayout->addStretch();
     m_headerLayout->addWidget(m_newConversationButton);
 
-    // Conversation list
-    m_conversationList = new QListWidget(this);
-    m_conversationList->setStyleSheet(
-        "QListWidget {"
-        "  border: none;"
-        "  background-color: #0A0A0A;"
-        "}"
-        "QListWidget::item {"
-        "  padding: 12px 15px;"
-        "  border-bottom: 1px solid #2a2a2a;"
-        "}"
-        "QListWidget::item:selected {"
-        "  background-color: #1F1F1F;"
-        "}"
-        "QListWidget::item:hover {"
-        "  background-color: #1F1F1F;"
-        "}"
-        "QListWidget::item:selected QWidget {"
-        "  background-color: #1F1F1F;"
-        "}"
-        "QListWidget::item:hover QWidget {"
-        "  background-color: #1F1F1F;"
-        "}"
-    );
+    // Conversation list - rows are painted by the delegate
+    m_conversationModel = new ConversationListModel(m_registry, this);
+    m_conversationDelegate = new ConversationItemDelegate(this);
+
+    m_conversationList = new QListView(this);
+    m_conversationList->setObjectName(Theme::ConversationList);
+    m_conversationList->setModel(m_conversationModel);
+    m_conversationList->setItemDelegate(m_conversationDelegate);
+    m_conversationList->setUniformItemSizes(true);
+    m_conversationList->setMouseTracking(true);
+    m_conversationList->viewport()->setAttribute(Qt::WA_Hover, true);
+    m_conversationList->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_conversationList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_conversationList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_conversationList->setContextMenuPolicy(Qt::CustomContextMenu);
 
     // My Bundle button at bottom
     m_myBundleButton = new QPushButton("Generate Intro Bundle", this);
+    m_myBundleButton->setObjectName(Theme::FooterButton);
     m_myBundleButton->setFixedHeight(68);
-    m_myBundleButton->setStyleSheet(
-        "QPushButton {"
-        "  background-color: transparent;"
-        "  border: none;"
-        "  border-top: 1px solid #2a2a2a;"
-        "  border-radius: 0px;"
-        "  padding: 15px;"
-        "  font-size: 13px;"
-        "  font-weight: bold;"
-        "  color: #FAFAFA;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #1F1F1F;"
-        "}"
-        "QPushButton:pressed {"
-        "  background-color: #1F1F1F;"
-        "}"
-    );
 
     m_mainLayout->addWidget(headerWidget);
     m_mainLayout->addWidget(m_conversationList, 1);
@@ -112,83 +72,74 @@ void ConversationListPanel::setupUI()
             this, &ConversationListPanel::onNewConversationClicked);
     connect(m_myBundleButton, &QPushButton::clicked, 
             this, &ConversationListPanel::onMyBundleClicked);
-    connect(m_conversationList, &QListWidget::itemClicked, 
+    connect(m_conversationList, &QListView::clicked,
             this, &ConversationListPanel::onItemClicked);
+    connect(m_conversationList, &QListView::entered, this, [this](const QModelIndex& index) {
+        emit conversationHovered(index.data(ConversationListModel::IdRole).toString());
+    });
+    connect(m_conversationList, &QListView::customContextMenuRequested,
+            this, &ConversationListPanel::onContextMenuRequested);
+
+    // Rows move as conversations become active; keep what the user is looking at
+    connect(m_conversationModel, &QAbstractItemModel::rowsAboutToBeMoved,
+            this, &ConversationListPanel::onRowsAboutToBeMoved);
+    connect(m_conversationModel, &QAbstractItemModel::rowsMoved,
+            this, &ConversationListPanel::onRowsMoved);
 }
 
-void ConversationListPanel::addConversation(const QString& id, const QString& name, 
-                                             const QDateTime& lastActivity)
+void ConversationListPanel::addConversation(Handle handle)
 {
-    if (m_conversationItems.contains(id)) {
-        updateConversation(id, lastActivity);
-        return;
-    }
-
-    QListWidgetItem* item = new QListWidgetItem(m_conversationList);
-    item->setData(Qt::UserRole, id);
-    updateConversationDisplay(item, name, lastActivity, 0);
-
-    m_conversationItems[id] = item;
-    m_conversationData[id] = {name, lastActivity, 0};
+    m_conversationModel->addConversation(handle);
 }
 
-void ConversationListPanel::updateConversation(const QString& id, const QDateTime& lastActivity)
+void ConversationListPanel::updateConversation(Handle handle, const QDateTime& lastActivity)
 {
-    if (!m_conversationItems.contains(id)) return;
-
-    QListWidgetItem* item = m_conversationItems[id];
-    m_conversationData[id].lastActivity = lastActivity;
-    updateConversationDisplay(item, m_conversationData[id].name, lastActivity,
-                              m_conversationData[id].unreadCount);
+    m_conversationModel->setLastActivity(handle, lastActivity);
 }
 
-void ConversationListPanel::removeConversation(const QString& id)
+void ConversationListPanel::removeConversation(Handle handle)
 {
-    if (!m_conversationItems.contains(id)) return;
+    m_conversationModel->removeConversation(handle);
+}
 
-    QListWidgetItem* item = m_conversationItems[id];
-    delete item;
-    m_conversationItems.remove(id);
-    m_conversationData.remove(id);
+void ConversationListPanel::setPinned(Handle handle, bool pinned)
+{
+    m_conversationModel->setPinned(handle, pinned);
 }
 
 void ConversationListPanel::clearConversations()
 {
-    m_conversationList->clear();
-    m_conversationItems.clear();
-    m_conversationData.clear();
+    m_conversationModel->clear();
+}
+
+void ConversationListPanel::selectConversation(Handle handle)
+{
+    QModelIndex index = m_conversationModel->indexOf(handle);
+    if (!index.isValid()) return;
+    m_conversationList->setCurrentIndex(index);
 }
 
-void ConversationListPanel::selectConversation(const QString& id)
+void ConversationListPanel::incrementUnread(Handle handle)
 {
-    if (!m_conversationItems.contains(id)) return;
-    m_conversationList->setCurrentItem(m_conversationItems[id]);
+    m_conversationModel->incrementUnread(handle);
 }
 
-void ConversationListPanel::incrementUnread(const QString& id)
+void ConversationListPanel::clearUnread(Handle handle)
 {
-    if (!m_conversationItems.contains(id)) return;
-    m_conversationData[id].unreadCount++;
-    QListWidgetItem* item = m_conversationItems[id];
-    updateConversationDisplay(item, m_conversationData[id].name,
-                              m_conversationData[id].lastActivity,
-                              m_conversationData[id].unreadCount);
+    m_conversationModel->clearUnread(handle);
 }
 
-void ConversationListPanel::clearUnread(const QString& id)
+void ConversationListPanel::applyActivity(
+    const QHash<Handle, ConversationListModel::ActivityUpdate>& updates)
 {
-    if (!m_conversationItems.contains(id)) return;
-    if (m_conversationData[id].unreadCount == 0) return;
-    m_conversationData[id].unreadCount = 0;
-    QListWidgetItem* item = m_conversationItems[id];
-    updateConversationDisplay(item, m_conversationData[id].name,
-                              m_conversationData[id].lastActivity,
-                              m_conversationData[id].unreadCount);
+    StallWatchdog::Scope stallScope("ConversationListPanel::applyActivity", updates.size(),
+                                    "conversations");
+    m_conversationModel->applyActivity(updates);
 }
 
-void ConversationListPanel::onItemClicked(QListWidgetItem* item)
+void ConversationListPanel::onItemClicked(const QModelIndex& index)
 {
-    QString id = item->data(Qt::UserRole).toString();
+    QString id = index.data(ConversationListModel::IdRole).toString();
     emit conversationSelected(id);
 }
 
@@ -202,68 +153,36 @@ void ConversationListPanel::onMyBundleClicked()
     emit myBundleRequested();
 }
 
-QString ConversationListPanel::formatRelativeTime(const QDateTime& dateTime)
+void ConversationListPanel::onContextMenuRequested(const QPoint& pos)
 {
-    QDateTime now = QDateTime::currentDateTime();
-    qint64 secs = dateTime.secsTo(now);
+    const QModelIndex index = m_conversationList->indexAt(pos);
+    if (!index.isValid()) return;
+
+    const QString id = index.data(ConversationListModel::IdRole).toString();
+    const bool pinned = index.data(ConversationListModel::PinnedRole).toBool();
 
-    if (secs < 60) {
-        return "Just now";
-    } else if (secs < 3600) {
-        int mins = secs / 60;
-        return QString("%1 min ago").arg(mins);
-    } else if (secs < 86400) {
-        int hours = secs / 3600;
-        return QString("%1 hour%2 ago").arg(hours).arg(hours > 1 ? "s" : "");
-    } else if (secs < 172800) {
-        return "Yesterday";
-    } else {
-        return dateTime.toString("MMM d");
+    QMenu menu(this);
+    QAction* pinAction = menu.addAction(pinned ? "Unpin" : "Pin to Top");
+    if (menu.exec(m_conversationList->viewport()->mapToGlobal(pos)) == pinAction) {
+        m_conversationModel->setPinned(m_registry->find(id), !pinned);
+        emit conversationPinned(id, !pinned);
     }
 }
 
-void ConversationListPanel::updateConversationDisplay(QListWidgetItem* item, 
-                                                       const QString& name, 
-                                                       const QDateTime& lastActivity,
-                                                       int unreadCount)
+void ConversationListPanel::onRowsAboutToBeMoved()
 {
-    QWidget* container = new QWidget(m_conversationList);
-    QHBoxLayout* layout = new QHBoxLayout(container);
-    layout->setContentsMargins(0, 0, 0, 0);
-    layout->setSpacing(8);
-    container->setAttribute(Qt::WA_StyledBackground, true);
-    container->setStyleSheet("background: transparent;");
-
-    QString displayText = QString("<b style='color: #FAFAFA; font-family: JetBrains Mono, monospace;'>%1</b><br><span style='color: #4B5563; font-size: 10pt; font-family: IBM Plex Mono, monospace;'>%2</span>")
-                          .arg(name)
-                          .arg(formatRelativeTime(lastActivity));
-
-    QLabel* label = new QLabel(displayText, container);
-    label->setTextFormat(Qt::RichText);
-    label->setContentsMargins(0, 0, 0, 0);
-    label->setStyleSheet("background: transparent;");
-    label->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-    layout->addWidget(label);
-
-    if (unreadCount > 0) {
-        QString unreadText = unreadCount > 99 ? "99+" : QString::number(unreadCount);
-        QLabel* badge = new QLabel(unreadText, container);
-        badge->setAlignment(Qt::AlignCenter);
-        badge->setMinimumSize(QSize(20, 20));
-        badge->setMaximumSize(QSize(20, 20));
-        badge->setStyleSheet(
-            "QLabel {"
-            "  background-color: #EF4444;"
-            "  color: #FFFFFF;"
-            "  border-radius: 10px;"
-            "  font-size: 10px;"
-            "  font-weight: bold;"
-            "  padding: 0;"
-            "}"
-        );
-        layout->addWidget(badge);
+    // At the top, newly active conversations should come into view
+    if (m_conversationList->verticalScrollBar()->value() == 0) {
+        m_scrollAnchor = QPersistentModelIndex();
+        return;
     }
+    m_scrollAnchor = m_conversationList->indexAt(QPoint(0, 0));
+}
 
-    item->setSizeHint(QSize(0, 50));
-    m_conversationList->setItemWidget(item, container);
+void ConversationListPanel::onRowsMoved()
+{
+    if (m_scrollAnchor.isValid()) {
+        m_conversationList->scrollTo(m_scrollAnchor, QAbstractItemView::PositionAtTop);
+        m_scrollAnchor = QPersistentModelIndex();
+    }
 }
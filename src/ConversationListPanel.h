@@ -5,55 +5,67 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QListWidget>
+#include <QListView>
 #include <QDateTime>
-#include <QMap>
+#include <QPersistentModelIndex>
+#include "ConversationListModel.h"
+
+class ConversationItemDelegate;
 
 class ConversationListPanel : public QWidget {
     Q_OBJECT
 
 public:
-    explicit ConversationListPanel(QWidget* parent = nullptr);
+    using Handle = ConversationRegistry::Handle;
+
+    // Rows show the records of registry, which must outlive the panel
+    explicit ConversationListPanel(ConversationRegistry* registry, QWidget* parent = nullptr);
     ~ConversationListPanel() = default;
 
 signals:
     void conversationSelected(const QString& conversationId);
+    // The pointer rests on a row; a likely next selection
+    void conversationHovered(const QString& conversationId);
     void newConversationRequested();
     void myBundleRequested();
+    // Pin or Unpin was picked from the row's context menu
+    void conversationPinned(const QString& conversationId, bool pinned);
 
 public slots:
-    void addConversation(const QString& id, const QString& name, const QDateTime& lastActivity);
-    void updateConversation(const QString& id, const QDateTime& lastActivity);
-    void removeConversation(const QString& id);
+    // The conversation's registry record must be filled in first
+    void addConversation(Handle handle);
+    void updateConversation(Handle handle, const QDateTime& lastActivity);
+    void removeConversation(Handle handle);
+    void setPinned(Handle handle, bool pinned);
     void clearConversations();
-    void selectConversation(const QString& id);
-    void incrementUnread(const QString& id);
-    void clearUnread(const QString& id);
+    void selectConversation(Handle handle);
+    void incrementUnread(Handle handle);
+    void clearUnread(Handle handle);
+    void applyActivity(const QHash<Handle, ConversationListModel::ActivityUpdate>& updates);
 
 private slots:
-    void onItemClicked(QListWidgetItem* item);
+    void onItemClicked(const QModelIndex& index);
     void onNewConversationClicked();
     void onMyBundleClicked();
+    void onContextMenuRequested(const QPoint& pos);
+    void onRowsAboutToBeMoved();
+    void onRowsMoved();
 
 private:
     void setupUI();
-    QString formatRelativeTime(const QDateTime& dateTime);
-    void updateConversationDisplay(QListWidgetItem* item, const QString& name, const QDateTime& lastActivity, int unreadCount);
+
+    ConversationRegistry* m_registry;
 
     QVBoxLayout* m_mainLayout;
     QHBoxLayout* m_headerLayout;
     QLabel* m_titleLabel;
     QPushButton* m_newConversationButton;
-    QListWidget* m_conversationList;
+    QListView* m_conversationList;
     QPushButton* m_myBundleButton;
 
-    // Map conversation ID to list item
-    QMap<QString, QListWidgetItem*> m_conversationItems;
-    // Store conversation data
-    struct ConversationData {
-        QString name;
-        QDateTime lastActivity;
-        int unreadCount = 0;
-    };
-    QMap<QString, ConversationData> m_conversationData;
+    // Conversation rows live in the model; updates are per-row dataChanged
+    ConversationListModel* m_conversationModel;
+    ConversationItemDelegate* m_conversationDelegate;
+    // Top visible row while rows are reordered below a scrolled list
+    QPersistentModelIndex m_scrollAnchor;
 };
@@ -0,0 +1,18 @@
+#include "ConversationRegistry.h"
+
+ConversationRegistry::Handle ConversationRegistry::intern(const QString& id, bool* added)
+{
+    // One lookup whether or not the id is new: operator[] inserts a missing
+    // id, which the size change gives away
+    const auto size = m_handles.size();
+    Handle& handle = m_handles[id];
+    const bool isNew = m_handles.size() != size;
+    if (isNew) {
+        handle = Handle(m_records.size());
+        Conversation conversation;
+        conversation.id = id;
+        m_records.append(conversation);
+    }
+    if (added) *added = isNew;
+    return handle;
+}
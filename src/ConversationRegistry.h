@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * Every conversation the window knows about, with its state in one place.
+ *
+ * Conversation ids are long hex strings, and hashing and comparing them
+ * once per message per map adds up. intern() maps each id to a small
+ * integer Handle the first time it is seen; the conversation's state is a
+ * single Conversation record stored by handle in a contiguous vector. Code
+ * that holds a handle reaches the record by index, so only find() and
+ * intern() ever hash the id.
+ *
+ * The window owns the registry and the conversation list shares it: the
+ * list model reads names, activity, unread counts and pins straight from the
+ * records and writes the changes it makes back to them.
+ *
+ * Handles are never reused, so they stay valid for the registry's lifetime
+ * and can key other containers (list rows, caches, ingest batches).
+ */
+class ConversationRegistry {
+public:
+    using Handle = int;
+    static constexpr Handle kInvalid = -1;
+
+    struct Conversation {
+        QString id;
+        QString name;
+        QString peerId;  // Empty when the module did not report one
+        QDateTime lastActivity;
+        int unreadCount = 0;
+        bool pinned = false;
+    };
+
+    ConversationRegistry() = default;
+
+    // kInvalid when the id was never interned
+    Handle find(const QString& id) const { return m_handles.value(id, kInvalid); }
+    // The handle of id, adding an empty record for it the first time
+    Handle intern(const QString& id, bool* added = nullptr);
+
+    bool isValid(Handle handle) const { return handle >= 0 && handle < m_records.size(); }
+    Conversation& operator[](Handle handle) { return m_records[handle]; }
+    const Conversation& at(Handle handle) const { return m_records.at(handle); }
+    const QString& idOf(Handle handle) const { return m_records.at(handle).id; }
+
+    int size() const { return m_records.size(); }
+
+private:
+    QVector<Conversation> m_records;  // Indexed by handle
+    QHash<QString, Handle> m_handles;
+};
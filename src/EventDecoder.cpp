@@ -0,0 +1,154 @@
+#include "EventDecoder.h"
+#include "ChatLogging.h"
+#include "HexCodec.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+EventDecoder::EventDecoder(InboundEventQueue* output, QObject* parent)
+    : QObject(parent)
+    , m_output(output)
+    , m_processScheduled(false)
+{
+}
+
+void EventDecoder::submit(const QString& name, const QVariantList& data, qint64 receivedNs)
+{
+    InboundEventQueue::Event event{name, data, {}, {}, {}};
+    event.message.receivedNs = receivedNs;
+
+    bool scheduleProcess = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.append(std::move(event));
+        if (!m_processScheduled) {
+            m_processScheduled = true;
+            scheduleProcess = true;
+        }
+    }
+
+    // Runs on the decoder's thread; one wake-up per burst
+    if (scheduleProcess) {
+        QMetaObject::invokeMethod(
+            this, [this]() { processPending(); }, Qt::QueuedConnection);
+    }
+}
+
+void EventDecoder::processPending()
+{
+    QVector<InboundEventQueue::Event> events;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_pending);
+        m_processScheduled = false;
+    }
+
+    QVector<InboundEventQueue::Event> decoded;
+    decoded.reserve(events.size());
+    for (auto& event : events) {
+        if (event.name == "chatsdkNewMessage") {
+            qCDebug(lcEvents) << "EventDecoder: New message received:"
+                              << ChatLogging::truncated(event.data);
+            if (!decodeMessage(event.data, &event.message)) continue;
+            event.data.clear();
+        } else if (event.name == "chatsdkNewConversation") {
+            qCDebug(lcEvents) << "EventDecoder: New conversation received:"
+                              << ChatLogging::truncated(event.data);
+            if (!decodeConversation(event.data, &event.conversation)) continue;
+            event.data.clear();
+        } else if (event.name == "chatsdkSendMessageResult") {
+            qCDebug(lcEvents) << "EventDecoder: Send message result:"
+                              << ChatLogging::truncated(event.data);
+            if (!decodeSendResult(event.data, &event.sendResult)) continue;
+            event.data.clear();
+        }
+        decoded.append(std::move(event));
+    }
+
+    m_output->postAll(decoded);
+}
+
+bool EventDecoder::decodeMessage(const QVariantList& data, InboundMessage* message)
+{
+    if (data.isEmpty())
+        return false;
+
+    // Parse the JSON message
+    QByteArray json = data[0].toString().toUtf8();
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject())
+        return false;
+
+    QJsonObject obj = doc.object();
+    QString conversationId = obj["conversationId"].toString();
+    if (conversationId.isEmpty()) {
+        conversationId = obj["conversation_id"].toString();
+    }
+
+    // If content looks like hex, decode it (validation and decoding are one pass)
+    QString content = HexCodec::decodeContent(obj["content"].toString());
+
+    QString sender = obj["sender"].toString();
+    if (sender.isEmpty()) {
+        sender = obj["from"].toString();
+    }
+    if (sender.isEmpty()) {
+        sender = "Peer";
+    }
+
+    message->conversationId = conversationId;
+    message->sender = sender;
+    message->content = content;
+    message->receivedAt = QDateTime::currentDateTime();
+    message->payloadBytes = json.size();
+    return true;
+}
+
+bool EventDecoder::decodeConversation(const QVariantList& data,
+                                      InboundConversation* conversation)
+{
+    if (data.isEmpty())
+        return false;
+
+    // Parse the JSON
+    QJsonDocument doc = QJsonDocument::fromJson(data[0].toString().toUtf8());
+    if (!doc.isObject())
+        return false;
+
+    QJsonObject obj = doc.object();
+    conversation->conversationId = obj["conversationId"].toString();
+    conversation->conversationType = obj["conversationType"].toString();
+
+    // Try to extract peer identity
+    if (obj.contains("peerId")) {
+        conversation->peerId = obj["peerId"].toString();
+    } else if (obj.contains("peerIdentity")) {
+        conversation->peerId = obj["peerIdentity"].toString();
+    }
+
+    return !conversation->conversationId.isEmpty();
+}
+
+bool EventDecoder::decodeSendResult(const QVariantList& data, InboundSendResult* result)
+{
+    if (data.isEmpty())
+        return false;
+
+    // data format: [success (bool), returnCode (int), resultJson (QString),
+    // timestamp (QString)]
+    result->success = data[0].toBool();
+    result->returnCode = data.size() > 1 ? data[1].toInt() : -1;
+
+    // The result JSON may name the conversation and the client id (as a
+    // string, beyond double precision); anything else is not JSON
+    if (data.size() > 2) {
+        QJsonDocument doc = QJsonDocument::fromJson(data[2].toString().toUtf8());
+        if (doc.isObject()) {
+            QJsonObject obj = doc.object();
+            result->conversationId = obj["conversationId"].toString();
+            result->clientId = obj["clientId"].toString().toULongLong();
+        }
+    }
+    return true;
+}
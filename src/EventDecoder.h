@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+#include "InboundEventQueue.h"
+
+/**
+ * Parses chatsdk module events on a worker thread.
+ *
+ * submit() may be called from any thread. Events are decoded in submission
+ * order on the decoder's thread (JSON parsing, hex content decoding) and
+ * handed to the InboundEventQueue as plain structs, so the GUI thread only
+ * applies model updates. A single worker keeps the global order, and with
+ * it the order within each conversation.
+ */
+class EventDecoder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit EventDecoder(InboundEventQueue* output, QObject* parent = nullptr);
+    ~EventDecoder() = default;
+
+    // receivedNs is the callback's LatencyMonitor::now() stamp, carried on
+    // decoded messages
+    void submit(const QString& name, const QVariantList& data, qint64 receivedNs = 0);
+
+    // Thread-safe decoding helpers, also used for direct (synchronous) calls
+    static bool decodeMessage(const QVariantList& data, InboundMessage* message);
+    static bool decodeConversation(const QVariantList& data, InboundConversation* conversation);
+    static bool decodeSendResult(const QVariantList& data, InboundSendResult* result);
+
+private:
+    void processPending();
+
+    InboundEventQueue* m_output;
+    QMutex m_mutex;
+    QVector<InboundEventQueue::Event> m_pending;
+    bool m_processScheduled;
+};
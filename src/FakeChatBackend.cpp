@@ -0,0 +1,250 @@
+#include "FakeChatBackend.h"
+#include "ChatLogging.h"
+#include "ChatConfig.h"
+#include "HexCodec.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+constexpr int kTickMs = 5;
+
+QString timestamp()
+{
+    return QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+}
+
+QString toJson(const QJsonObject& obj)
+{
+    return QString::fromUtf8(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+} // namespace
+
+FakeChatBackend::Config FakeChatBackend::Config::fromEnvironment()
+{
+    Config config;
+    config.conversations = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_CONVERSATIONS", config.conversations);
+    config.messagesPerSecond = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_RATE", config.messagesPerSecond);
+    config.payloadMinBytes = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_PAYLOAD_MIN", config.payloadMinBytes);
+    config.payloadMaxBytes = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_PAYLOAD_MAX", config.payloadMaxBytes);
+    config.burstSize = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_BURST", config.burstSize);
+    config.burstIntervalMs = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_BURST_INTERVAL_MS", config.burstIntervalMs);
+    config.sendFailurePercent = ChatConfig::getEnvOrDefault("CHATSDK_FAKE_SEND_FAILURE_PERCENT",
+                                                            config.sendFailurePercent);
+
+    config.conversations = qMax(1, config.conversations);
+    config.messagesPerSecond = qMax(0, config.messagesPerSecond);
+    config.payloadMinBytes = qMax(1, config.payloadMinBytes);
+    config.payloadMaxBytes = qMax(config.payloadMinBytes, config.payloadMaxBytes);
+    config.burstIntervalMs = qMax(kTickMs, config.burstIntervalMs);
+    return config;
+}
+
+bool FakeChatBackend::enabledInEnvironment()
+{
+    return ChatConfig::getEnvOrDefault("CHATSDK_FAKE_BACKEND", 0) != 0;
+}
+
+FakeChatBackend::FakeChatBackend(const Config& config, QObject* parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_thread(nullptr)
+    , m_timer(nullptr)
+    , m_rng(QRandomGenerator::securelySeeded())
+    , m_lastTickMs(0)
+    , m_lastBurstMs(0)
+    , m_owed(0.0)
+    , m_generated(0)
+    , m_createdConversations(0)
+{
+    m_thread = new QThread(this);
+    m_thread->setObjectName("FakeChatBackend");
+
+    m_timer = new QTimer();
+    m_timer->setInterval(kTickMs);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->moveToThread(m_thread);
+    connect(m_timer, &QTimer::timeout, m_timer, [this]() { generate(); });
+    connect(m_thread, &QThread::finished, m_timer, &QObject::deleteLater);
+    m_thread->start();
+
+    qCInfo(lcBackend) << "FakeChatBackend:" << m_config.conversations << "conversations,"
+                      << m_config.messagesPerSecond << "msg/s, payload" << m_config.payloadMinBytes
+                      << "-" << m_config.payloadMaxBytes << "bytes, burst" << m_config.burstSize
+                      << "every" << m_config.burstIntervalMs << "ms";
+}
+
+FakeChatBackend::~FakeChatBackend()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void FakeChatBackend::on(const QString& eventName, EventHandler handler)
+{
+    QMutexLocker locker(&m_handlersMutex);
+    m_handlers[eventName].append(std::move(handler));
+}
+
+void FakeChatBackend::post(std::function<void()> fn)
+{
+    QMetaObject::invokeMethod(m_timer, std::move(fn), Qt::QueuedConnection);
+}
+
+void FakeChatBackend::emitEvent(const QString& eventName, const QVariantList& data)
+{
+    QList<EventHandler> handlers;
+    {
+        QMutexLocker locker(&m_handlersMutex);
+        handlers = m_handlers.value(eventName);
+    }
+    for (const EventHandler& handler : handlers) {
+        handler(data);
+    }
+}
+
+void FakeChatBackend::emitResult(const QString& eventName, bool success, const QString& payload)
+{
+    // [success, returnCode, payload, timestamp], as the module reports results
+    emitEvent(eventName, {success, success ? 0 : -1, payload, timestamp()});
+}
+
+bool FakeChatBackend::initChat(const QString& configJson)
+{
+    Q_UNUSED(configJson);
+    post([this]() { emitResult("chatsdkInitResult", true, "fake backend initialized"); });
+    return true;
+}
+
+bool FakeChatBackend::startChat()
+{
+    post([this]() {
+        emitResult("chatsdkStartResult", true, "fake backend started");
+        while (m_conversationIds.size() < m_config.conversations) {
+            announceConversation(QString("fake-%1").arg(m_createdConversations++));
+        }
+        m_clock.start();
+        m_lastTickMs = 0;
+        m_lastBurstMs = 0;
+        m_owed = 0.0;
+        m_timer->start();
+    });
+    return true;
+}
+
+bool FakeChatBackend::stopChat()
+{
+    post([this]() {
+        m_timer->stop();
+        qCInfo(lcBackend) << "FakeChatBackend: stopped after" << m_generated << "messages";
+        emitResult("chatsdkStopResult", true, "fake backend stopped");
+    });
+    return true;
+}
+
+void FakeChatBackend::getId()
+{
+    post([this]() {
+        emitEvent("chatsdkGetIdResult",
+                  {QString("fake-identity-%1").arg(quintptr(this), 0, 16), timestamp()});
+    });
+}
+
+bool FakeChatBackend::createIntroBundle()
+{
+    post([this]() {
+        emitResult("chatsdkCreateIntroBundleResult", true,
+                   QString("logos_chatintro_fake_%1").arg(m_rng.generate64(), 0, 16));
+    });
+    return true;
+}
+
+bool FakeChatBackend::newPrivateConversation(const QString& introBundle,
+                                             const QString& contentHex)
+{
+    Q_UNUSED(introBundle);
+    Q_UNUSED(contentHex);
+    post([this]() {
+        const QString conversationId = QString("fake-%1").arg(m_createdConversations++);
+        emitResult("chatsdkNewPrivateConversationResult", true,
+                   toJson({{"conversationId", conversationId}}));
+        announceConversation(conversationId);
+    });
+    return true;
+}
+
+bool FakeChatBackend::sendMessage(const QString& conversationId, const QString& contentHex,
+                                  quint64 clientId)
+{
+    Q_UNUSED(contentHex);
+    post([this, conversationId, clientId]() {
+        const bool success = int(m_rng.bounded(100)) >= m_config.sendFailurePercent;
+        emitResult("chatsdkSendMessageResult", success,
+                   toJson({{"conversationId", conversationId},
+                           {"clientId", QString::number(clientId)}}));
+    });
+    return true;
+}
+
+void FakeChatBackend::announceConversation(const QString& conversationId)
+{
+    m_conversationIds.append(conversationId);
+    emitEvent("chatsdkNewConversation",
+              {toJson({{"conversationId", conversationId},
+                       {"conversationType", "private"},
+                       {"peerId", QString("peer%1").arg(m_conversationIds.size())}})});
+}
+
+void FakeChatBackend::generate()
+{
+    const qint64 nowMs = m_clock.elapsed();
+    m_owed += m_config.messagesPerSecond * (nowMs - m_lastTickMs) / 1000.0;
+    m_lastTickMs = nowMs;
+
+    int count = static_cast<int>(m_owed);
+    m_owed -= count;
+    if (m_config.burstSize > 0 && nowMs - m_lastBurstMs >= m_config.burstIntervalMs) {
+        m_lastBurstMs = nowMs;
+        count += m_config.burstSize;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        emitMessage();
+    }
+}
+
+void FakeChatBackend::emitMessage()
+{
+    const int index = m_rng.bounded(m_conversationIds.size());
+    emitEvent("chatsdkNewMessage",
+              {toJson({{"conversationId", m_conversationIds.at(index)},
+                       {"sender", QString("peer%1").arg(index + 1)},
+                       {"content", HexCodec::encodeText(makePayload())}})});
+    ++m_generated;
+}
+
+QString FakeChatBackend::makePayload()
+{
+    static const char* const words[] = {
+        "logos", "waku", "relay", "message", "peer", "bundle", "hello", "sync",
+        "node", "store", "filter", "light", "push", "shard", "cluster", "ok",
+    };
+    constexpr int wordCount = int(sizeof(words) / sizeof(words[0]));
+
+    const int length = m_config.payloadMinBytes +
+        m_rng.bounded(m_config.payloadMaxBytes - m_config.payloadMinBytes + 1);
+    QString text = QString("#%1").arg(m_generated);
+    text.reserve(length + 16);
+    while (text.size() < length) {
+        text += ' ';
+        text += QLatin1String(words[m_rng.bounded(wordCount)]);
+    }
+    text.truncate(length);
+    return text;
+}
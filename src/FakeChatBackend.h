@@ -0,0 +1,94 @@
+#pragma once
+
+#include "IChatBackend.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QStringList>
+
+class QThread;
+class QTimer;
+
+/**
+ * Local stand-in for chatsdk_module, for load-testing the UI without
+ * Logos Core.
+ *
+ * Lifecycle calls answer with the same result events as the module. After
+ * startChat() it announces a set of conversations and then generates
+ * incoming messages at a steady rate, with optional periodic bursts on top.
+ * Events are emitted from a generator thread, like module callbacks that
+ * arrive off the GUI thread.
+ *
+ * Enabled with CHATSDK_FAKE_BACKEND=1; see Config::fromEnvironment() for the
+ * knobs.
+ */
+class FakeChatBackend : public QObject, public IChatBackend {
+    Q_OBJECT
+
+public:
+    struct Config {
+        int conversations = 20;         // Announced on start
+        int messagesPerSecond = 50;     // Steady rate across all conversations
+        int payloadMinBytes = 16;       // Message text length range
+        int payloadMaxBytes = 256;
+        int burstSize = 0;              // Extra messages per burst, 0 = no bursts
+        int burstIntervalMs = 5000;
+        int sendFailurePercent = 0;     // Share of sendMessage calls that fail
+
+        static Config fromEnvironment();
+    };
+
+    explicit FakeChatBackend(const Config& config = Config::fromEnvironment(),
+                             QObject* parent = nullptr);
+    ~FakeChatBackend() override;
+
+    static bool enabledInEnvironment();
+
+    void on(const QString& eventName, EventHandler handler) override;
+    void setEventCallback() override {}
+
+    bool initChat(const QString& configJson) override;
+    bool startChat() override;
+    bool stopChat() override;
+
+    void getId() override;
+    bool createIntroBundle() override;
+    bool newPrivateConversation(const QString& introBundle, const QString& contentHex) override;
+    bool sendMessage(const QString& conversationId, const QString& contentHex,
+                     quint64 clientId) override;
+    // Sends only post to the generator thread
+    bool sendsFromAnyThread() const override { return true; }
+
+private:
+    // Runs fn on the generator thread, after anything already queued there
+    void post(std::function<void()> fn);
+    void emitEvent(const QString& eventName, const QVariantList& data);
+    void emitResult(const QString& eventName, bool success, const QString& payload);
+
+    // Generator thread only
+    void announceConversation(const QString& conversationId);
+    void generate();
+    void emitMessage();
+    QString makePayload();
+
+    Config m_config;
+
+    QMutex m_handlersMutex;
+    QHash<QString, QList<EventHandler>> m_handlers;
+
+    QThread* m_thread;
+    QTimer* m_timer;  // Lives on m_thread
+
+    // Generator state (generator thread only)
+    QRandomGenerator m_rng;
+    QStringList m_conversationIds;
+    QElapsedTimer m_clock;
+    qint64 m_lastTickMs;
+    qint64 m_lastBurstMs;
+    double m_owed;
+    quint64 m_generated;
+    int m_createdConversations;
+};
@@ -0,0 +1,424 @@
+#include "HexCodec.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HEXCODEC_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define HEXCODEC_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace HexCodec {
+namespace {
+
+// ============================================================================
+// Scalar kernels
+// ============================================================================
+
+struct DecodeTable {
+    unsigned char values[256];
+
+    constexpr DecodeTable() : values() {
+        for (int i = 0; i < 256; ++i) values[i] = 0xFF;
+        for (int i = 0; i < 10; ++i) values['0' + i] = static_cast<unsigned char>(i);
+        for (int i = 0; i < 6; ++i) {
+            values['a' + i] = static_cast<unsigned char>(10 + i);
+            values['A' + i] = static_cast<unsigned char>(10 + i);
+        }
+    }
+};
+
+constexpr DecodeTable kDecodeTable;
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Characters outside Latin-1 map to 0xFF, which the table rejects
+inline unsigned char nibbleOf(char c) { return kDecodeTable.values[static_cast<unsigned char>(c)]; }
+inline unsigned char nibbleOf(char16_t c) { return kDecodeTable.values[c > 0xFF ? 0xFF : c]; }
+
+template <typename Char>
+void encodeScalar(const unsigned char* in, std::size_t size, Char* out)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        out[2 * i] = static_cast<Char>(kHexDigits[in[i] >> 4]);
+        out[2 * i + 1] = static_cast<Char>(kHexDigits[in[i] & 0x0F]);
+    }
+}
+
+template <typename Char>
+bool decodeScalar(const Char* in, std::size_t outSize, unsigned char* out)
+{
+    // Valid nibbles are <= 0x0F, so any high bit marks an invalid character
+    unsigned char invalid = 0;
+    for (std::size_t i = 0; i < outSize; ++i) {
+        const unsigned char hi = nibbleOf(in[2 * i]);
+        const unsigned char lo = nibbleOf(in[2 * i + 1]);
+        invalid |= hi | lo;
+        out[i] = static_cast<unsigned char>((hi << 4) | (lo & 0x0F));
+    }
+    return (invalid & 0xF0) == 0;
+}
+
+template <typename Char>
+bool isHexScalar(const Char* in, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        if (nibbleOf(in[i]) > 0x0F) return false;
+    }
+    return true;
+}
+
+#ifdef HEXCODEC_SSE2
+// ============================================================================
+// SSE2 kernels (baseline on x86-64)
+// ============================================================================
+
+inline __m128i load16Chars(const char* in)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+}
+
+inline __m128i load16Chars(const char16_t* in)
+{
+    // Saturating pack: anything above 0xFF becomes 0xFF or 0x00, both non-hex
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+    return _mm_packus_epi16(a, b);
+}
+
+// Maps 16 ASCII hex digits to nibble values and ORs a mask of the
+// non-hex lanes into invalid
+inline __m128i nibblesSse2(__m128i v, __m128i& invalid)
+{
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(digit, alpha),
+                                                     _mm_set1_epi8(-1)));
+
+    const __m128i digitValue = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    const __m128i alphaValue = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    return _mm_or_si128(_mm_and_si128(digit, digitValue), _mm_andnot_si128(digit, alphaValue));
+}
+
+// (hi, lo) nibble pairs -> one byte value per 16-bit lane
+inline __m128i combineSse2(__m128i nibbles)
+{
+    const __m128i hi = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+    const __m128i lo = _mm_srli_epi16(nibbles, 8);
+    return _mm_or_si128(hi, lo);
+}
+
+inline __m128i toAsciiSse2(__m128i nibbles)
+{
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                          _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+inline void store32Chars(char* out, __m128i first, __m128i second)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), first);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), second);
+}
+
+inline void store32Chars(char16_t* out, __m128i first, __m128i second)
+{
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(first, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(first, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpacklo_epi8(second, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm_unpackhi_epi8(second, zero));
+}
+
+template <typename Char>
+void encodeSse2(const unsigned char* in, std::size_t size, Char* out)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = toAsciiSse2(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F)));
+        const __m128i lo = toAsciiSse2(_mm_and_si128(bytes, _mm_set1_epi8(0x0F)));
+        store32Chars(out + 2 * i, _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo));
+    }
+    encodeScalar(in + i, size - i, out + 2 * i);
+}
+
+template <typename Char>
+bool decodeSse2(const Char* in, std::size_t outSize, unsigned char* out)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= outSize; i += 16) {
+        __m128i invalid = _mm_setzero_si128();
+        const __m128i n0 = nibblesSse2(load16Chars(in + 2 * i), invalid);
+        const __m128i n1 = nibblesSse2(load16Chars(in + 2 * i + 16), invalid);
+        if (_mm_movemask_epi8(invalid) != 0) return false;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packus_epi16(combineSse2(n0), combineSse2(n1)));
+    }
+    return decodeScalar(in + 2 * i, outSize - i, out + i);
+}
+
+template <typename Char>
+bool isHexSse2(const Char* in, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i invalid = _mm_setzero_si128();
+        nibblesSse2(load16Chars(in + i), invalid);
+        if (_mm_movemask_epi8(invalid) != 0) return false;
+    }
+    return isHexScalar(in + i, size - i);
+}
+#endif // HEXCODEC_SSE2
+
+#ifdef HEXCODEC_AVX2
+// ============================================================================
+// AVX2 kernels (selected at runtime)
+// ============================================================================
+
+#define HEXCODEC_TARGET_AVX2 __attribute__((target("avx2")))
+
+HEXCODEC_TARGET_AVX2 inline __m256i load32Chars(const char* in)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+}
+
+HEXCODEC_TARGET_AVX2 inline __m256i load32Chars(const char16_t* in)
+{
+    // packus works per 128-bit lane; the permute restores character order
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16));
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+
+HEXCODEC_TARGET_AVX2 inline __m256i nibblesAvx2(__m256i v, __m256i& invalid)
+{
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(digit, alpha),
+                                                           _mm256_set1_epi8(-1)));
+
+    const __m256i digitValue = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    const __m256i alphaValue = _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10));
+    return _mm256_or_si256(_mm256_and_si256(digit, digitValue),
+                           _mm256_andnot_si256(digit, alphaValue));
+}
+
+HEXCODEC_TARGET_AVX2 inline __m256i combineAvx2(__m256i nibbles)
+{
+    const __m256i hi = _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00FF)), 4);
+    const __m256i lo = _mm256_srli_epi16(nibbles, 8);
+    return _mm256_or_si256(hi, lo);
+}
+
+HEXCODEC_TARGET_AVX2 inline __m256i toAsciiAvx2(__m256i nibbles)
+{
+    const __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)),
+                                             _mm256_set1_epi8('a' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), letters);
+}
+
+HEXCODEC_TARGET_AVX2 inline void store64Chars(char* out, __m256i first, __m256i second)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), first);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), second);
+}
+
+HEXCODEC_TARGET_AVX2 inline void store64Chars(char16_t* out, __m256i first, __m256i second)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(first)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16),
+                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(first, 1)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32),
+                        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(second)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 48),
+                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(second, 1)));
+}
+
+template <typename Char>
+HEXCODEC_TARGET_AVX2 void encodeAvx2(const unsigned char* in, std::size_t size, Char* out)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i hi = toAsciiAvx2(_mm256_and_si256(_mm256_srli_epi16(bytes, 4),
+                                                        _mm256_set1_epi8(0x0F)));
+        const __m256i lo = toAsciiAvx2(_mm256_and_si256(bytes, _mm256_set1_epi8(0x0F)));
+        // unpack works per 128-bit lane; regroup the halves in input order
+        const __m256i low = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i high = _mm256_unpackhi_epi8(hi, lo);
+        store64Chars(out + 2 * i, _mm256_permute2x128_si256(low, high, 0x20),
+                     _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    encodeSse2(in + i, size - i, out + 2 * i);
+}
+
+template <typename Char>
+HEXCODEC_TARGET_AVX2 bool decodeAvx2(const Char* in, std::size_t outSize, unsigned char* out)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= outSize; i += 32) {
+        __m256i invalid = _mm256_setzero_si256();
+        const __m256i n0 = nibblesAvx2(load32Chars(in + 2 * i), invalid);
+        const __m256i n1 = nibblesAvx2(load32Chars(in + 2 * i + 32), invalid);
+        if (_mm256_movemask_epi8(invalid) != 0) return false;
+        const __m256i packed = _mm256_packus_epi16(combineAvx2(n0), combineAvx2(n1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return decodeSse2(in + 2 * i, outSize - i, out + i);
+}
+
+template <typename Char>
+HEXCODEC_TARGET_AVX2 bool isHexAvx2(const Char* in, std::size_t size)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i invalid = _mm256_setzero_si256();
+        nibblesAvx2(load32Chars(in + i), invalid);
+        if (_mm256_movemask_epi8(invalid) != 0) return false;
+    }
+    return isHexSse2(in + i, size - i);
+}
+#endif // HEXCODEC_AVX2
+
+// ============================================================================
+// Runtime dispatch
+// ============================================================================
+
+struct Kernels {
+    const char* name;
+    void (*encode8)(const unsigned char*, std::size_t, char*);
+    void (*encode16)(const unsigned char*, std::size_t, char16_t*);
+    bool (*decode8)(const char*, std::size_t, unsigned char*);
+    bool (*decode16)(const char16_t*, std::size_t, unsigned char*);
+    bool (*isHex8)(const char*, std::size_t);
+    bool (*isHex16)(const char16_t*, std::size_t);
+};
+
+Kernels selectKernels()
+{
+    // CHATSDK_HEX_KERNEL=scalar|sse2 forces a slower kernel (benchmarks)
+    const char* forced = std::getenv("CHATSDK_HEX_KERNEL");
+    const bool forceScalar = forced && std::strcmp(forced, "scalar") == 0;
+    const bool forceSse2 = forced && std::strcmp(forced, "sse2") == 0;
+    (void)forceSse2;
+
+#ifdef HEXCODEC_AVX2
+    if (!forceScalar && !forceSse2 && __builtin_cpu_supports("avx2")) {
+        return {"avx2", encodeAvx2<char>, encodeAvx2<char16_t>, decodeAvx2<char>,
+                decodeAvx2<char16_t>, isHexAvx2<char>, isHexAvx2<char16_t>};
+    }
+#endif
+#ifdef HEXCODEC_SSE2
+    if (!forceScalar) {
+        return {"sse2", encodeSse2<char>, encodeSse2<char16_t>, decodeSse2<char>,
+                decodeSse2<char16_t>, isHexSse2<char>, isHexSse2<char16_t>};
+    }
+#endif
+    return {"scalar", encodeScalar<char>, encodeScalar<char16_t>, decodeScalar<char>,
+            decodeScalar<char16_t>, isHexScalar<char>, isHexScalar<char16_t>};
+}
+
+const Kernels& kernels()
+{
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+void encode(const unsigned char* in, std::size_t size, char* out)
+{
+    kernels().encode8(in, size, out);
+}
+
+void encode(const unsigned char* in, std::size_t size, char16_t* out)
+{
+    kernels().encode16(in, size, out);
+}
+
+bool decode(const char* in, std::size_t outSize, unsigned char* out)
+{
+    return kernels().decode8(in, outSize, out);
+}
+
+bool decode(const char16_t* in, std::size_t outSize, unsigned char* out)
+{
+    return kernels().decode16(in, outSize, out);
+}
+
+bool isHex(const char* in, std::size_t size)
+{
+    return kernels().isHex8(in, size);
+}
+
+bool isHex(const char16_t* in, std::size_t size)
+{
+    return kernels().isHex16(in, size);
+}
+
+const char* activeKernel()
+{
+    return kernels().name;
+}
+
+// ============================================================================
+// Qt convenience wrappers
+// ============================================================================
+
+QString encodeText(const QString& text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    QString hex(utf8.size() * 2, Qt::Uninitialized);
+    encode(reinterpret_cast<const unsigned char*>(utf8.constData()), utf8.size(),
+           reinterpret_cast<char16_t*>(hex.data()));
+    return hex;
+}
+
+QByteArray toHex(const QByteArray& bytes)
+{
+    QByteArray hex(bytes.size() * 2, Qt::Uninitialized);
+    encode(reinterpret_cast<const unsigned char*>(bytes.constData()), bytes.size(), hex.data());
+    return hex;
+}
+
+ContentEncoding detectEncoding(QStringView content)
+{
+    if (content.isEmpty()) return ContentEncoding::Empty;
+    if (content.size() % 2 != 0) return ContentEncoding::Text;
+    return isHex(content.utf16(), content.size()) ? ContentEncoding::Hex : ContentEncoding::Text;
+}
+
+bool fromHex(QStringView hex, QByteArray* out)
+{
+    if (hex.size() % 2 != 0) return false;
+
+    QByteArray bytes(hex.size() / 2, Qt::Uninitialized);
+    if (!decode(hex.utf16(), bytes.size(), reinterpret_cast<unsigned char*>(bytes.data()))) {
+        return false;
+    }
+    *out = bytes;
+    return true;
+}
+
+QString decodeContent(const QString& content)
+{
+    // Detection and decoding are the same pass: a non-hex character aborts it
+    QByteArray bytes;
+    if (content.isEmpty() || !fromHex(content, &bytes)) {
+        return content;
+    }
+    return QString::fromUtf8(bytes);
+}
+
+} // namespace HexCodec
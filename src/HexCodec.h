@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <cstddef>
+
+/**
+ * Hex codec for chatsdk message content.
+ *
+ * The libchat API carries message content as hex. Encoding and decoding use
+ * SSE2 (and AVX2 when the CPU has it) on x86-64, with a table-driven scalar
+ * fallback elsewhere. Decoding validates while it decodes, so detecting hex
+ * content and decoding it is a single pass with one allocation.
+ */
+namespace HexCodec {
+
+enum class ContentEncoding {
+    Empty,
+    Hex,
+    Text
+};
+
+// Raw kernels. encode() writes 2 * size lowercase hex characters;
+// decode() reads 2 * outSize characters and returns false on any non-hex
+// character (out is then unspecified).
+void encode(const unsigned char* in, std::size_t size, char* out);
+void encode(const unsigned char* in, std::size_t size, char16_t* out);
+bool decode(const char* in, std::size_t outSize, unsigned char* out);
+bool decode(const char16_t* in, std::size_t outSize, unsigned char* out);
+bool isHex(const char* in, std::size_t size);
+bool isHex(const char16_t* in, std::size_t size);
+
+// Name of the kernel selected for this CPU ("avx2", "sse2" or "scalar")
+const char* activeKernel();
+
+// Hex of the UTF-8 bytes of text (what the libchat API expects)
+QString encodeText(const QString& text);
+QByteArray toHex(const QByteArray& bytes);
+
+// Even-length, non-empty, all hex digits
+ContentEncoding detectEncoding(QStringView content);
+
+// Decodes hex into bytes; returns false (and leaves out untouched) if
+// hex has odd length or contains a non-hex character
+bool fromHex(QStringView hex, QByteArray* out);
+
+// Received content: decoded UTF-8 if it is hex, otherwise returned as is
+QString decodeContent(const QString& content);
+
+} // namespace HexCodec
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+#include <QVariantList>
+#include <functional>
+
+/**
+ * The chat operations the window needs, as offered by chatsdk_module.
+ *
+ * Calls are asynchronous: results and incoming traffic arrive as named
+ * events (chatsdkInitResult, chatsdkNewMessage, ...) through the handlers
+ * registered with on(), with the same payload layout as the module's events.
+ * Handlers may be called from any thread.
+ *
+ * Calls are made from the thread that created the backend. The exception is
+ * sendMessage() on a backend whose sendsFromAnyThread() is true: the window's
+ * outbox then calls it from a sender thread of its own, one call at a time.
+ * Its clientId comes back as "clientId" in the chatsdkSendMessageResult JSON
+ * when the backend can carry it; chatsdk_module's sendMessage takes none.
+ *
+ * LogosChatBackend forwards to the real module through LogosAPI;
+ * FakeChatBackend generates traffic locally for load testing.
+ */
+class IChatBackend {
+public:
+    using EventHandler = std::function<void(const QVariantList& data)>;
+
+    virtual ~IChatBackend() = default;
+
+    virtual void on(const QString& eventName, EventHandler handler) = 0;
+    virtual void setEventCallback() = 0;
+
+    virtual bool initChat(const QString& configJson) = 0;
+    virtual bool startChat() = 0;
+    virtual bool stopChat() = 0;
+
+    virtual void getId() = 0;
+    virtual bool createIntroBundle() = 0;
+    virtual bool newPrivateConversation(const QString& introBundle,
+                                        const QString& contentHex) = 0;
+    virtual bool sendMessage(const QString& conversationId, const QString& contentHex,
+                             quint64 clientId) = 0;
+    virtual bool sendsFromAnyThread() const { return false; }
+};
@@ -0,0 +1,61 @@
+#include "InboundEventQueue.h"
+#include <QMutexLocker>
+
+InboundEventQueue::InboundEventQueue(QObject* parent)
+    : QObject(parent)
+    , m_drainScheduled(false)
+{
+}
+
+void InboundEventQueue::post(const Event& event)
+{
+    postAll({event});
+}
+
+void InboundEventQueue::postAll(const QVector<Event>& events)
+{
+    if (events.isEmpty()) return;
+
+    bool scheduleDrain = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.append(events);
+        if (!m_drainScheduled) {
+            m_drainScheduled = true;
+            scheduleDrain = true;
+        }
+    }
+
+    // One queued drain per batch, no matter how many events arrive before it runs
+    if (scheduleDrain) {
+        QMetaObject::invokeMethod(
+            this, [this]() { emit drainRequested(); }, Qt::QueuedConnection);
+    }
+}
+
+QVector<InboundEventQueue::Event> InboundEventQueue::takeAll()
+{
+    QVector<Event> events;
+    QMutexLocker locker(&m_mutex);
+    events.swap(m_pending);
+    m_drainScheduled = false;
+    return events;
+}
+
+void InboundEventQueue::recordDrain(int batchSize, qint64 drainNs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.batches++;
+    m_stats.events += batchSize;
+    m_stats.lastBatchSize = batchSize;
+    m_stats.maxBatchSize = qMax(m_stats.maxBatchSize, batchSize);
+    m_stats.lastDrainNs = drainNs;
+    m_stats.maxDrainNs = qMax(m_stats.maxDrainNs, drainNs);
+    m_stats.totalDrainNs += drainNs;
+}
+
+InboundEventQueue::Stats InboundEventQueue::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
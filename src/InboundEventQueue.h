@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QMutex>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+// chatsdkNewMessage payload after JSON parsing and content decoding
+struct InboundMessage {
+    QString conversationId;
+    QString sender;
+    QString content;
+    QDateTime receivedAt;
+    int payloadBytes = 0;
+    qint64 receivedNs = 0;  // LatencyMonitor::now() in the module callback, 0 if unknown
+};
+
+// chatsdkNewConversation payload after JSON parsing
+struct InboundConversation {
+    QString conversationId;
+    QString conversationType;
+    QString peerId;
+};
+
+// chatsdkSendMessageResult payload after JSON parsing
+struct InboundSendResult {
+    bool success = false;
+    int returnCode = -1;
+    QString conversationId;  // Empty when the result does not name one
+    quint64 clientId = 0;    // The Outbox id, when the backend carries it back
+};
+
+/**
+ * Coalescing queue between the event decoder and the GUI thread.
+ *
+ * post() may be called from any thread. The first event posted after a
+ * drain schedules a single queued drainRequested() on the queue's thread;
+ * everything that arrives before that runs is handled in the same batch.
+ */
+class InboundEventQueue : public QObject {
+    Q_OBJECT
+
+public:
+    // Decoded events carry their payload in message / conversation /
+    // sendResult; everything else keeps the raw module data.
+    struct Event {
+        QString name;
+        QVariantList data;
+        InboundMessage message;
+        InboundConversation conversation;
+        InboundSendResult sendResult;
+    };
+
+    struct Stats {
+        quint64 batches = 0;
+        quint64 events = 0;
+        int lastBatchSize = 0;
+        int maxBatchSize = 0;
+        qint64 lastDrainNs = 0;
+        qint64 maxDrainNs = 0;
+        qint64 totalDrainNs = 0;
+    };
+
+    explicit InboundEventQueue(QObject* parent = nullptr);
+    ~InboundEventQueue() = default;
+
+    void post(const Event& event);
+    void postAll(const QVector<Event>& events);
+    QVector<Event> takeAll();
+
+    void recordDrain(int batchSize, qint64 drainNs);
+    Stats stats() const;
+
+signals:
+    void drainRequested();
+
+private:
+    mutable QMutex m_mutex;
+    QVector<Event> m_pending;
+    bool m_drainScheduled;
+    Stats m_stats;
+};
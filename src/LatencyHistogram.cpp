@@ -0,0 +1,75 @@
+#include "LatencyHistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_min = std::numeric_limits<qint64>::max();
+    m_max = 0;
+    m_sum = 0.0;
+}
+
+int LatencyHistogram::bucketIndex(qint64 value)
+{
+    if (value < kSubBucketCount) {
+        return int(value);
+    }
+    // Keep the top kSubBucketBits bits; the shift selects the power of two
+    const int msb = 63 - qCountLeadingZeroBits(quint64(value));
+    const int shift = msb - (kSubBucketBits - 1);
+    const int subBucket = int(value >> shift);  // In [64, 128)
+    return kSubBucketCount + (shift - 1) * kSubBucketHalf + (subBucket - kSubBucketHalf);
+}
+
+qint64 LatencyHistogram::bucketUpperValue(int index)
+{
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const int offset = index - kSubBucketCount;
+    const int shift = offset / kSubBucketHalf + 1;
+    const qint64 subBucket = offset % kSubBucketHalf + kSubBucketHalf;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+    const qint64 value = qBound<qint64>(0, valueUs, kMaxValue);
+    ++m_counts[bucketIndex(value)];
+    ++m_count;
+    m_min = qMin(m_min, value);
+    m_max = qMax(m_max, value);
+    m_sum += double(value);
+}
+
+double LatencyHistogram::mean() const
+{
+    return m_count ? m_sum / double(m_count) : 0.0;
+}
+
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const double clamped = qBound(0.0, percentile, 100.0);
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(clamped / 100.0 * double(m_count))));
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += m_counts[i];
+        if (seen >= target) {
+            // Bucket bounds are approximate; never report past what was seen
+            return qBound(m_min, bucketUpperValue(i), m_max);
+        }
+    }
+    return m_max;
+}
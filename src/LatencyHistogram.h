@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+
+/**
+ * Fixed-size latency histogram in microseconds, in the style of
+ * HdrHistogram.
+ *
+ * Values below 128 us get a bucket each. Above that, every power of two is
+ * split into 64 linear buckets, so any recorded value is reported with a
+ * relative error below 1.6% (two significant digits). Values up to 2^37 us
+ * (about 38 hours) are tracked; longer ones are clamped. Recording is a
+ * couple of bit operations and an increment, with no allocation.
+ *
+ * Not thread-safe.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(qint64 valueUs);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 min() const { return m_count ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const;
+
+    // Smallest recorded bucket value with at least percentile% of the
+    // samples at or below it; 0 when empty
+    qint64 valueAtPercentile(double percentile) const;
+
+private:
+    static constexpr int kSubBucketBits = 7;
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits;  // 128
+    static constexpr int kSubBucketHalf = kSubBucketCount / 2;   // 64
+    static constexpr int kMaxShift = 30;
+    static constexpr int kBucketCount = kSubBucketCount + kMaxShift * kSubBucketHalf;
+    static constexpr qint64 kMaxValue = (qint64(kSubBucketCount) << kMaxShift) - 1;
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperValue(int index);
+
+    std::array<quint64, kBucketCount> m_counts;
+    quint64 m_count;
+    qint64 m_min;
+    qint64 m_max;
+    double m_sum;
+};
@@ -0,0 +1,165 @@
+#include "LatencyMonitor.h"
+#include <QDateTime>
+#include <QEvent>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QWidget>
+#include <chrono>
+
+namespace {
+
+// Messages added to a timeline that is never painted (minimized, hidden)
+// are dropped past this many
+constexpr int kMaxPendingPaints = 4096;
+
+QString formatUs(qint64 us)
+{
+    if (us < 1000) {
+        return QString("%1 us").arg(us);
+    }
+    if (us < 1000000) {
+        return QString("%1 ms").arg(us / 1000.0, 0, 'f', us < 10000 ? 2 : 1);
+    }
+    return QString("%1 s").arg(us / 1000000.0, 0, 'f', 2);
+}
+
+} // namespace
+
+LatencyMonitor::LatencyMonitor(QObject* parent)
+    : QObject(parent)
+    , m_viewport(nullptr)
+{
+}
+
+qint64 LatencyMonitor::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+QString LatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+    case Queue: return "queue";
+    case Store: return "store";
+    case Paint: return "paint";
+    case Total: return "total";
+    case StageCount: break;
+    }
+    return QString();
+}
+
+void LatencyMonitor::record(Stage stage, qint64 startNs, qint64 endNs)
+{
+    m_histograms[stage].record((endNs - startNs) / 1000);
+}
+
+void LatencyMonitor::recordStored(qint64 receivedNs, qint64 dispatchedNs, qint64 storedNs)
+{
+    record(Queue, receivedNs, dispatchedNs);
+    record(Store, dispatchedNs, storedNs);
+}
+
+void LatencyMonitor::expectPaint(qint64 receivedNs, qint64 storedNs)
+{
+    if (!m_viewport) {
+        return;
+    }
+    if (m_pendingPaints.size() >= kMaxPendingPaints) {
+        m_pendingPaints.removeFirst();
+    }
+    m_pendingPaints.append({receivedNs, storedNs});
+}
+
+void LatencyMonitor::watchPaints(QWidget* viewport)
+{
+    if (m_viewport) {
+        m_viewport->removeEventFilter(this);
+    }
+    m_viewport = viewport;
+    m_pendingPaints.clear();
+    if (m_viewport) {
+        m_viewport->installEventFilter(this);
+    }
+}
+
+bool LatencyMonitor::eventFilter(QObject* watched, QEvent* event)
+{
+    // The paint event reads the model as it is now, so the first one after
+    // an append is the first frame that contains the new rows
+    if (watched == m_viewport && event->type() == QEvent::Paint &&
+        !m_pendingPaints.isEmpty()) {
+        const qint64 paintedNs = now();
+        for (const PendingPaint& pending : m_pendingPaints) {
+            record(Paint, pending.storedNs, paintedNs);
+            record(Total, pending.receivedNs, paintedNs);
+        }
+        m_pendingPaints.clear();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void LatencyMonitor::reset()
+{
+    for (auto& histogram : m_histograms) {
+        histogram.reset();
+    }
+    m_pendingPaints.clear();
+}
+
+QString LatencyMonitor::summary() const
+{
+    QStringList parts;
+    for (int i = 0; i < StageCount; ++i) {
+        const LatencyHistogram& h = m_histograms[i];
+        if (h.count() == 0) {
+            continue;
+        }
+        parts.append(QString("%1 %2 / %3 / %4")
+                         .arg(stageName(Stage(i)), formatUs(h.valueAtPercentile(50)),
+                              formatUs(h.valueAtPercentile(99)), formatUs(h.max())));
+    }
+    if (parts.isEmpty()) {
+        return "latency: no messages yet";
+    }
+    return "p50 / p99 / max  " + parts.join("  |  ");
+}
+
+QString LatencyMonitor::report() const
+{
+    static const double percentiles[] = {50.0, 75.0, 90.0, 95.0, 99.0, 99.9, 99.99, 100.0};
+
+    QString text;
+    QTextStream out(&text);
+    out << "# chatsdk_ui message latency, "
+        << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n"
+        << "# values in microseconds\n";
+    for (int i = 0; i < StageCount; ++i) {
+        const LatencyHistogram& h = m_histograms[i];
+        out << "\n[" << stageName(Stage(i)) << "]\n"
+            << "count " << h.count() << "\n"
+            << "min " << h.min() << "\n"
+            << "mean " << QString::number(h.mean(), 'f', 1) << "\n";
+        for (double percentile : percentiles) {
+            out << "p" << percentile << " " << h.valueAtPercentile(percentile) << "\n";
+        }
+    }
+    return text;
+}
+
+bool LatencyMonitor::dumpToFile(const QString& path, QString* error) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(report().toUtf8());
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QWidget;
+
+/**
+ * End-to-end latency of incoming messages, split by pipeline stage.
+ *
+ * A message is stamped when the module callback receives it, when the
+ * queued drain dispatches it on the GUI thread, when it is appended to the
+ * message store and when the timeline first paints after it was added:
+ *
+ *   Queue  receipt  -> dispatch   (decoder thread, inbound queue, event loop)
+ *   Store  dispatch -> stored     (store append, search index)
+ *   Paint  stored   -> painted    (batch flush, layout, next frame)
+ *   Total  receipt  -> painted
+ *
+ * Messages for conversations that are not on screen have no paint stamp and
+ * only count towards Queue and Store. Stamps come from now(), a monotonic
+ * clock that can be read on any thread; everything else is GUI-thread only.
+ */
+class LatencyMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    enum Stage { Queue, Store, Paint, Total, StageCount };
+
+    explicit LatencyMonitor(QObject* parent = nullptr);
+    ~LatencyMonitor() = default;
+
+    // Monotonic nanoseconds
+    static qint64 now();
+    static QString stageName(Stage stage);
+
+    void recordStored(qint64 receivedNs, qint64 dispatchedNs, qint64 storedNs);
+    // The message was added to the timeline; completed on its next paint
+    void expectPaint(qint64 receivedNs, qint64 storedNs);
+    // Timeline viewport whose paint events complete expectPaint() messages
+    void watchPaints(QWidget* viewport);
+
+    const LatencyHistogram& histogram(Stage stage) const { return m_histograms[stage]; }
+    void reset();
+
+    // One line per stage: p50 / p99 / max
+    QString summary() const;
+    // Percentile table per stage, for dumps and bug reports
+    QString report() const;
+    bool dumpToFile(const QString& path, QString* error = nullptr) const;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    struct PendingPaint {
+        qint64 receivedNs;
+        qint64 storedNs;
+    };
+
+    void record(Stage stage, qint64 startNs, qint64 endNs);
+
+    LatencyHistogram m_histograms[StageCount];
+    QVector<PendingPaint> m_pendingPaints;
+    QWidget* m_viewport;
+};
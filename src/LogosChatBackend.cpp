@@ -0,0 +1,90 @@
+#include "LogosChatBackend.h"
+#include "logos_api.h"
+#include "logos_sdk.h"
+#include <QThread>
+
+LogosChatBackend::LogosChatBackend(LogosAPI* logosAPI)
+    : m_logosAPI(logosAPI)
+    , m_ownsLogosAPI(false)
+    , m_logos(nullptr)
+    , m_ownerThread(QThread::currentThread())
+{
+    // Create our own LogosAPI if none was provided
+    if (!m_logosAPI) {
+        m_logosAPI = new LogosAPI("core");
+        m_ownsLogosAPI = true;
+    }
+
+    m_logos = new LogosModules(m_logosAPI);
+}
+
+LogosChatBackend::~LogosChatBackend()
+{
+    delete m_logos;
+    m_logos = nullptr;
+
+    // Only delete LogosAPI if we created it ourselves
+    if (m_ownsLogosAPI) {
+        delete m_logosAPI;
+    }
+    m_logosAPI = nullptr;
+}
+
+void LogosChatBackend::on(const QString& eventName, EventHandler handler)
+{
+    m_logos->chatsdk_module.on(eventName, [handler](const QVariantList& data) {
+        handler(data);
+    });
+}
+
+void LogosChatBackend::setEventCallback()
+{
+    m_logos->chatsdk_module.setEventCallback();
+}
+
+bool LogosChatBackend::initChat(const QString& configJson)
+{
+    return m_logos->chatsdk_module.initChat(configJson);
+}
+
+bool LogosChatBackend::startChat()
+{
+    return m_logos->chatsdk_module.startChat();
+}
+
+bool LogosChatBackend::stopChat()
+{
+    return m_logos->chatsdk_module.stopChat();
+}
+
+void LogosChatBackend::getId()
+{
+    m_logos->chatsdk_module.getId();
+}
+
+bool LogosChatBackend::createIntroBundle()
+{
+    return m_logos->chatsdk_module.createIntroBundle();
+}
+
+bool LogosChatBackend::newPrivateConversation(const QString& introBundle,
+                                              const QString& contentHex)
+{
+    return m_logos->chatsdk_module.newPrivateConversation(introBundle, contentHex);
+}
+
+bool LogosChatBackend::sendMessage(const QString& conversationId, const QString& contentHex,
+                                   quint64 clientId)
+{
+    // The module has no client-side id; its results are matched in order
+    Q_UNUSED(clientId);
+    if (QThread::currentThread() == m_ownerThread) {
+        return m_logos->chatsdk_module.sendMessage(conversationId, contentHex);
+    }
+    // Another thread (the outbox sender) wraps the host's API in modules of
+    // its own rather than sharing m_logos, whose objects live on the GUI thread.
+    if (!m_threadModules.hasLocalData()) {
+        m_threadModules.setLocalData(new LogosModules(m_logosAPI));
+    }
+    return m_threadModules.localData()->chatsdk_module.sendMessage(conversationId, contentHex);
+}
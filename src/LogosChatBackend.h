@@ -0,0 +1,47 @@
+#pragma once
+
+#include "IChatBackend.h"
+#include <QThreadStorage>
+
+class LogosAPI;
+class LogosModules;
+class QThread;
+
+/**
+ * IChatBackend over the chatsdk_module loaded by Logos Core.
+ *
+ * Uses the given LogosAPI, or creates (and owns) one connected to "core".
+ * Every call, sends included, goes through that API: the host's connection
+ * is the authenticated one. sendMessage() may be called from the outbox's
+ * sender thread, which then gets a LogosModules of its own over the same
+ * API, so the blocking remote call is made there and not on the GUI thread.
+ */
+class LogosChatBackend : public IChatBackend {
+public:
+    explicit LogosChatBackend(LogosAPI* logosAPI = nullptr);
+    ~LogosChatBackend() override;
+
+    LogosChatBackend(const LogosChatBackend&) = delete;
+    LogosChatBackend& operator=(const LogosChatBackend&) = delete;
+
+    void on(const QString& eventName, EventHandler handler) override;
+    void setEventCallback() override;
+
+    bool initChat(const QString& configJson) override;
+    bool startChat() override;
+    bool stopChat() override;
+
+    void getId() override;
+    bool createIntroBundle() override;
+    bool newPrivateConversation(const QString& introBundle, const QString& contentHex) override;
+    bool sendMessage(const QString& conversationId, const QString& contentHex,
+                     quint64 clientId) override;
+    bool sendsFromAnyThread() const override { return true; }
+
+private:
+    LogosAPI* m_logosAPI;
+    bool m_ownsLogosAPI;
+    LogosModules* m_logos;
+    QThread* m_ownerThread;
+    QThreadStorage<LogosModules*> m_threadModules;  // Deleted as each thread finishes
+};
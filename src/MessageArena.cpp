@@ -0,0 +1,92 @@
+#include "MessageArena.h"
+#include <QStringEncoder>
+#include <limits>
+
+void MessageArena::append(const ChatMessage& message)
+{
+    // Encoded straight into the arena; the arena grows geometrically, so
+    // there is no allocation per message
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    const qsizetype begin = m_content.size();
+    m_content.resize(begin + encoder.requiredSpace(message.content.size()));
+    char* end = encoder.appendToBuffer(m_content.data() + begin, message.content);
+    m_content.truncate(end - m_content.constData());
+    Q_ASSERT(m_content.size() <= std::numeric_limits<quint32>::max());
+
+    Record record;
+    record.timestampMs = message.timestamp.toMSecsSinceEpoch();
+    record.contentEnd = static_cast<quint32>(m_content.size());
+    record.sender = senderId(message.sender);
+    record.flags = message.isMe ? kFlagIsMe : 0;
+    m_records.append(record);
+    setSendStateAt(m_records.size() - 1, message.sendState);
+}
+
+void MessageArena::setSendStateAt(int index, ChatMessage::SendState state)
+{
+    Record& record = m_records[index];
+    record.flags = static_cast<quint8>((record.flags & ~kSendStateMask) |
+                                       ((quint8(state) << kSendStateShift) & kSendStateMask));
+}
+
+void MessageArena::removeFirst(int count)
+{
+    if (count <= 0) return;
+    if (count >= m_records.size()) {
+        clear();
+        return;
+    }
+
+    // What is left is moved to the front; in the store that is only the
+    // messages appended while a batch was being written
+    const quint32 cut = contentBegin(count);
+    m_content.remove(0, cut);
+    m_records.remove(0, count);
+    for (Record& record : m_records) {
+        record.contentEnd -= cut;
+    }
+}
+
+void MessageArena::clear()
+{
+    // Senders are kept; the same ones come back with the next messages
+    m_records.clear();
+    m_content.clear();
+}
+
+ChatMessage MessageArena::at(int index) const
+{
+    const Record& record = m_records.at(index);
+    ChatMessage message;
+    message.sender = m_senders.at(record.sender).name;
+    message.content = QString::fromUtf8(contentUtf8At(index));
+    message.timestamp = QDateTime::fromMSecsSinceEpoch(record.timestampMs);
+    message.isMe = (record.flags & kFlagIsMe) != 0;
+    message.sendState = sendStateAt(index);
+    return message;
+}
+
+QByteArrayView MessageArena::senderUtf8At(int index) const
+{
+    return m_senders.at(m_records.at(index).sender).utf8;
+}
+
+QByteArrayView MessageArena::contentUtf8At(int index) const
+{
+    const quint32 begin = contentBegin(index);
+    return QByteArrayView(m_content.constData() + begin, m_records.at(index).contentEnd - begin);
+}
+
+quint16 MessageArena::senderId(const QString& name)
+{
+    // A conversation has a handful of senders at most, so a scan is cheaper
+    // than hashing the name
+    for (int i = m_senders.size() - 1; i >= 0; --i) {
+        if (m_senders.at(i).name == name) {
+            return static_cast<quint16>(i);
+        }
+    }
+    Q_ASSERT(m_senders.size() <= std::numeric_limits<quint16>::max());
+    m_senders.append({name, name.toUtf8()});
+    return static_cast<quint16>(m_senders.size() - 1);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+#include "ChatMessage.h"
+
+/**
+ * The messages of one conversation, packed for memory.
+ *
+ * Each message is a 16-byte record: its timestamp in ms since the epoch,
+ * where its content ends, an interned sender id and flag bits (isMe and the
+ * send state). Content is
+ * kept as UTF-8, back to back in one byte arena, so a message costs its
+ * record plus its encoded text and no allocation of its own. Senders (in
+ * practice "Me" and the peer) are stored once per arena.
+ *
+ * Messages are only appended, or dropped from the front once written out.
+ * at() decodes one back into a ChatMessage; the UTF-8 accessors let the
+ * store write records without converting them.
+ *
+ * Copies share their data until one of them changes, like Qt containers.
+ */
+class MessageArena {
+public:
+    MessageArena() = default;
+
+    void append(const ChatMessage& message);
+    // Drops the oldest count messages
+    void removeFirst(int count);
+    void clear();
+
+    int size() const { return m_records.size(); }
+    bool isEmpty() const { return m_records.isEmpty(); }
+
+    ChatMessage at(int index) const;
+    qint64 timestampMsAt(int index) const { return m_records.at(index).timestampMs; }
+    bool isMeAt(int index) const { return (m_records.at(index).flags & kFlagIsMe) != 0; }
+    ChatMessage::SendState sendStateAt(int index) const
+    {
+        return static_cast<ChatMessage::SendState>(
+            (m_records.at(index).flags & kSendStateMask) >> kSendStateShift);
+    }
+    void setSendStateAt(int index, ChatMessage::SendState state);
+    QByteArrayView senderUtf8At(int index) const;
+    QByteArrayView contentUtf8At(int index) const;
+
+private:
+    static constexpr quint8 kFlagIsMe = 0x01;
+    static constexpr quint8 kSendStateShift = 1;
+    static constexpr quint8 kSendStateMask = 0x06;
+
+    struct Record {
+        qint64 timestampMs;
+        quint32 contentEnd;  // One past the content in m_content
+        quint16 sender;      // Index into m_senders
+        quint8 flags;
+    };
+    static_assert(sizeof(Record) == 16, "MessageArena::Record should stay 16 bytes");
+
+    struct Sender {
+        QString name;
+        QByteArray utf8;
+    };
+
+    quint16 senderId(const QString& name);
+    quint32 contentBegin(int index) const
+    {
+        return index == 0 ? 0 : m_records.at(index - 1).contentEnd;
+    }
+
+    QVector<Record> m_records;
+    QByteArray m_content;  // UTF-8 of every message, in order
+    QVector<Sender> m_senders;
+};
@@ -0,0 +1,418 @@
+#include "MessageBubbleDelegate.h"
+#include "MessageListModel.h"
+#include "Theme.h"
+#include <QAbstractItemView>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPointer>
+#include <QTextLayout>
+#include <QThreadPool>
+#include <QtMath>
+#include <utility>
+
+namespace {
+
+// Geometry matches the former MessageBubble widget layout
+constexpr int kRowMarginH = 10;
+constexpr int kRowMarginV = 5;
+constexpr int kRowSpacing = 5;
+constexpr int kPadding = 16;
+constexpr int kLineSpacing = 4;
+constexpr int kRadius = 8;
+constexpr int kMinBubbleWidth = 120;
+constexpr int kMinContentWidth = 100;
+
+// Wrap widths snap down to a multiple of this, so nearby widths share a layout
+constexpr int kWidthBucket = 8;
+constexpr int kTextCacheEntries = 20000;
+constexpr int kPixmapCacheKiB = 64 * 1024;
+// Taller bubbles are painted directly rather than kept as a pixmap
+constexpr int kMaxCachedBubbleHeight = 2048;
+// Messages per pool task when prefetching
+constexpr int kShapingChunk = 16;
+
+// Wrap width for a row whose usable width (inside the row margins) is given
+int wrapWidth(int innerWidth)
+{
+    // Bubble takes half of the row, as the old spacer-based layout did
+    int bubbleWidth = qMax(kMinBubbleWidth, innerWidth / 2);
+    bubbleWidth = qMin(bubbleWidth, qMax(kMinBubbleWidth, innerWidth));
+    return qMax(kMinContentWidth, (bubbleWidth - 2 * kPadding) / kWidthBucket * kWidthBucket);
+}
+
+// Line breaks and glyphs for one message. Only touches its own QTextLayout,
+// so it can run on a pool thread.
+QTextLayout* shapeText(const QString& content, const QFont& font, int textWidth)
+{
+    QString text = content;
+    text.replace(QLatin1Char('\n'), QChar::LineSeparator);
+    auto* layout = new QTextLayout(text, font);
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    layout->setTextOption(textOption);
+    layout->setCacheEnabled(true);
+
+    qreal height = 0;
+    layout->beginLayout();
+    for (QTextLine line = layout->createLine(); line.isValid(); line = layout->createLine()) {
+        line.setLineWidth(textWidth);
+        line.setPosition(QPointF(0, height));
+        height += line.height();
+    }
+    layout->endLayout();
+    return layout;
+}
+
+// Outgoing messages that are not (yet) sent say so after the time
+QString timestampText(const QDateTime& timestamp, ChatMessage::SendState state)
+{
+    const QString time = timestamp.toString("h:mm AP");
+    switch (state) {
+    case ChatMessage::SendState::Pending:
+        return time + QString(" \xc2\xb7 sending");
+    case ChatMessage::SendState::Failed:
+        return time + QString(" \xc2\xb7 not sent");
+    case ChatMessage::SendState::Unconfirmed:
+        return time + QString(" \xc2\xb7 unconfirmed");
+    case ChatMessage::SendState::Sent:
+        break;
+    }
+    return time;
+}
+
+QPainterPath bubblePath(const QRect& rect)
+{
+    QPainterPath path;
+    path.addRoundedRect(QRectF(rect).adjusted(0.5, 0.5, -0.5, -0.5), kRadius, kRadius);
+    return path;
+}
+
+} // namespace
+
+MessageBubbleDelegate::MessageBubbleDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+    , m_timestampHeight(-1)
+    , m_textCache(kTextCacheEntries)
+    , m_pixmapCache(kPixmapCacheKiB)
+    , m_cacheGeneration(0)
+    , m_layoutWidth(0)
+{
+    // Cached bubbles carry the theme's colors
+    connect(&Theme::instance(), &Theme::changed, this, &MessageBubbleDelegate::clearCache);
+}
+
+void MessageBubbleDelegate::clearCache()
+{
+    dropCaches();
+}
+
+void MessageBubbleDelegate::dropCaches() const
+{
+    m_textCache.clear();
+    m_pixmapCache.clear();
+    m_shaping.clear();
+    ++m_cacheGeneration;
+
+    // Results in flight are now dropped, so nobody waits for them. Released
+    // from the event loop, not from inside the paint or measure that got here.
+    const QList<Waiter> waiters = std::exchange(m_waiters, {});
+    for (const Waiter& waiter : waiters) {
+        QMetaObject::invokeMethod(
+            const_cast<MessageBubbleDelegate*>(this), waiter.done, Qt::QueuedConnection);
+    }
+}
+
+void MessageBubbleDelegate::setLayoutWidth(int width)
+{
+    m_layoutWidth = width;
+}
+
+int MessageBubbleDelegate::availableWidth(const QStyleOptionViewItem& option) const
+{
+    if (m_layoutWidth > 0) {
+        return m_layoutWidth;
+    }
+    // QListView does not hand the row width to sizeHint(), so use the viewport
+    if (auto* view = qobject_cast<const QAbstractItemView*>(option.widget)) {
+        return view->viewport()->width();
+    }
+    return option.rect.width();
+}
+
+QFont MessageBubbleDelegate::contentFont(const QStyleOptionViewItem& option) const
+{
+    QFont font = option.font;
+    font.setPointSize(13);
+    return font;
+}
+
+QFont MessageBubbleDelegate::timestampFont(const QStyleOptionViewItem& option) const
+{
+    QFont font = option.font;
+    font.setPointSize(10);
+    return font;
+}
+
+void MessageBubbleDelegate::checkFont(const QStyleOptionViewItem& option) const
+{
+    if (m_timestampHeight >= 0 && option.font == m_cachedFont) {
+        return;
+    }
+    m_cachedFont = option.font;
+    m_timestampHeight = QFontMetrics(timestampFont(option)).height();
+    dropCaches();
+}
+
+const QTextLayout* MessageBubbleDelegate::shapedText(const QStyleOptionViewItem& option,
+                                                     const QString& content,
+                                                     int textWidth) const
+{
+    const TextKey key{content, textWidth};
+    if (const QTextLayout* cached = m_textCache.object(key)) {
+        return cached;
+    }
+
+    QTextLayout* layout = shapeText(content, contentFont(option), textWidth);
+    m_textCache.insert(key, layout);
+    return layout;
+}
+
+bool MessageBubbleDelegate::prefetchLayouts(const QList<ChatMessage>& messages,
+                                            const QAbstractItemView* view,
+                                            std::function<void()> done) const
+{
+    QStyleOptionViewItem option;
+    option.font = view->font();
+    option.widget = view;
+    checkFont(option);
+    const int textWidth = wrapWidth(availableWidth(option) - 2 * kRowMarginH);
+    const QFont font = contentFont(option);
+
+    // Rows already being shaped for an earlier page are waited for, not
+    // shaped twice
+    QSet<TextKey> remaining;
+    QList<QString> pending;
+    for (const ChatMessage& message : messages) {
+        const TextKey key{message.content, textWidth};
+        if (m_textCache.contains(key)) continue;
+        remaining.insert(key);
+        if (!m_shaping.contains(key)) {
+            m_shaping.insert(key);
+            pending.append(message.content);
+        }
+    }
+    if (remaining.isEmpty()) {
+        return true;
+    }
+    if (done) {
+        m_waiters.append({remaining, std::move(done)});
+    }
+
+    // Copied into each task, and only read back on the GUI thread
+    const QPointer<MessageBubbleDelegate> self(const_cast<MessageBubbleDelegate*>(this));
+    const quint64 generation = m_cacheGeneration;
+    for (int first = 0; first < pending.size(); first += kShapingChunk) {
+        const QList<QString> contents = pending.mid(first, kShapingChunk);
+        QThreadPool::globalInstance()->start([self, contents, font, textWidth, generation]() {
+            QList<QTextLayout*> shaped;
+            shaped.reserve(contents.size());
+            for (const QString& content : contents) {
+                shaped.append(shapeText(content, font, textWidth));
+            }
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [self, contents, shaped, textWidth, generation]() {
+                    if (!self) {
+                        qDeleteAll(shaped);
+                        return;
+                    }
+                    self->adoptShaped(contents, shaped, textWidth, generation);
+                },
+                Qt::QueuedConnection);
+        });
+    }
+    return false;
+}
+
+void MessageBubbleDelegate::adoptShaped(const QList<QString>& contents,
+                                        const QList<QTextLayout*>& shaped, int textWidth,
+                                        quint64 generation) const
+{
+    // Shaped with a font or theme that has since changed
+    if (generation != m_cacheGeneration) {
+        qDeleteAll(shaped);
+        return;
+    }
+
+    QList<std::function<void()>> finished;
+    for (int i = 0; i < contents.size(); ++i) {
+        const TextKey key{contents.at(i), textWidth};
+        m_shaping.remove(key);
+        for (Waiter& waiter : m_waiters) {
+            waiter.remaining.remove(key);
+        }
+        // Already shaped on the GUI thread because it was needed first
+        if (m_textCache.contains(key)) {
+            delete shaped.at(i);
+            continue;
+        }
+        m_textCache.insert(key, shaped.at(i));
+    }
+    for (auto it = m_waiters.begin(); it != m_waiters.end();) {
+        if (it->remaining.isEmpty()) {
+            finished.append(std::move(it->done));
+            it = m_waiters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Last, since a callback may ask for another page
+    for (const auto& done : finished) {
+        done();
+    }
+}
+
+int MessageBubbleDelegate::wrapWidthForRow(const QRect& rowRect) const
+{
+    // A pinned width keeps painted bubbles the height the rows were sized for
+    const int rowWidth = m_layoutWidth > 0 ? m_layoutWidth : rowRect.width();
+    return wrapWidth(rowWidth - 2 * kRowMarginH);
+}
+
+MessageBubbleDelegate::BubbleLayout MessageBubbleDelegate::layoutBubble(
+    const QStyleOptionViewItem& option, const QRect& rowRect,
+    const QString& content, bool isMe) const
+{
+    const QRect inner = rowRect.adjusted(kRowMarginH, kRowMarginV,
+                                         -kRowMarginH, -(kRowMarginV + kRowSpacing));
+
+    const int textWidth = wrapWidthForRow(rowRect);
+    const int bubbleWidth = textWidth + 2 * kPadding;
+
+    const int contentHeight =
+        qCeil(shapedText(option, content, textWidth)->boundingRect().height());
+
+    const int bubbleHeight = 2 * kPadding + contentHeight + kLineSpacing + m_timestampHeight;
+    const int bubbleX = isMe ? inner.right() - bubbleWidth + 1 : inner.left();
+
+    BubbleLayout layout;
+    layout.bubbleRect = QRect(bubbleX, inner.top(), bubbleWidth, bubbleHeight);
+    layout.contentRect = QRect(bubbleX + kPadding, inner.top() + kPadding,
+                               textWidth, contentHeight);
+    layout.timestampRect = QRect(bubbleX + kPadding,
+                                 layout.contentRect.bottom() + 1 + kLineSpacing,
+                                 textWidth, m_timestampHeight);
+    return layout;
+}
+
+void MessageBubbleDelegate::drawBubble(QPainter* painter, const QStyleOptionViewItem& option,
+                                       const BubbleLayout& layout, const QString& content,
+                                       const QDateTime& timestamp, bool isMe,
+                                       ChatMessage::SendState sendState) const
+{
+    const QPainterPath path = bubblePath(layout.bubbleRect);
+
+    // Colors are read per render; cached bubbles are dropped on a theme change
+    const Theme::Colors& colors = Theme::instance().colors();
+    QColor textColor;
+    QColor timestampColor;
+    if (isMe) {
+        // My message - right aligned, accent background
+        painter->fillPath(path, colors.accent);
+        textColor = colors.onAccent;
+        timestampColor = colors.onAccentMuted;
+    } else {
+        // Counterparty message - left aligned, bordered background
+        painter->fillPath(path, colors.hover);
+        painter->setPen(QPen(colors.border, 1));
+        painter->drawPath(path);
+        textColor = colors.text;
+        timestampColor = colors.textFaint;
+    }
+
+    painter->setPen(textColor);
+    shapedText(option, content, layout.contentRect.width())
+        ->draw(painter, layout.contentRect.topLeft());
+
+    painter->setFont(timestampFont(option));
+    painter->setPen(timestampColor);
+    painter->drawText(layout.timestampRect, isMe ? Qt::AlignRight : Qt::AlignLeft,
+                      timestampText(timestamp, sendState));
+}
+
+QPixmap MessageBubbleDelegate::renderBubble(const QStyleOptionViewItem& option,
+                                            const BubbleLayout& layout,
+                                            const QString& content,
+                                            const QDateTime& timestamp, bool isMe,
+                                            ChatMessage::SendState sendState,
+                                            qreal dpr) const
+{
+    QPixmap pixmap(layout.bubbleRect.size() * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.translate(-layout.bubbleRect.topLeft());
+    drawBubble(&painter, option, layout, content, timestamp, isMe, sendState);
+    return pixmap;
+}
+
+void MessageBubbleDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                  const QModelIndex& index) const
+{
+    checkFont(option);
+
+    const QString content = index.data(MessageListModel::ContentRole).toString();
+    const QDateTime timestamp = index.data(MessageListModel::TimestampRole).toDateTime();
+    const bool isMe = index.data(MessageListModel::IsMeRole).toBool();
+    const auto sendState = static_cast<ChatMessage::SendState>(
+        index.data(MessageListModel::SendStateRole).toInt());
+
+    const BubbleLayout layout = layoutBubble(option, option.rect, content, isMe);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    if (layout.bubbleRect.height() > kMaxCachedBubbleHeight) {
+        drawBubble(painter, option, layout, content, timestamp, isMe, sendState);
+    } else {
+        const qreal dpr = painter->device()->devicePixelRatioF();
+        const PixmapKey key{{content, layout.contentRect.width()},
+                            timestamp.toMSecsSinceEpoch(), isMe, sendState,
+                            qRound(dpr * 100)};
+        QPixmap pixmap;
+        if (const QPixmap* cached = m_pixmapCache.object(key)) {
+            pixmap = *cached;
+        } else {
+            pixmap = renderBubble(option, layout, content, timestamp, isMe, sendState, dpr);
+            const qint64 bytes = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+            m_pixmapCache.insert(key, new QPixmap(pixmap), qMax<qint64>(1, bytes / 1024));
+        }
+        painter->drawPixmap(layout.bubbleRect.topLeft(), pixmap);
+    }
+
+    if (option.state & QStyle::State_Selected) {
+        painter->setBrush(Qt::NoBrush);
+        painter->setPen(QPen(Theme::instance().colors().text, 1));
+        painter->drawPath(bubblePath(layout.bubbleRect));
+    }
+
+    painter->restore();
+}
+
+QSize MessageBubbleDelegate::sizeHint(const QStyleOptionViewItem& option,
+                                      const QModelIndex& index) const
+{
+    checkFont(option);
+
+    const QString content = index.data(MessageListModel::ContentRole).toString();
+    const bool isMe = index.data(MessageListModel::IsMeRole).toBool();
+
+    const int width = availableWidth(option);
+    const BubbleLayout layout = layoutBubble(option, QRect(0, 0, width, 0), content, isMe);
+    return QSize(width, layout.bubbleRect.height() + 2 * kRowMarginV + kRowSpacing);
+}
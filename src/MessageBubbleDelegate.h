@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QStyledItemDelegate>
+#include <QCache>
+#include <QDateTime>
+#include <QFont>
+#include <QHashFunctions>
+#include <QPixmap>
+#include <QSet>
+#include <QTextLayout>
+#include <functional>
+#include "ChatMessage.h"
+
+class QAbstractItemView;
+
+/**
+ * Paints a chat message as a bubble directly onto the timeline viewport.
+ *
+ * Replaces the old per-message MessageBubble widget: no child widgets,
+ * layouts or stylesheets are created per row, only the visible rows are
+ * painted, and the geometry mirrors the previous layout (bubble takes half
+ * of the row, 16px padding, 8px radius).
+ *
+ * Text is wrapped at a width rounded down to a multiple of 8 pixels, and both
+ * the shaped text and the rendered bubble are cached per message and width
+ * bucket (the bubble also per device pixel ratio). While the view is being
+ * resized the owner pins the wrap width with setLayoutWidth(), so dragging
+ * the window moves bubbles but shapes nothing; the rows are measured again
+ * once at the final width. The caches are dropped when the font or the theme
+ * changes.
+ */
+class MessageBubbleDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit MessageBubbleDelegate(QObject* parent = nullptr);
+    ~MessageBubbleDelegate() = default;
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option,
+                   const QModelIndex& index) const override;
+
+    // Shapes a page on the global thread pool, at the view's current width,
+    // and adds the results to the cache back on the GUI thread. Returns true
+    // if every row was shaped already; otherwise done, if given, runs on the
+    // GUI thread once they all are, or once the cache has been dropped.
+    // Nothing blocks on it: a row measured or painted before its result
+    // arrives is shaped there as usual, and the result is dropped.
+    bool prefetchLayouts(const QList<ChatMessage>& messages, const QAbstractItemView* view,
+                         std::function<void()> done = {}) const;
+
+    // Drops cached text layouts and bubble pixmaps
+    void clearCache();
+
+    // Wraps text as if rows were this wide instead of following the
+    // viewport; 0 follows the viewport again. The view must be laid out
+    // again after a change.
+    void setLayoutWidth(int width);
+
+private:
+    struct BubbleLayout {
+        QRect bubbleRect;
+        QRect contentRect;
+        QRect timestampRect;
+    };
+
+    // Content is implicitly shared with the model, so keys do not copy text
+    struct TextKey {
+        QString content;
+        int textWidth;
+        bool operator==(const TextKey& other) const
+        {
+            return textWidth == other.textWidth && content == other.content;
+        }
+        friend size_t qHash(const TextKey& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.content, key.textWidth);
+        }
+    };
+    struct PixmapKey {
+        TextKey text;
+        qint64 timestampMs;
+        bool isMe;
+        ChatMessage::SendState sendState;
+        int dprPercent;
+        bool operator==(const PixmapKey& other) const
+        {
+            return timestampMs == other.timestampMs && isMe == other.isMe &&
+                   sendState == other.sendState && dprPercent == other.dprPercent &&
+                   text == other.text;
+        }
+        friend size_t qHash(const PixmapKey& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.text, key.timestampMs, key.isMe,
+                              int(key.sendState), key.dprPercent);
+        }
+    };
+    // A prefetchLayouts() caller waiting for its page
+    struct Waiter {
+        QSet<TextKey> remaining;
+        std::function<void()> done;
+    };
+
+    int availableWidth(const QStyleOptionViewItem& option) const;
+    int wrapWidthForRow(const QRect& rowRect) const;
+    QFont contentFont(const QStyleOptionViewItem& option) const;
+    QFont timestampFont(const QStyleOptionViewItem& option) const;
+    void checkFont(const QStyleOptionViewItem& option) const;
+    void dropCaches() const;
+    // GUI thread; takes ownership of shaped
+    void adoptShaped(const QList<QString>& contents, const QList<QTextLayout*>& shaped,
+                     int textWidth, quint64 generation) const;
+    // Valid until the next cache insertion
+    const QTextLayout* shapedText(const QStyleOptionViewItem& option, const QString& content,
+                                  int textWidth) const;
+    BubbleLayout layoutBubble(const QStyleOptionViewItem& option, const QRect& rowRect,
+                              const QString& content, bool isMe) const;
+    void drawBubble(QPainter* painter, const QStyleOptionViewItem& option,
+                    const BubbleLayout& layout, const QString& content,
+                    const QDateTime& timestamp, bool isMe,
+                    ChatMessage::SendState sendState) const;
+    QPixmap renderBubble(const QStyleOptionViewItem& option, const BubbleLayout& layout,
+                         const QString& content, const QDateTime& timestamp, bool isMe,
+                         ChatMessage::SendState sendState, qreal dpr) const;
+
+    mutable QFont m_cachedFont;
+    mutable int m_timestampHeight;
+    mutable QCache<TextKey, QTextLayout> m_textCache;
+    mutable QCache<PixmapKey, QPixmap> m_pixmapCache;  // Cost in KiB
+    mutable QSet<TextKey> m_shaping;  // Being shaped on the pool
+    mutable QList<Waiter> m_waiters;
+    mutable quint64 m_cacheGeneration;  // Results of an older one are dropped
+    int m_layoutWidth;  // Pinned row width, or 0 to follow the row
+};
@@ -0,0 +1,100 @@
+#include "MessageListModel.h"
+
+MessageListModel::MessageListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int MessageListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_messages.size();
+}
+
+QVariant MessageListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_messages.size()) {
+        return QVariant();
+    }
+
+    const Message& message = m_messages.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case ContentRole:
+        return message.content;
+    case SenderRole:
+        return message.sender;
+    case TimestampRole:
+        return message.timestamp;
+    case IsMeRole:
+        return message.isMe;
+    case SendStateRole:
+        return int(message.sendState);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MessageListModel::roleNames() const
+{
+    return {
+        {SenderRole, "sender"},
+        {ContentRole, "content"},
+        {TimestampRole, "timestamp"},
+        {IsMeRole, "isMe"},
+        {SendStateRole, "sendState"},
+    };
+}
+
+void MessageListModel::setSendState(int row, ChatMessage::SendState state)
+{
+    if (row < 0 || row >= m_messages.size() || m_messages.at(row).sendState == state) {
+        return;
+    }
+    m_messages[row].sendState = state;
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, {SendStateRole});
+}
+
+void MessageListModel::appendMessage(const Message& message)
+{
+    const int row = m_messages.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_messages.append(message);
+    endInsertRows();
+}
+
+void MessageListModel::appendMessages(const QList<Message>& messages)
+{
+    if (messages.isEmpty()) return;
+
+    const int first = m_messages.size();
+    beginInsertRows(QModelIndex(), first, first + messages.size() - 1);
+    m_messages.append(messages);
+    endInsertRows();
+}
+
+void MessageListModel::prependMessages(const QList<Message>& messages)
+{
+    if (messages.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), 0, messages.size() - 1);
+    m_messages = messages + m_messages;
+    endInsertRows();
+}
+
+void MessageListModel::setMessages(const QList<Message>& messages)
+{
+    beginResetModel();
+    m_messages = messages;
+    endResetModel();
+}
+
+void MessageListModel::clear()
+{
+    if (m_messages.isEmpty()) return;
+
+    beginResetModel();
+    m_messages.clear();
+    endResetModel();
+}
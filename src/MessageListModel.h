@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include "ChatMessage.h"
+
+/**
+ * Flat list model backing the chat timeline.
+ *
+ * Messages are plain value records; the view only asks for the rows that are
+ * currently visible, so memory per message is the record itself rather than
+ * a widget tree.
+ */
+class MessageListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        SenderRole = Qt::UserRole + 1,
+        ContentRole,
+        TimestampRole,
+        IsMeRole,
+        SendStateRole  // int(ChatMessage::SendState)
+    };
+
+    using Message = ChatMessage;
+
+    explicit MessageListModel(QObject* parent = nullptr);
+    ~MessageListModel() = default;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void appendMessage(const Message& message);
+    void appendMessages(const QList<Message>& messages);
+    void prependMessages(const QList<Message>& messages);
+    void setMessages(const QList<Message>& messages);
+    void clear();
+    void setSendState(int row, ChatMessage::SendState state);
+
+    const Message& messageAt(int row) const { return m_messages.at(row); }
+    const QList<Message>& messages() const { return m_messages; }
+
+private:
+    QList<Message> m_messages;
+};
@@ -0,0 +1,847 @@
+#include "MessageStore.h"
+#include "ChatLogging.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QtEndian>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kManifestName[] = "conversations.json";
+
+// Index file: 16-byte header, then one 16-byte entry per message
+constexpr quint32 kIndexMagic = 0x58495343; // "CSIX"
+constexpr quint32 kIndexVersion = 1;
+constexpr qint64 kIndexHeaderSize = 16;
+constexpr qint64 kIndexEntrySize = 16;
+
+// Segment record: u32 payload length, then i64 timestamp (ms), u8 flags,
+// u16 sender length, sender UTF-8, content UTF-8
+constexpr qint64 kRecordHeaderSize = 4 + 8 + 1 + 2;
+constexpr qint64 kRecordFlagsOffset = 12;
+// Flags: isMe, then ChatMessage::SendState in two bits (0, Sent, in records
+// written before send state was kept)
+constexpr quint8 kFlagIsMe = 0x01;
+constexpr quint8 kSendStateShift = 1;
+constexpr quint8 kSendStateMask = 0x06;
+
+quint8 recordFlags(bool isMe, ChatMessage::SendState state)
+{
+    return static_cast<quint8>((isMe ? kFlagIsMe : 0) |
+                               ((quint8(state) << kSendStateShift) & kSendStateMask));
+}
+
+// Write-behind: wait this long after the first pending record so that a
+// burst is written (and fsynced) as one batch
+constexpr unsigned long kWriteDelayMs = 50;
+constexpr qint64 kMaxBatchRecords = 4096;
+// Last-activity changes alone rewrite the manifest at most this often;
+// other manifest changes go out with the next batch
+constexpr qint64 kActivityWriteIntervalMs = 5000;
+// A failed batch is retried after this long, doubling up to the maximum
+constexpr unsigned long kRetryDelayMs = 1000;
+constexpr unsigned long kMaxRetryDelayMs = 30000;
+
+constexpr int kMaxReadHandles = 32;
+
+QString stemFor(const QString& conversationId)
+{
+    return QString::fromLatin1(
+        QCryptographicHash::hash(conversationId.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+bool syncFile(QFile& file)
+{
+    if (!file.flush()) return false;
+#if defined(Q_OS_LINUX)
+    return ::fdatasync(file.handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    return ::fsync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+// Whether the index starts with a header this version writes
+bool hasValidHeader(QFile& index)
+{
+    uchar header[kIndexHeaderSize];
+    if (!index.seek(0) ||
+        index.read(reinterpret_cast<char*>(header), kIndexHeaderSize) != kIndexHeaderSize) {
+        return false;
+    }
+    return qFromLittleEndian<quint32>(header) == kIndexMagic &&
+           qFromLittleEndian<quint32>(header + 4) == kIndexVersion;
+}
+
+// Moves a conversation's files out of the way, keeping them for recovery
+bool setAside(const QDir& dir, const QString& stem)
+{
+    const QString suffix =
+        QString(".damaged-%1").arg(QDateTime::currentMSecsSinceEpoch());
+    for (const char* extension : {".idx", ".seg"}) {
+        const QString path = dir.filePath(stem + extension);
+        if (QFile::exists(path) && !QFile::rename(path, path + suffix)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Number of index entries whose records fit in a segment of segmentSize
+// bytes; drops entries written ahead of a segment that was cut short
+qint64 validIndexEntries(QFile& index, qint64 segmentSize)
+{
+    qint64 entries = qMax<qint64>(0, (index.size() - kIndexHeaderSize) / kIndexEntrySize);
+    while (entries > 0) {
+        uchar entry[kIndexEntrySize];
+        if (!index.seek(kIndexHeaderSize + (entries - 1) * kIndexEntrySize) ||
+            index.read(reinterpret_cast<char*>(entry), kIndexEntrySize) != kIndexEntrySize) {
+            return 0;
+        }
+        const quint64 offset = qFromLittleEndian<quint64>(entry);
+        const quint32 length = qFromLittleEndian<quint32>(entry + 8);
+        if (static_cast<qint64>(offset + length) <= segmentSize) break;
+        --entries;
+    }
+    return entries;
+}
+
+} // namespace
+
+// Mapped files of one conversation. Reads hold mutex rather than the
+// store's lock, so page faults and decoding never hold up the writer.
+struct MessageStore::ReadHandle {
+    QMutex mutex;  // Guards everything below
+    QFile segment;
+    QFile index;
+    const uchar* segmentMap = nullptr;
+    qint64 segmentMapSize = 0;
+    const uchar* indexMap = nullptr;
+    qint64 indexEntries = 0;
+
+    ~ReadHandle() {
+        // QFile::close() drops the mappings
+        segment.close();
+        index.close();
+    }
+
+    bool ensureMapped(qint64 entriesNeeded) {
+        if (indexMap && indexEntries >= entriesNeeded) return true;
+
+        if (!index.isOpen() && !index.open(QIODevice::ReadOnly)) return false;
+        if (!segment.isOpen() && !segment.open(QIODevice::ReadOnly)) return false;
+
+        if (indexMap) index.unmap(const_cast<uchar*>(indexMap));
+        if (segmentMap) segment.unmap(const_cast<uchar*>(segmentMap));
+        indexMap = nullptr;
+        segmentMap = nullptr;
+
+        const qint64 indexSize = index.size();
+        segmentMapSize = segment.size();
+        if (indexSize <= kIndexHeaderSize || segmentMapSize <= 0) return false;
+
+        indexMap = index.map(0, indexSize);
+        segmentMap = segment.map(0, segmentMapSize);
+        if (!indexMap || !segmentMap) return false;
+
+        indexEntries = (indexSize - kIndexHeaderSize) / kIndexEntrySize;
+        return indexEntries >= entriesNeeded;
+    }
+};
+
+MessageStore::MessageStore()
+    : m_persistent(false)
+    , m_appendSequence(0)
+    , m_writtenSequence(0)
+    , m_pendingRecords(0)
+    , m_manifestDirty(false)
+    , m_activityDirty(false)
+    , m_flushRequested(false)
+    , m_writeFailing(false)
+    , m_writerIdle(false)
+    , m_stopping(false)
+    , m_writer(nullptr)
+{
+}
+
+MessageStore::~MessageStore()
+{
+    if (m_writer) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_writeRequested.wakeAll();
+        }
+        m_writer->wait();
+        delete m_writer;
+        m_writer = nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_readHandles.clear();
+    m_readOrder.clear();
+}
+
+bool MessageStore::open(const QString& directory)
+{
+    QDir dir(directory);
+    if (!dir.mkpath(".")) {
+        qCWarning(lcStore) << "MessageStore: cannot create" << directory << "- history stays in memory";
+        return false;
+    }
+
+    QHash<QString, ConversationState> restored;
+    // The manifest is only rewritten if open() changes what it describes
+    bool manifestChanged = false;
+
+    QFile manifest(dir.filePath(kManifestName));
+    if (manifest.exists()) {
+        if (!manifest.open(QIODevice::ReadOnly)) {
+            qCWarning(lcStore) << "MessageStore: cannot read" << manifest.fileName();
+            return false;
+        }
+        // A damaged manifest is left as it is; writing a new one would drop
+        // every conversation it lists
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(manifest.readAll(), &error);
+        if (error.error != QJsonParseError::NoError || !document.isArray()) {
+            qCWarning(lcStore) << "MessageStore:" << manifest.fileName() << "is damaged ("
+                               << (document.isNull() ? error.errorString() : "not an array")
+                               << ") - history stays in memory";
+            return false;
+        }
+        const QJsonArray entries = document.array();
+        for (const QJsonValue& value : entries) {
+            const QJsonObject obj = value.toObject();
+            const QString id = obj["id"].toString();
+            if (id.isEmpty()) continue;
+
+            ConversationState state;
+            state.id = id;
+            state.stem = stemFor(id);
+            state.name = obj["name"].toString();
+            state.peerId = obj["peerId"].toString();
+            state.lastActivity = QDateTime::fromMSecsSinceEpoch(
+                static_cast<qint64>(obj["lastActivity"].toDouble()));
+            state.pinned = obj["pinned"].toBool();
+            state.hasMeta = !state.name.isEmpty();
+
+            // Only the index is looked at; bodies are read on demand. A
+            // shorter index than a header is a conversation whose first
+            // write was cut short, and gets a new header with the next one.
+            QFile index(dir.filePath(state.stem + ".idx"));
+            if (index.open(QIODevice::ReadOnly) && index.size() >= kIndexHeaderSize) {
+                if (hasValidHeader(index)) {
+                    state.durableCount = validIndexEntries(
+                        index, QFileInfo(dir.filePath(state.stem + ".seg")).size());
+                } else {
+                    index.close();
+                    qCWarning(lcStore) << "MessageStore:" << index.fileName()
+                                       << "has no valid header - its history is set aside";
+                    if (!setAside(dir, state.stem)) {
+                        qCWarning(lcStore) << "MessageStore: cannot move" << index.fileName()
+                                           << "aside - history stays in memory";
+                        return false;
+                    }
+                    manifestChanged = true;
+                }
+            }
+            restored.insert(id, state);
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_directory = dir.absolutePath();
+
+    // Anything appended before open() is written out with the first batch
+    for (auto it = m_conversations.begin(); it != m_conversations.end(); ++it) {
+        auto existing = restored.find(it->id);
+        if (existing != restored.end()) {
+            it->durableCount = existing->durableCount;
+            if (!it->hasMeta) {
+                it->name = existing->name;
+                it->peerId = existing->peerId;
+                it->lastActivity = existing->lastActivity;
+                it->pinned = existing->pinned;
+                it->hasMeta = existing->hasMeta;
+            }
+            restored.erase(existing);
+        } else {
+            // Only known in memory so far
+            manifestChanged = true;
+        }
+    }
+    m_conversations.reserve(m_conversations.size() + restored.size());
+    for (auto it = restored.begin(); it != restored.end(); ++it) {
+        m_keys.insert(it.key(), ConversationKey(m_conversations.size()));
+        m_conversations.append(it.value());
+    }
+
+    m_persistent = true;
+    m_manifestDirty = m_manifestDirty || manifestChanged;
+    m_manifestWritten.start();
+    m_writer = QThread::create([this]() { writerLoop(); });
+    m_writer->setObjectName("MessageStoreWriter");
+    m_writer->start(QThread::LowPriority);
+    if (m_pendingRecords > 0 || m_manifestDirty) {
+        scheduleWrite();
+    }
+    return true;
+}
+
+bool MessageStore::isPersistent() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_persistent;
+}
+
+QList<MessageStore::ConversationMeta> MessageStore::conversations() const
+{
+    QList<ConversationMeta> result;
+    {
+        QMutexLocker locker(&m_mutex);
+        result.reserve(m_conversations.size());
+        for (auto it = m_conversations.constBegin(); it != m_conversations.constEnd(); ++it) {
+            if (!it->hasMeta) continue;
+            result.append({it->id, it->name, it->peerId, it->lastActivity,
+                           it->durableCount + it->pending.size(), it->pinned});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const ConversationMeta& a, const ConversationMeta& b) {
+        return a.lastActivity > b.lastActivity;
+    });
+    return result;
+}
+
+MessageStore::ConversationKey MessageStore::keyFor(const QString& conversationId)
+{
+    // Called with m_mutex held. One lookup: operator[] inserts a new id,
+    // which the size change gives away
+    const auto size = m_keys.size();
+    ConversationKey& key = m_keys[conversationId];
+    if (m_keys.size() != size) {
+        key = ConversationKey(m_conversations.size());
+        ConversationState state;
+        state.id = conversationId;
+        state.stem = stemFor(conversationId);
+        m_conversations.append(state);
+    }
+    return key;
+}
+
+MessageStore::ConversationState* MessageStore::findState(const QString& conversationId)
+{
+    auto it = m_keys.constFind(conversationId);
+    return it == m_keys.constEnd() ? nullptr : &m_conversations[it.value()];
+}
+
+const MessageStore::ConversationState* MessageStore::findState(
+    const QString& conversationId) const
+{
+    auto it = m_keys.constFind(conversationId);
+    return it == m_keys.constEnd() ? nullptr : &m_conversations[it.value()];
+}
+
+MessageStore::ConversationKey MessageStore::conversationKey(const QString& conversationId)
+{
+    QMutexLocker locker(&m_mutex);
+    return keyFor(conversationId);
+}
+
+void MessageStore::upsertConversation(const QString& id, const QString& name,
+                                      const QString& peerId, const QDateTime& lastActivity)
+{
+    QMutexLocker locker(&m_mutex);
+    ConversationState& state = m_conversations[keyFor(id)];
+    state.name = name;
+    state.peerId = peerId;
+    state.lastActivity = lastActivity;
+    state.hasMeta = !name.isEmpty();
+    m_manifestDirty = true;
+    scheduleWrite();
+}
+
+void MessageStore::touchConversation(const QString& id, const QDateTime& lastActivity)
+{
+    QMutexLocker locker(&m_mutex);
+    ConversationState* state = findState(id);
+    if (!state) return;
+    state->lastActivity = lastActivity;
+    // Written by the writer once kActivityWriteIntervalMs has passed, or
+    // with the next manifest change, flush or close
+    if (!m_activityDirty) {
+        m_activityDirty = true;
+        m_writeRequested.wakeAll();
+    }
+}
+
+void MessageStore::setConversationPinned(const QString& id, bool pinned)
+{
+    QMutexLocker locker(&m_mutex);
+    ConversationState* state = findState(id);
+    if (!state || state->pinned == pinned) return;
+    state->pinned = pinned;
+    m_manifestDirty = true;
+    scheduleWrite();
+}
+
+qint64 MessageStore::append(const QString& conversationId, const ChatMessage& message)
+{
+    QMutexLocker locker(&m_mutex);
+    ConversationState& state = m_conversations[keyFor(conversationId)];
+    state.pending.append(message);
+    ++m_pendingRecords;
+    scheduleWrite();
+    return state.durableCount + state.pending.size() - 1;
+}
+
+qint64 MessageStore::append(ConversationKey key, const ChatMessage& message)
+{
+    QMutexLocker locker(&m_mutex);
+    Q_ASSERT(key >= 0 && key < m_conversations.size());
+    ConversationState& state = m_conversations[key];
+    state.pending.append(message);
+    ++m_pendingRecords;
+    scheduleWrite();
+    return state.durableCount + state.pending.size() - 1;
+}
+
+void MessageStore::setSendState(const QString& conversationId, qint64 row,
+                                ChatMessage::SendState state)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_keys.constFind(conversationId);
+    if (it == m_keys.constEnd()) return;
+    ConversationState& conversation = m_conversations[it.value()];
+
+    const qint64 pendingIndex = row - conversation.durableCount;
+    if (pendingIndex >= 0 && pendingIndex < conversation.pending.size()) {
+        conversation.pending.setSendStateAt(int(pendingIndex), state);
+    }
+    // Also queued for a pending row: a batch in progress may be writing it
+    // with the state it had before
+    if (m_persistent) {
+        m_sendStateUpdates.append({it.value(), conversation.stem, row, state});
+        scheduleWrite();
+    }
+}
+
+qint64 MessageStore::messageCount(const QString& conversationId) const
+{
+    QMutexLocker locker(&m_mutex);
+    const ConversationState* state = findState(conversationId);
+    if (!state) return 0;
+    return state->durableCount + state->pending.size();
+}
+
+QList<ChatMessage> MessageStore::readMessages(const QString& conversationId, qint64 first,
+                                              qint64 count) const
+{
+    QList<ChatMessage> result;
+    QList<ChatMessage> pending;
+    std::shared_ptr<ReadHandle> handle;
+    qint64 durableEnd = 0;
+    {
+        // Durable rows come from the mapped files, the rest from memory. Only
+        // the counts, the handle and the in-memory rows are taken under the
+        // lock; rows already durable cannot change until the writer next
+        // grows the files, which a remap picks up.
+        QMutexLocker locker(&m_mutex);
+        const ConversationState* found = findState(conversationId);
+        if (!found) return result;
+
+        const ConversationState& state = *found;
+        const qint64 total = state.durableCount + state.pending.size();
+        first = qBound<qint64>(0, first, total);
+        const qint64 last = qMin(total, first + qMax<qint64>(0, count));
+        durableEnd = qMin(last, state.durableCount);
+        if (first < durableEnd) {
+            handle = readHandle(conversationId, state);
+        }
+        const qint64 pendingFirst = qMax(first, state.durableCount);
+        pending.reserve(qMax<qint64>(0, last - pendingFirst));
+        for (qint64 row = pendingFirst; row < last; ++row) {
+            pending.append(state.pending.at(row - state.durableCount));
+        }
+    }
+
+    if (handle) {
+        result.reserve(durableEnd - first + pending.size());
+        if (!readDurable(handle.get(), first, durableEnd - first, &result)) {
+            qCWarning(lcStore) << "MessageStore: failed to read history for" << conversationId;
+        }
+    }
+    result.append(pending);
+    return result;
+}
+
+void MessageStore::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_activityDirty) {
+        ++m_appendSequence;
+    }
+    const quint64 target = m_appendSequence;
+    const quint64 batches = m_stats.batches;
+    m_flushRequested = true;
+    m_writeRequested.wakeAll();
+    // While writes fail, one more attempt is all that is waited for
+    while (m_persistent && m_writer && m_writtenSequence < target &&
+           !(m_writeFailing && m_stats.batches > batches)) {
+        m_writeDone.wait(&m_mutex);
+    }
+}
+
+MessageStore::Stats MessageStore::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+// ============================================================================
+// Writer thread
+// ============================================================================
+
+void MessageStore::scheduleWrite()
+{
+    // Called with m_mutex held. The writer is only woken when it is idle
+    // (start of a batch window) or when the backlog is large enough
+    ++m_appendSequence;
+    if (m_writer && (m_writerIdle || m_pendingRecords >= kMaxBatchRecords)) {
+        m_writeRequested.wakeAll();
+    }
+}
+
+void MessageStore::writerLoop()
+{
+    QMutexLocker locker(&m_mutex);
+    unsigned long retryDelayMs = kRetryDelayMs;
+    while (true) {
+        m_writerIdle = true;
+        while (!m_stopping && m_appendSequence == m_writtenSequence) {
+            if (!m_activityDirty) {
+                m_writeRequested.wait(&m_mutex);
+                continue;
+            }
+            const qint64 dueInMs = kActivityWriteIntervalMs - m_manifestWritten.elapsed();
+            if (dueInMs <= 0) break;
+            m_writeRequested.wait(&m_mutex, static_cast<unsigned long>(dueInMs));
+        }
+        m_writerIdle = false;
+        if (m_appendSequence == m_writtenSequence && !m_activityDirty) break;
+
+        // Group commit: give the burst a moment to accumulate
+        if (!m_stopping && !m_flushRequested && m_pendingRecords < kMaxBatchRecords &&
+            m_appendSequence != m_writtenSequence) {
+            m_writeRequested.wait(&m_mutex, kWriteDelayMs);
+        }
+        const bool flushing = m_flushRequested;
+        m_flushRequested = false;
+
+        // Snapshot under the lock, write without it
+        QVector<WriteItem> batch;
+        for (int key = 0; key < m_conversations.size(); ++key) {
+            const ConversationState& state = m_conversations.at(key);
+            if (!state.pending.isEmpty()) {
+                batch.append({key, state.stem, state.durableCount, state.pending});
+            }
+        }
+        QJsonArray manifest;
+        const bool activityDue = m_activityDirty &&
+            (m_stopping || flushing ||
+             m_manifestWritten.hasExpired(kActivityWriteIntervalMs));
+        const bool writeManifestNow = m_manifestDirty || activityDue;
+        if (writeManifestNow) {
+            for (auto it = m_conversations.constBegin(); it != m_conversations.constEnd(); ++it) {
+                manifest.append(QJsonObject{
+                    {"id", it->id},
+                    {"name", it->name},
+                    {"peerId", it->peerId},
+                    {"lastActivity", static_cast<double>(it->lastActivity.toMSecsSinceEpoch())},
+                    {"pinned", it->pinned},
+                });
+            }
+            m_manifestDirty = false;
+            m_activityDirty = false;
+            m_manifestWritten.start();
+        }
+        // Only rows already on disk; the rest wait for a later batch
+        QHash<QString, QVector<SendStateUpdate>> stateUpdates;
+        for (auto it = m_sendStateUpdates.begin(); it != m_sendStateUpdates.end();) {
+            if (it->row < m_conversations.at(it->key).durableCount) {
+                stateUpdates[it->stem].append(*it);
+                it = m_sendStateUpdates.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        const quint64 sequence = m_appendSequence;
+        const QString directory = m_directory;
+        locker.unlock();
+
+        QElapsedTimer batchTimer;
+        batchTimer.start();
+        quint64 written = 0;
+        quint64 fsyncs = 0;
+        QVector<bool> succeeded(batch.size(), false);
+        bool ok = true;
+        for (int i = 0; i < batch.size() && ok; ++i) {
+            succeeded[i] = appendToFiles(directory, batch[i]);
+            ok = succeeded[i];
+            if (ok) {
+                written += batch[i].messages.size();
+                fsyncs += 2;
+            }
+        }
+        for (auto it = stateUpdates.constBegin(); ok && it != stateUpdates.constEnd(); ++it) {
+            if (writeSendStates(directory, it.key(), it.value())) {
+                ++fsyncs;
+            } else {
+                // The message itself is safe; only its state is stale
+                qCWarning(lcStore) << "MessageStore: could not update send state in"
+                                   << it.key() + ".seg";
+            }
+        }
+        const bool recordsWritten = ok;
+        if (ok && writeManifestNow) {
+            ok = writeManifest(directory, manifest);
+        }
+        const qint64 batchNs = batchTimer.nsecsElapsed();
+
+        locker.relock();
+        for (int i = 0; i < batch.size(); ++i) {
+            if (!succeeded[i]) continue;
+            ConversationState& state = m_conversations[batch[i].key];
+            const int count = batch[i].messages.size();
+            state.durableCount += count;
+            state.pending.removeFirst(count);
+            m_pendingRecords -= count;
+        }
+        m_stats.batches++;
+        m_stats.recordsWritten += written;
+        m_stats.fsyncs += fsyncs;
+        m_stats.lastBatchNs = batchNs;
+        m_stats.maxBatchNs = qMax(m_stats.maxBatchNs, batchNs);
+
+        if (!ok) {
+            // What was not written stays queued, readable from memory, and
+            // the batch is tried again after a pause
+            m_stats.failedBatches++;
+            if (writeManifestNow) {
+                m_manifestDirty = true;
+            }
+            if (!recordsWritten) {
+                QVector<SendStateUpdate> requeued;
+                for (auto it = stateUpdates.constBegin(); it != stateUpdates.constEnd(); ++it) {
+                    requeued += it.value();
+                }
+                m_sendStateUpdates = requeued + m_sendStateUpdates;
+            }
+            if (!m_writeFailing) {
+                qCWarning(lcStore) << "MessageStore: write to" << directory
+                                   << "failed - keeping history in memory and retrying";
+                m_writeFailing = true;
+            }
+            m_writeDone.wakeAll();
+            if (m_stopping) {
+                qCWarning(lcStore) << "MessageStore:" << m_pendingRecords
+                                   << "messages could not be written to" << directory;
+                break;
+            }
+            m_writeRequested.wait(&m_mutex, retryDelayMs);
+            retryDelayMs = qMin(retryDelayMs * 2, kMaxRetryDelayMs);
+            continue;
+        }
+        if (m_writeFailing) {
+            qCInfo(lcStore) << "MessageStore: writes to" << directory << "resumed";
+            m_writeFailing = false;
+            retryDelayMs = kRetryDelayMs;
+        }
+
+        m_writtenSequence = sequence;
+        // Updates for rows this batch made durable
+        if (!m_sendStateUpdates.isEmpty()) {
+            ++m_appendSequence;
+        }
+        m_writeDone.wakeAll();
+    }
+}
+
+bool MessageStore::appendToFiles(const QString& directory, const WriteItem& item)
+{
+    const QDir dir(directory);
+    QFile segment(dir.filePath(item.stem + ".seg"));
+    QFile index(dir.filePath(item.stem + ".idx"));
+    if (!segment.open(QIODevice::ReadWrite) || !index.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // Index header for a new conversation; drop any entries past the
+    // durable count (left over from an interrupted write)
+    if (index.size() < kIndexHeaderSize) {
+        uchar header[kIndexHeaderSize] = {};
+        qToLittleEndian<quint32>(kIndexMagic, header);
+        qToLittleEndian<quint32>(kIndexVersion, header + 4);
+        if (!index.resize(0) ||
+            index.write(reinterpret_cast<const char*>(header), kIndexHeaderSize) != kIndexHeaderSize) {
+            return false;
+        }
+    }
+    const qint64 indexEnd = kIndexHeaderSize + item.durableCount * kIndexEntrySize;
+    if (index.size() != indexEnd && !index.resize(indexEnd)) {
+        return false;
+    }
+
+    qint64 offset = segment.size();
+    QByteArray records;
+    QByteArray entries(item.messages.size() * kIndexEntrySize, Qt::Uninitialized);
+    uchar* entry = reinterpret_cast<uchar*>(entries.data());
+
+    // The arena already holds UTF-8, so records are copied, not converted
+    for (int i = 0; i < item.messages.size(); ++i) {
+        const QByteArrayView sender = item.messages.senderUtf8At(i);
+        const QByteArrayView content = item.messages.contentUtf8At(i);
+        const quint16 senderLength = static_cast<quint16>(qMin<qsizetype>(sender.size(), 0xFFFF));
+        const quint32 payloadLength = static_cast<quint32>(
+            kRecordHeaderSize - 4 + senderLength + content.size());
+
+        uchar header[kRecordHeaderSize];
+        qToLittleEndian<quint32>(payloadLength, header);
+        qToLittleEndian<qint64>(item.messages.timestampMsAt(i), header + 4);
+        header[kRecordFlagsOffset] =
+            recordFlags(item.messages.isMeAt(i), item.messages.sendStateAt(i));
+        qToLittleEndian<quint16>(senderLength, header + 13);
+
+        records.append(reinterpret_cast<const char*>(header), kRecordHeaderSize);
+        records.append(sender.constData(), senderLength);
+        records.append(content);
+
+        const quint32 recordLength = payloadLength + 4;
+        qToLittleEndian<quint64>(static_cast<quint64>(offset), entry);
+        qToLittleEndian<quint32>(recordLength, entry + 8);
+        qToLittleEndian<quint32>(0, entry + 12);
+        entry += kIndexEntrySize;
+        offset += recordLength;
+    }
+
+    // Segment first, then index: on open, entries pointing past the end of
+    // the segment are discarded
+    if (!segment.seek(segment.size()) || segment.write(records) != records.size()) return false;
+    if (!index.seek(indexEnd) || index.write(entries) != entries.size()) return false;
+    return syncFile(segment) && syncFile(index);
+}
+
+bool MessageStore::writeSendStates(const QString& directory, const QString& stem,
+                                   const QVector<SendStateUpdate>& updates)
+{
+    const QDir dir(directory);
+    QFile segment(dir.filePath(stem + ".seg"));
+    QFile index(dir.filePath(stem + ".idx"));
+    if (!segment.open(QIODevice::ReadWrite) || !index.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Only outgoing messages change state, so the flags are rewritten whole
+    for (const SendStateUpdate& update : updates) {
+        uchar entry[8];
+        if (!index.seek(kIndexHeaderSize + update.row * kIndexEntrySize) ||
+            index.read(reinterpret_cast<char*>(entry), sizeof(entry)) != qint64(sizeof(entry))) {
+            return false;
+        }
+        const qint64 offset = static_cast<qint64>(qFromLittleEndian<quint64>(entry));
+        const char flags = static_cast<char>(recordFlags(true, update.state));
+        if (!segment.seek(offset + kRecordFlagsOffset) || !segment.putChar(flags)) {
+            return false;
+        }
+    }
+    return syncFile(segment);
+}
+
+bool MessageStore::writeManifest(const QString& directory, const QJsonArray& manifest)
+{
+    QSaveFile file(QDir(directory).filePath(kManifestName));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+// ============================================================================
+// Reads
+// ============================================================================
+
+std::shared_ptr<MessageStore::ReadHandle> MessageStore::readHandle(
+    const QString& conversationId, const ConversationState& state) const
+{
+    auto it = m_readHandles.find(conversationId);
+    if (it != m_readHandles.end()) {
+        m_readOrder.removeOne(conversationId);
+        m_readOrder.append(conversationId);
+        return it.value();
+    }
+
+    // Keep a bounded number of mapped conversations open
+    while (m_readOrder.size() >= kMaxReadHandles) {
+        m_readHandles.remove(m_readOrder.takeFirst());
+    }
+
+    auto handle = std::make_shared<ReadHandle>();
+    const QDir dir(m_directory);
+    handle->segment.setFileName(dir.filePath(state.stem + ".seg"));
+    handle->index.setFileName(dir.filePath(state.stem + ".idx"));
+    m_readHandles.insert(conversationId, handle);
+    m_readOrder.append(conversationId);
+    return handle;
+}
+
+bool MessageStore::readDurable(ReadHandle* handle, qint64 first, qint64 count,
+                               QList<ChatMessage>* out)
+{
+    // Another reader of the same conversation may remap meanwhile
+    QMutexLocker locker(&handle->mutex);
+    if (!handle->ensureMapped(first + count)) return false;
+
+    for (qint64 row = first; row < first + count; ++row) {
+        const uchar* entry = handle->indexMap + kIndexHeaderSize + row * kIndexEntrySize;
+        const qint64 offset = static_cast<qint64>(qFromLittleEndian<quint64>(entry));
+        const qint64 length = qFromLittleEndian<quint32>(entry + 8);
+        // Both files are mapped after the rows became durable, so a record
+        // outside the mapping means the files were damaged
+        if (length < kRecordHeaderSize || offset + length > handle->segmentMapSize) {
+            return false;
+        }
+
+        const uchar* record = handle->segmentMap + offset;
+        const quint16 senderLength = qFromLittleEndian<quint16>(record + 13);
+        const qint64 contentLength = length - kRecordHeaderSize - senderLength;
+        if (contentLength < 0) return false;
+
+        ChatMessage message;
+        message.timestamp = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(record + 4));
+        message.isMe = (record[kRecordFlagsOffset] & kFlagIsMe) != 0;
+        message.sendState = static_cast<ChatMessage::SendState>(
+            (record[kRecordFlagsOffset] & kSendStateMask) >> kSendStateShift);
+        message.sender = QString::fromUtf8(
+            reinterpret_cast<const char*>(record + kRecordHeaderSize), senderLength);
+        message.content = QString::fromUtf8(
+            reinterpret_cast<const char*>(record + kRecordHeaderSize + senderLength),
+            contentLength);
+        out->append(message);
+    }
+    return true;
+}
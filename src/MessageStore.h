@@ -0,0 +1,180 @@
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <memory>
+#include "ChatMessage.h"
+#include "MessageArena.h"
+
+class QJsonArray;
+class QThread;
+
+/**
+ * On-disk message history.
+ *
+ * Layout under the store directory:
+ *   conversations.json   conversation metadata (id, name, peer, last activity, pinned)
+ *   <stem>.seg           append-only message records for one conversation
+ *   <stem>.idx           fixed-size offset index into the segment, mmapped
+ *
+ * open() only reads the manifest and stats the index files, so startup cost
+ * does not depend on history size; message bodies are read on demand.
+ * append() never blocks on disk: records are queued and a writer thread
+ * writes them in batches with one fsync per touched file per batch.
+ * Records are readable immediately, from memory until they are durable.
+ * Reads hold the store's lock only to take the counts and the in-memory
+ * rows; mapped files are paged in and decoded outside it.
+ * In memory they are kept packed in a MessageArena per conversation.
+ * The manifest is rewritten with the batch after a conversation is added,
+ * renamed or pinned; last-activity updates alone are written at most every
+ * 5 seconds, and on flush() and close.
+ * The send state of outgoing messages is kept in each record's flags;
+ * setSendState() changes it in memory at once and on disk with the next
+ * batch, in place.
+ *
+ * open() checks the manifest and each index header. A damaged manifest
+ * makes open() fail without touching any file; a damaged index is renamed
+ * aside with its segment and the conversation starts an empty history.
+ * If open() fails (or is never called) the store keeps everything in
+ * memory, which matches the previous ephemeral behaviour. A batch that
+ * fails to write stays queued in memory and is retried, backing off from
+ * 1 to 30 seconds; it is not given up on until the store is destroyed.
+ */
+class MessageStore {
+public:
+    struct ConversationMeta {
+        QString id;
+        QString name;
+        QString peerId;
+        QDateTime lastActivity;
+        qint64 messageCount = 0;
+        bool pinned = false;
+    };
+
+    struct Stats {
+        quint64 batches = 0;
+        quint64 recordsWritten = 0;
+        quint64 fsyncs = 0;
+        quint64 failedBatches = 0;  // Each was kept in memory and retried
+        qint64 lastBatchNs = 0;
+        qint64 maxBatchNs = 0;
+    };
+
+    MessageStore();
+    ~MessageStore();
+
+    MessageStore(const MessageStore&) = delete;
+    MessageStore& operator=(const MessageStore&) = delete;
+
+    bool open(const QString& directory);
+    bool isPersistent() const;
+    QString directory() const { return m_directory; }
+
+    // Conversations restored by open(), ordered by last activity (newest first)
+    QList<ConversationMeta> conversations() const;
+
+    void upsertConversation(const QString& id, const QString& name, const QString& peerId,
+                            const QDateTime& lastActivity);
+    void touchConversation(const QString& id, const QDateTime& lastActivity);
+    void setConversationPinned(const QString& id, bool pinned);
+
+    // Interned conversation id, valid for the store's lifetime; creates the
+    // conversation if it is new
+    using ConversationKey = int;
+    ConversationKey conversationKey(const QString& conversationId);
+
+    // Returns the message's row in the conversation history
+    qint64 append(const QString& conversationId, const ChatMessage& message);
+    // Same, for a key from conversationKey(); the id is not hashed again
+    qint64 append(ConversationKey key, const ChatMessage& message);
+    // Records the delivery outcome of an outgoing message
+    void setSendState(const QString& conversationId, qint64 row, ChatMessage::SendState state);
+    qint64 messageCount(const QString& conversationId) const;
+    QList<ChatMessage> readMessages(const QString& conversationId, qint64 first,
+                                    qint64 count) const;
+
+    // Blocks until everything appended so far is written and synced, or
+    // until one more attempt has failed while the disk is failing
+    void flush();
+    Stats stats() const;
+
+private:
+    struct ReadHandle;
+
+    struct ConversationState {
+        QString id;
+        QString stem;
+        QString name;
+        QString peerId;
+        QDateTime lastActivity;
+        bool pinned = false;
+        bool hasMeta = false;
+        qint64 durableCount = 0;
+        MessageArena pending;  // All of the history when not persistent
+    };
+
+    // One conversation's share of a write batch, snapshotted under the lock
+    struct WriteItem {
+        ConversationKey key;
+        QString stem;
+        qint64 durableCount;
+        MessageArena messages;
+    };
+
+    // A send state to write into a record already on disk
+    struct SendStateUpdate {
+        ConversationKey key;
+        QString stem;
+        qint64 row;
+        ChatMessage::SendState state;
+    };
+
+    ConversationKey keyFor(const QString& conversationId);
+    ConversationState* findState(const QString& conversationId);
+    const ConversationState* findState(const QString& conversationId) const;
+    void scheduleWrite();
+    void writerLoop();
+    static bool appendToFiles(const QString& directory, const WriteItem& item);
+    static bool writeSendStates(const QString& directory, const QString& stem,
+                                const QVector<SendStateUpdate>& updates);
+    static bool writeManifest(const QString& directory, const QJsonArray& manifest);
+    // Called without m_mutex; the handle serializes its own mapping
+    static bool readDurable(ReadHandle* handle, qint64 first, qint64 count,
+                            QList<ChatMessage>* out);
+    // Under m_mutex; the handle stays valid after it leaves the LRU
+    std::shared_ptr<ReadHandle> readHandle(const QString& conversationId,
+                                           const ConversationState& state) const;
+
+    QString m_directory;
+    bool m_persistent;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_writeRequested;
+    QWaitCondition m_writeDone;
+    // Indexed by ConversationKey; conversations are never removed
+    QVector<ConversationState> m_conversations;
+    QHash<QString, ConversationKey> m_keys;
+    QVector<SendStateUpdate> m_sendStateUpdates;  // Applied once the row is durable
+    quint64 m_appendSequence;
+    quint64 m_writtenSequence;
+    qint64 m_pendingRecords;
+    bool m_manifestDirty;
+    bool m_activityDirty;  // Only last activity changed; written on a slower clock
+    QElapsedTimer m_manifestWritten;
+    bool m_flushRequested;
+    bool m_writeFailing;  // The last batch failed; warned once per streak
+    bool m_writerIdle;
+    bool m_stopping;
+    QThread* m_writer;
+    Stats m_stats;
+
+    // Read-side mappings, most recently used last (guarded by m_mutex)
+    mutable QList<QString> m_readOrder;
+    mutable QHash<QString, std::shared_ptr<ReadHandle>> m_readHandles;
+};
@@ -0,0 +1,328 @@
+#include "Outbox.h"
+#include "ChatLogging.h"
+#include "IChatBackend.h"
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+constexpr int kMaxAttempts = 5;
+// Messages of one conversation handed over before the first has its result
+constexpr int kMaxInFlight = 4;
+// Backoff doubles from kRetryBaseMs per failed attempt, up to kRetryMaxMs
+constexpr qint64 kRetryBaseMs = 500;
+constexpr qint64 kRetryMaxMs = 30000;
+// An accepted send with no result after this long is failed and retried
+constexpr qint64 kResultTimeoutMs = 15000;
+// Failed messages kept to answer stateOf(); by the time one is dropped the
+// store has long since written its state
+constexpr int kMaxFailedKept = 64;
+
+} // namespace
+
+Outbox::Outbox(IChatBackend* backend, QObject* parent)
+    : QObject(parent)
+    , m_backend(backend)
+    , m_senderThread(nullptr)
+    , m_sender(nullptr)
+    , m_retryTimer(nullptr)
+    , m_resultTimer(nullptr)
+    , m_nextClientId(1)
+{
+    m_clock.start();
+
+    if (m_backend->sendsFromAnyThread()) {
+        m_senderThread = new QThread(this);
+        m_senderThread->setObjectName("ChatSDKOutbox");
+        m_sender = new QObject();
+        m_sender->moveToThread(m_senderThread);
+        connect(m_senderThread, &QThread::finished, m_sender, &QObject::deleteLater);
+        m_senderThread->start();
+    } else {
+        m_sender = this;
+    }
+
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &Outbox::retryDue);
+
+    m_resultTimer = new QTimer(this);
+    m_resultTimer->setSingleShot(true);
+    connect(m_resultTimer, &QTimer::timeout, this, &Outbox::expireResults);
+}
+
+Outbox::~Outbox()
+{
+    shutdown();
+}
+
+void Outbox::shutdown()
+{
+    m_retryTimer->stop();
+    m_resultTimer->stop();
+    if (m_senderThread && m_senderThread->isRunning()) {
+        m_senderThread->quit();
+        m_senderThread->wait();
+    }
+}
+
+quint64 Outbox::enqueue(const QString& conversationId, qint64 row, const QString& contentHex)
+{
+    Entry entry;
+    entry.clientId = m_nextClientId++;
+    entry.conversationId = conversationId;
+    entry.row = row;
+    entry.contentHex = contentHex;
+    m_entries.insert(entry.clientId, entry);
+    m_rows[conversationId].insert(row, entry.clientId);
+    m_queues[conversationId].waiting.append(entry.clientId);
+
+    pump(conversationId);
+    return entry.clientId;
+}
+
+void Outbox::pump(const QString& conversationId)
+{
+    auto queueIt = m_queues.find(conversationId);
+    if (queueIt == m_queues.end()) return;
+
+    Queue& queue = queueIt.value();
+    const qint64 now = m_clock.elapsed();
+    while (queue.awaiting.size() < kMaxInFlight && !queue.waiting.isEmpty()) {
+        Entry& entry = m_entries[queue.waiting.first()];
+        // A retry holds back everything written after it, and goes out only
+        // once the sends already on their way have their results
+        if (entry.retryAtMs > now) {
+            scheduleRetryTimer();
+            break;
+        }
+        if (entry.attempts > 0 && !queue.awaiting.isEmpty()) break;
+        queue.waiting.removeFirst();
+        dispatch(queue, entry);
+    }
+
+    if (queue.waiting.isEmpty() && queue.awaiting.isEmpty()) {
+        m_queues.erase(queueIt);
+    }
+}
+
+void Outbox::dispatch(Queue& queue, Entry& entry)
+{
+    ++entry.attempts;
+    queue.awaiting.append(entry.clientId);
+
+    // Calls are made in the order they are queued here
+    const quint64 clientId = entry.clientId;
+    QMetaObject::invokeMethod(
+        m_sender,
+        [this, clientId, conversationId = entry.conversationId,
+         contentHex = entry.contentHex]() {
+            const bool accepted = m_backend->sendMessage(conversationId, contentHex, clientId);
+            QMetaObject::invokeMethod(
+                this, [this, clientId, accepted]() { onDispatched(clientId, accepted); },
+                Qt::QueuedConnection);
+        },
+        Qt::QueuedConnection);
+}
+
+void Outbox::onDispatched(quint64 clientId, bool accepted)
+{
+    // An accepted send is finished by its result event; a refused one gets none
+    auto entryIt = m_entries.find(clientId);
+    if (entryIt == m_entries.end() ||
+        !m_queues.value(entryIt->conversationId).awaiting.contains(clientId)) {
+        return;
+    }
+    if (!accepted) {
+        qCDebug(lcBackend) << "Outbox: sendMessage refused, message" << clientId;
+        finish(clientId, false);
+        return;
+    }
+    entryIt->resultDeadlineMs = m_clock.elapsed() + kResultTimeoutMs;
+    scheduleResultTimer();
+}
+
+void Outbox::handleResult(const QString& conversationId, quint64 clientId, bool success)
+{
+    if (clientId != 0) {
+        const auto entryIt = m_entries.constFind(clientId);
+        if (entryIt != m_entries.constEnd() &&
+            m_queues.value(entryIt->conversationId).awaiting.contains(clientId)) {
+            finish(clientId, success);
+        } else {
+            qCDebug(lcBackend) << "Outbox: send result for message" << clientId
+                               << "which awaits none";
+        }
+        return;
+    }
+
+    // Without an id, results are answered in send order per conversation
+    const Queue* match = nullptr;
+    if (!conversationId.isEmpty()) {
+        const auto queueIt = m_queues.constFind(conversationId);
+        if (queueIt != m_queues.constEnd() && !queueIt->awaiting.isEmpty()) {
+            match = &queueIt.value();
+        }
+    } else {
+        for (const Queue& queue : std::as_const(m_queues)) {
+            if (queue.awaiting.isEmpty()) continue;
+            if (match) {
+                qCWarning(lcBackend) << "Outbox: send result names no conversation while"
+                                     << "several await one; leaving it to the timeout";
+                return;
+            }
+            match = &queue;
+        }
+    }
+    if (!match) {
+        qCDebug(lcBackend) << "Outbox: send result with no message awaiting it"
+                           << conversationId;
+        return;
+    }
+    finish(match->awaiting.first(), success);
+}
+
+void Outbox::finish(quint64 clientId, bool success)
+{
+    auto entryIt = m_entries.find(clientId);
+    if (entryIt == m_entries.end()) return;
+
+    Entry& entry = entryIt.value();
+    entry.resultDeadlineMs = 0;
+    const QString conversationId = entry.conversationId;
+    const qint64 row = entry.row;
+    Queue& queue = m_queues[conversationId];
+    queue.awaiting.removeOne(clientId);
+
+    if (success) {
+        remove(clientId);
+        emit stateChanged(conversationId, row, clientId, SendState::Sent);
+    } else if (entry.attempts < kMaxAttempts) {
+        const qint64 backoff = qMin(kRetryMaxMs, kRetryBaseMs << (entry.attempts - 1));
+        entry.retryAtMs = m_clock.elapsed() + backoff;
+        queue.waiting.prepend(clientId);
+        qCDebug(lcBackend) << "Outbox: send failed, retrying message" << clientId
+                           << "in" << backoff << "ms";
+    } else {
+        entry.failed = true;
+        entry.contentHex.clear();
+        qCWarning(lcBackend) << "Outbox: giving up on message" << clientId << "after"
+                             << entry.attempts << "attempts";
+        m_failed.append(clientId);
+        if (m_failed.size() > kMaxFailedKept) {
+            remove(m_failed.takeFirst());
+        }
+        emit stateChanged(conversationId, row, clientId, SendState::Failed);
+    }
+
+    pump(conversationId);
+}
+
+void Outbox::remove(quint64 clientId)
+{
+    const auto entryIt = m_entries.constFind(clientId);
+    if (entryIt == m_entries.constEnd()) return;
+
+    auto rowsIt = m_rows.find(entryIt->conversationId);
+    if (rowsIt != m_rows.end()) {
+        rowsIt->remove(entryIt->row);
+        if (rowsIt->isEmpty()) {
+            m_rows.erase(rowsIt);
+        }
+    }
+    m_entries.erase(entryIt);
+}
+
+void Outbox::retryDue()
+{
+    const QList<QString> conversations = m_queues.keys();
+    for (const QString& conversationId : conversations) {
+        pump(conversationId);
+    }
+}
+
+void Outbox::scheduleRetryTimer()
+{
+    qint64 earliest = -1;
+    for (const Queue& queue : std::as_const(m_queues)) {
+        if (queue.waiting.isEmpty()) continue;
+        const qint64 retryAt = m_entries.value(queue.waiting.first()).retryAtMs;
+        if (retryAt > 0 && (earliest < 0 || retryAt < earliest)) {
+            earliest = retryAt;
+        }
+    }
+    if (earliest < 0) {
+        m_retryTimer->stop();
+        return;
+    }
+    m_retryTimer->start(int(qMax<qint64>(0, earliest - m_clock.elapsed())));
+}
+
+void Outbox::expireResults()
+{
+    const qint64 now = m_clock.elapsed();
+    QList<quint64> expired;
+    for (const Queue& queue : std::as_const(m_queues)) {
+        for (const quint64 clientId : queue.awaiting) {
+            const qint64 deadline = m_entries.value(clientId).resultDeadlineMs;
+            if (deadline > 0 && deadline <= now) {
+                expired.append(clientId);
+            }
+        }
+    }
+    for (const quint64 clientId : std::as_const(expired)) {
+        qCWarning(lcBackend) << "Outbox: no send result for message" << clientId
+                             << "after" << kResultTimeoutMs << "ms";
+        finish(clientId, false);
+    }
+    scheduleResultTimer();
+}
+
+void Outbox::scheduleResultTimer()
+{
+    qint64 earliest = -1;
+    for (const Queue& queue : std::as_const(m_queues)) {
+        for (const quint64 clientId : queue.awaiting) {
+            const qint64 deadline = m_entries.value(clientId).resultDeadlineMs;
+            if (deadline > 0 && (earliest < 0 || deadline < earliest)) {
+                earliest = deadline;
+            }
+        }
+    }
+    if (earliest < 0) {
+        m_resultTimer->stop();
+        return;
+    }
+    m_resultTimer->start(int(qMax<qint64>(0, earliest - m_clock.elapsed())));
+}
+
+Outbox::SendState Outbox::stateOf(const QString& conversationId, qint64 row) const
+{
+    const quint64 clientId = m_rows.value(conversationId).value(row);
+    if (clientId == 0) return SendState::Sent;
+    return m_entries.value(clientId).failed ? SendState::Failed : SendState::Pending;
+}
+
+void Outbox::markUnconfirmed(QList<ChatMessage>& messages)
+{
+    for (ChatMessage& message : messages) {
+        if (message.sendState == SendState::Pending) {
+            message.sendState = SendState::Unconfirmed;
+        }
+    }
+}
+
+void Outbox::applyStates(const QString& conversationId, qint64 firstRow,
+                         QList<ChatMessage>& messages) const
+{
+    markUnconfirmed(messages);
+    const auto rowsIt = m_rows.constFind(conversationId);
+    if (rowsIt == m_rows.constEnd()) return;
+
+    const qint64 endRow = firstRow + messages.size();
+    for (auto it = rowsIt->lowerBound(firstRow); it != rowsIt->constEnd() && it.key() < endRow;
+         ++it) {
+        messages[it.key() - firstRow].sendState =
+            m_entries.value(it.value()).failed ? SendState::Failed : SendState::Pending;
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include "ChatMessage.h"
+
+class IChatBackend;
+class QThread;
+class QTimer;
+
+/**
+ * Outgoing messages on their way to the backend.
+ *
+ * enqueue() returns at once with a client-side message id. The blocking
+ * IChatBackend::sendMessage() calls are made one after another, on a sender
+ * thread when the backend allows it (sendsFromAnyThread()), otherwise in
+ * later event-loop turns of the outbox's own thread. Either way typing or
+ * pasting many lines never waits for the module.
+ *
+ * Conversations are sent concurrently. Within a conversation up to
+ * kMaxInFlight messages are handed over, in the order they were written,
+ * before the first result comes back. A failed message goes back to the
+ * head of its queue; its retry is handed over only once nothing else of
+ * the conversation awaits a result, so it can arrive after at most the
+ * kMaxInFlight - 1 messages that were already on their way.
+ *
+ * The client id is passed to sendMessage(), and a result that carries it
+ * back finishes exactly that message. The module's results carry none, only
+ * (at most) the conversation id, and are answered in order: such a result
+ * finishes the oldest message awaiting one in its conversation. A result
+ * that names neither is matched only while a single conversation has sends
+ * awaiting results; otherwise it is dropped and the timeout decides.
+ *
+ * An accepted send whose result has not arrived within kResultTimeoutMs
+ * counts as failed, so a lost result cannot hold a conversation's queue
+ * forever. If the result turns up later it may be matched to the retry, and
+ * the peer may then receive the message twice.
+ *
+ * A failed send is retried with exponential backoff. While it waits, the
+ * rest of its conversation's queue waits behind it. After kMaxAttempts the
+ * message is marked failed and the queue moves on.
+ *
+ * Every change of a message's state is reported with stateChanged(), keyed
+ * by the message's conversation and row in the store, which records it.
+ */
+class Outbox : public QObject {
+    Q_OBJECT
+
+public:
+    using SendState = ChatMessage::SendState;
+
+    // backend must outlive the outbox, or shutdown() must be called first
+    explicit Outbox(IChatBackend* backend, QObject* parent = nullptr);
+    ~Outbox() override;
+
+    quint64 enqueue(const QString& conversationId, qint64 row, const QString& contentHex);
+
+    // Matches a chatsdkSendMessageResult; conversationId may be empty and
+    // clientId 0 when the result does not carry them
+    void handleResult(const QString& conversationId, quint64 clientId, bool success);
+
+    // Pending for messages still in the outbox, Failed for those given up
+    // on recently, Sent otherwise
+    SendState stateOf(const QString& conversationId, qint64 row) const;
+    // Every outcome in this session is recorded in the store, so a message
+    // the store has as pending that is not in the outbox was left over from
+    // an earlier session: Pending becomes Unconfirmed
+    static void markUnconfirmed(QList<ChatMessage>& messages);
+    // markUnconfirmed(), then the outbox's own state, for a page read from
+    // the store starting at store row firstRow
+    void applyStates(const QString& conversationId, qint64 firstRow,
+                     QList<ChatMessage>& messages) const;
+
+    // Waits for the send in progress, if any, and stops the sender thread
+    void shutdown();
+
+signals:
+    void stateChanged(const QString& conversationId, qint64 row, quint64 clientId,
+                      Outbox::SendState state);
+
+private:
+    struct Entry {
+        quint64 clientId = 0;
+        QString conversationId;
+        qint64 row = 0;
+        QString contentHex;
+        int attempts = 0;
+        bool failed = false;   // Kept only to answer stateOf() (m_failed)
+        qint64 retryAtMs = 0;  // Not handed over again before this (m_clock)
+        qint64 resultDeadlineMs = 0;  // Fails if no result by then; 0 if not awaited
+    };
+
+    // Messages of one conversation in the order they were written
+    struct Queue {
+        QList<quint64> waiting;   // Not yet handed over (head may be a retry)
+        QList<quint64> awaiting;  // Handed over, oldest first
+    };
+
+    void pump(const QString& conversationId);
+    void dispatch(Queue& queue, Entry& entry);
+    void remove(quint64 clientId);
+    void onDispatched(quint64 clientId, bool accepted);
+    void finish(quint64 clientId, bool success);
+    void retryDue();
+    void scheduleRetryTimer();
+    void expireResults();
+    void scheduleResultTimer();
+
+    IChatBackend* m_backend;
+    QThread* m_senderThread;  // Null unless the backend sends from any thread
+    QObject* m_sender;  // Where sends run: on m_senderThread, or this
+    QTimer* m_retryTimer;
+    QTimer* m_resultTimer;  // Fires at the earliest result deadline
+    QElapsedTimer m_clock;
+
+    quint64 m_nextClientId;
+    QHash<quint64, Entry> m_entries;
+    QHash<QString, Queue> m_queues;
+    QHash<QString, QMap<qint64, quint64>> m_rows;  // Conversation -> store row -> client id
+    QList<quint64> m_failed;  // Given up on, oldest first; at most kMaxFailedKept
+};
@@ -0,0 +1,85 @@
+#include "QuickSwitcher.h"
+#include "Theme.h"
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+
+namespace {
+const int ConversationIdRole = Qt::UserRole + 1;
+}
+
+QuickSwitcher::QuickSwitcher(QWidget* parent)
+    : QDialog(parent, Qt::Popup)
+{
+    setObjectName(Theme::QuickSwitcher);
+    setMinimumWidth(460);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setPlaceholderText("Switch to conversation...");
+    m_queryEdit->installEventFilter(this);
+
+    m_resultList = new QListWidget(this);
+    m_resultList->setUniformItemSizes(true);
+    m_resultList->setFocusPolicy(Qt::NoFocus);
+
+    layout->addWidget(m_queryEdit);
+    layout->addWidget(m_resultList, 1);
+
+    connect(m_queryEdit, &QLineEdit::textChanged, this, &QuickSwitcher::queryChanged);
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, [this]() {
+        onItemActivated(m_resultList->currentItem());
+    });
+    connect(m_resultList, &QListWidget::itemActivated, this, &QuickSwitcher::onItemActivated);
+    connect(m_resultList, &QListWidget::itemClicked, this, &QuickSwitcher::onItemActivated);
+}
+
+void QuickSwitcher::setResults(const QList<Result>& results)
+{
+    m_resultList->clear();
+    for (const Result& result : results) {
+        QListWidgetItem* item = new QListWidgetItem(
+            result.detail.isEmpty() ? result.title
+                                    : QString("%1  \xc2\xb7  %2").arg(result.title, result.detail),
+            m_resultList);
+        item->setData(ConversationIdRole, result.conversationId);
+    }
+    if (!results.isEmpty()) {
+        m_resultList->setCurrentRow(0);
+    }
+}
+
+void QuickSwitcher::start()
+{
+    // textChanged does not fire when the text is already empty
+    if (m_queryEdit->text().isEmpty()) {
+        emit queryChanged(QString());
+    } else {
+        m_queryEdit->clear();
+    }
+    m_queryEdit->setFocus();
+}
+
+bool QuickSwitcher::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_queryEdit && event->type() == QEvent::KeyPress) {
+        const int key = static_cast<QKeyEvent*>(event)->key();
+        if (key == Qt::Key_Up || key == Qt::Key_Down ||
+            key == Qt::Key_PageUp || key == Qt::Key_PageDown) {
+            QCoreApplication::sendEvent(m_resultList, event);
+            return true;
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
+
+void QuickSwitcher::onItemActivated(QListWidgetItem* item)
+{
+    if (!item) return;
+    const QString conversationId = item->data(ConversationIdRole).toString();
+    hide();
+    emit conversationChosen(conversationId);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QDialog>
+#include <QList>
+#include <QString>
+
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
+
+/**
+ * Ctrl+K conversation switcher. Like SearchDialog it only collects the query
+ * and shows what the owner answers with setResults(); the matching is done
+ * against a ConversationIndex. Up/Down move through the results while the
+ * query keeps focus, Enter switches, Escape closes.
+ */
+class QuickSwitcher : public QDialog {
+    Q_OBJECT
+
+public:
+    struct Result {
+        QString conversationId;
+        QString title;   // Conversation name
+        QString detail;  // Peer or conversation id
+    };
+
+    explicit QuickSwitcher(QWidget* parent = nullptr);
+    ~QuickSwitcher() = default;
+
+    void setResults(const QList<Result>& results);
+    // Clears the previous query and asks for results for the empty one
+    void start();
+
+signals:
+    void queryChanged(const QString& query);
+    void conversationChosen(const QString& conversationId);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void onItemActivated(QListWidgetItem* item);
+
+private:
+    QLineEdit* m_queryEdit;
+    QListWidget* m_resultList;
+};
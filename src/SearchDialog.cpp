@@ -0,0 +1,103 @@
+#include "SearchDialog.h"
+#include "Theme.h"
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+
+namespace {
+const int ConversationIdRole = Qt::UserRole + 1;
+const int RowRole = Qt::UserRole + 2;
+}
+
+SearchDialog::SearchDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setObjectName(Theme::SearchDialog);
+    setWindowTitle("Search Messages");
+    setMinimumSize(520, 420);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setPlaceholderText("Search messages...");
+    m_queryEdit->setClearButtonEnabled(true);
+
+    m_currentOnlyCheck = new QCheckBox(this);
+    setCurrentConversation(QString());
+
+    m_resultList = new QListWidget(this);
+    m_resultList->setWordWrap(true);
+    m_resultList->setUniformItemSizes(false);
+
+    m_statusLabel = new QLabel(this);
+
+    layout->addWidget(m_queryEdit);
+    layout->addWidget(m_currentOnlyCheck);
+    layout->addWidget(m_resultList, 1);
+    layout->addWidget(m_statusLabel);
+
+    connect(m_queryEdit, &QLineEdit::textChanged, this, &SearchDialog::onQueryEdited);
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, &SearchDialog::onReturnPressed);
+    connect(m_currentOnlyCheck, &QCheckBox::toggled, this, &SearchDialog::onQueryEdited);
+    connect(m_resultList, &QListWidget::itemActivated, this, &SearchDialog::onItemActivated);
+}
+
+void SearchDialog::setCurrentConversation(const QString& name)
+{
+    if (name.isEmpty()) {
+        m_currentOnlyCheck->setChecked(false);
+        m_currentOnlyCheck->setEnabled(false);
+        m_currentOnlyCheck->setText("Only the current conversation");
+    } else {
+        m_currentOnlyCheck->setEnabled(true);
+        m_currentOnlyCheck->setText(QString("Only %1").arg(name));
+    }
+}
+
+void SearchDialog::setResults(const QList<Result>& results, qint64 elapsedUs)
+{
+    m_resultList->clear();
+    for (const Result& result : results) {
+        QListWidgetItem* item = new QListWidgetItem(
+            QString("%1\n%2").arg(result.title, result.snippet), m_resultList);
+        item->setData(ConversationIdRole, result.conversationId);
+        item->setData(RowRole, result.row);
+    }
+    if (!results.isEmpty()) {
+        m_resultList->setCurrentRow(0);
+    }
+
+    if (m_queryEdit->text().trimmed().isEmpty()) {
+        m_statusLabel->clear();
+    } else {
+        m_statusLabel->setText(QString("%1 result%2 in %3 ms")
+                                   .arg(results.size())
+                                   .arg(results.size() == 1 ? "" : "s")
+                                   .arg(elapsedUs / 1000.0, 0, 'f', 2));
+    }
+}
+
+void SearchDialog::focusQuery()
+{
+    m_queryEdit->setFocus();
+    m_queryEdit->selectAll();
+}
+
+void SearchDialog::onQueryEdited()
+{
+    emit queryChanged(m_queryEdit->text(), m_currentOnlyCheck->isChecked());
+}
+
+void SearchDialog::onItemActivated(QListWidgetItem* item)
+{
+    if (!item) return;
+    emit resultActivated(item->data(ConversationIdRole).toString(),
+                         item->data(RowRole).toLongLong());
+}
+
+void SearchDialog::onReturnPressed()
+{
+    onItemActivated(m_resultList->currentItem());
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QDialog>
+#include <QList>
+#include <QString>
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
+
+/**
+ * Non-modal message search. The dialog only collects the query and shows
+ * results; the owner runs the query against its index and answers with
+ * setResults().
+ */
+class SearchDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    struct Result {
+        QString conversationId;
+        qint64 row;
+        QString title;    // Conversation name and sender
+        QString snippet;  // Message text
+    };
+
+    explicit SearchDialog(QWidget* parent = nullptr);
+    ~SearchDialog() = default;
+
+    // Label for the "current conversation only" filter; empty disables it
+    void setCurrentConversation(const QString& name);
+    void setResults(const QList<Result>& results, qint64 elapsedUs);
+    void focusQuery();
+
+signals:
+    void queryChanged(const QString& query, bool currentConversationOnly);
+    void resultActivated(const QString& conversationId, qint64 row);
+
+private slots:
+    void onQueryEdited();
+    void onItemActivated(QListWidgetItem* item);
+    void onReturnPressed();
+
+private:
+    QLineEdit* m_queryEdit;
+    QCheckBox* m_currentOnlyCheck;
+    QListWidget* m_resultList;
+    QLabel* m_statusLabel;
+};
@@ -0,0 +1,234 @@
+#include "SearchIndex.h"
+#include <QTextBoundaryFinder>
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kRecentTermsLimit = 1024;
+// Longer tokens (keys, hex blobs) are cut rather than bloating the dictionary
+constexpr int kMaxTermLength = 64;
+// Shorter trailing terms only match exactly; a one-letter prefix would pull
+// in a large share of the index
+constexpr int kMinPrefixLength = 2;
+
+bool isIdeographic(char32_t ucs4)
+{
+    switch (QChar::script(ucs4)) {
+    case QChar::Script_Han:
+    case QChar::Script_Hiragana:
+    case QChar::Script_Katakana:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Sorted intersection, galloping through the longer list
+std::vector<quint32> intersect(const std::vector<quint32>& a, const std::vector<quint32>& b)
+{
+    const auto& shorter = a.size() <= b.size() ? a : b;
+    const auto& longer = a.size() <= b.size() ? b : a;
+
+    std::vector<quint32> result;
+    result.reserve(shorter.size());
+    auto from = longer.begin();
+    for (quint32 document : shorter) {
+        from = std::lower_bound(from, longer.end(), document);
+        if (from == longer.end()) break;
+        if (*from == document) result.push_back(document);
+    }
+    return result;
+}
+
+} // namespace
+
+SearchIndex::SearchIndex()
+{
+}
+
+QStringList SearchIndex::tokenize(QStringView text)
+{
+    QStringList tokens;
+    if (text.isEmpty()) return tokens;
+
+    auto appendWord = [&tokens](QStringView word) {
+        if (word.isEmpty()) return;
+        tokens.append(word.left(kMaxTermLength).toString().toCaseFolded());
+    };
+
+    // QTextBoundaryFinder needs a QString that outlives it
+    const QString source = text.toString();
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, source);
+    qsizetype start = 0;
+    while (finder.toNextBoundary() != -1) {
+        const qsizetype end = finder.position();
+        if (finder.boundaryReasons() & QTextBoundaryFinder::EndOfItem) {
+            // Split ideographic characters out of the word, one term each
+            const QStringView word = QStringView(source).mid(start, end - start);
+            qsizetype runStart = 0;
+            qsizetype i = 0;
+            while (i < word.size()) {
+                char32_t ucs4 = word[i].unicode();
+                qsizetype width = 1;
+                if (word[i].isHighSurrogate() && i + 1 < word.size() &&
+                    word[i + 1].isLowSurrogate()) {
+                    ucs4 = QChar::surrogateToUcs4(word[i], word[i + 1]);
+                    width = 2;
+                }
+                if (isIdeographic(ucs4)) {
+                    appendWord(word.mid(runStart, i - runStart));
+                    appendWord(word.mid(i, width));
+                    runStart = i + width;
+                }
+                i += width;
+            }
+            appendWord(word.mid(runStart));
+        }
+        start = end;
+    }
+    return tokens;
+}
+
+quint32 SearchIndex::internConversation(const QString& conversationId)
+{
+    auto it = m_conversationIds.constFind(conversationId);
+    if (it != m_conversationIds.constEnd()) return it.value();
+
+    const quint32 id = static_cast<quint32>(m_conversations.size());
+    m_conversations.append(conversationId);
+    m_conversationIds.insert(conversationId, id);
+    return id;
+}
+
+void SearchIndex::addMessage(const QString& conversationId, qint64 row, QStringView text)
+{
+    addMessage(internConversation(conversationId), row, text);
+}
+
+void SearchIndex::addMessage(quint32 conversation, qint64 row, QStringView text)
+{
+    Q_ASSERT(conversation < quint32(m_conversations.size()));
+    const QStringList terms = tokenize(text);
+    if (terms.isEmpty()) return;
+
+    const quint32 document = static_cast<quint32>(m_documents.size());
+    m_documents.append({conversation, row});
+    for (const QString& term : terms) {
+        addTerm(term, document);
+    }
+}
+
+void SearchIndex::append(const SearchIndex& newer)
+{
+    // Shifted past this index's documents, so posting lists stay sorted
+    const quint32 offset = static_cast<quint32>(m_documents.size());
+    m_documents.reserve(m_documents.size() + newer.m_documents.size());
+    for (const Document& document : newer.m_documents) {
+        m_documents.append(
+            {internConversation(newer.m_conversations.at(document.conversation)), document.row});
+    }
+    for (auto it = newer.m_termIds.constBegin(); it != newer.m_termIds.constEnd(); ++it) {
+        for (quint32 document : newer.m_postings[it.value()]) {
+            addTerm(it.key(), offset + document);
+        }
+    }
+}
+
+void SearchIndex::addTerm(const QString& term, quint32 document)
+{
+    auto it = m_termIds.constFind(term);
+    if (it == m_termIds.constEnd()) {
+        it = m_termIds.insert(term, static_cast<quint32>(m_postings.size()));
+        m_postings.emplace_back();
+        m_recentTerms.push_back(term);
+        if (m_recentTerms.size() >= kRecentTermsLimit) {
+            mergeRecentTerms();
+        }
+    }
+
+    // Documents arrive in id order, so lists stay sorted; a term repeated
+    // in one message is only recorded once
+    Postings& postings = m_postings[it.value()];
+    if (postings.empty() || postings.back() != document) {
+        postings.push_back(document);
+    }
+}
+
+void SearchIndex::mergeRecentTerms()
+{
+    std::sort(m_recentTerms.begin(), m_recentTerms.end());
+    const size_t middle = m_sortedTerms.size();
+    m_sortedTerms.insert(m_sortedTerms.end(), m_recentTerms.begin(), m_recentTerms.end());
+    std::inplace_merge(m_sortedTerms.begin(), m_sortedTerms.begin() + middle, m_sortedTerms.end());
+    m_recentTerms.clear();
+}
+
+SearchIndex::Postings SearchIndex::termPostings(const QString& term, bool prefix) const
+{
+    if (!prefix || term.size() < kMinPrefixLength) {
+        auto it = m_termIds.constFind(term);
+        return it == m_termIds.constEnd() ? Postings() : m_postings[it.value()];
+    }
+
+    // Union of every term starting with the prefix
+    std::vector<const Postings*> lists;
+    auto it = std::lower_bound(m_sortedTerms.begin(), m_sortedTerms.end(), term);
+    for (; it != m_sortedTerms.end() && it->startsWith(term); ++it) {
+        lists.push_back(&m_postings[m_termIds.value(*it)]);
+    }
+    for (const QString& recent : m_recentTerms) {
+        if (recent.startsWith(term)) {
+            lists.push_back(&m_postings[m_termIds.value(recent)]);
+        }
+    }
+
+    if (lists.size() == 1) return *lists.front();
+
+    Postings result;
+    for (const Postings* list : lists) {
+        result.insert(result.end(), list->begin(), list->end());
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QList<SearchIndex::Hit> SearchIndex::search(QStringView query, const QString& conversationId,
+                                            int limit) const
+{
+    QList<Hit> hits;
+    const QStringList terms = tokenize(query);
+    if (terms.isEmpty() || limit <= 0) return hits;
+
+    quint32 conversationFilter = 0;
+    const bool filtered = !conversationId.isEmpty();
+    if (filtered) {
+        auto it = m_conversationIds.constFind(conversationId);
+        if (it == m_conversationIds.constEnd()) return hits;
+        conversationFilter = it.value();
+    }
+
+    // The last term is still being typed unless the query ends in a space
+    const bool lastIsPrefix = !query.isEmpty() && !query.back().isSpace();
+    std::vector<Postings> lists;
+    lists.reserve(terms.size());
+    for (int i = 0; i < terms.size(); ++i) {
+        lists.push_back(termPostings(terms[i], lastIsPrefix && i == terms.size() - 1));
+        if (lists.back().empty()) return hits;
+    }
+
+    // Intersect starting from the rarest term
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings& a, const Postings& b) { return a.size() < b.size(); });
+    Postings matches = std::move(lists.front());
+    for (size_t i = 1; i < lists.size() && !matches.empty(); ++i) {
+        matches = intersect(matches, lists[i]);
+    }
+
+    for (auto it = matches.rbegin(); it != matches.rend() && hits.size() < limit; ++it) {
+        const Document& document = m_documents[*it];
+        if (filtered && document.conversation != conversationFilter) continue;
+        hits.append({m_conversations.at(document.conversation), document.row});
+    }
+    return hits;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <vector>
+
+/**
+ * Incremental inverted index over message text.
+ *
+ * Each indexed message gets a sequential document id. Every term maps to
+ * the ascending list of documents containing it, so adding a message only
+ * appends to posting lists and a query is a merge of sorted lists. Terms
+ * are kept in a sorted dictionary plus a small unsorted tail (merged when it
+ * fills up), which gives prefix lookups by binary search without re-sorting
+ * the dictionary on every new word.
+ *
+ * Tokenization follows Unicode word boundaries and case-folds each word.
+ * Han and kana are indexed one character per term, because those scripts do
+ * not separate words with spaces.
+ */
+class SearchIndex {
+public:
+    struct Hit {
+        QString conversationId;
+        qint64 row;  // Message position in the conversation's store history
+    };
+
+    SearchIndex();
+
+    void addMessage(const QString& conversationId, qint64 row, QStringView text);
+    // Key from internConversation(); valid until this index is replaced
+    void addMessage(quint32 conversation, qint64 row, QStringView text);
+    quint32 internConversation(const QString& conversationId);
+    // Adds every message of newer after this index's own, without
+    // tokenizing them again
+    void append(const SearchIndex& newer);
+
+    // Every query term must match. The last term also matches as a prefix
+    // so results update while typing. Newest indexed messages come first;
+    // an empty conversationId searches all conversations.
+    QList<Hit> search(QStringView query, const QString& conversationId = QString(),
+                      int limit = 100) const;
+
+    qint64 documentCount() const { return m_documents.size(); }
+    qint64 termCount() const { return m_termIds.size(); }
+
+    static QStringList tokenize(QStringView text);
+
+private:
+    struct Document {
+        quint32 conversation;
+        qint64 row;
+    };
+
+    using Postings = std::vector<quint32>;
+
+    void addTerm(const QString& term, quint32 document);
+    void mergeRecentTerms();
+    Postings termPostings(const QString& term, bool prefix) const;
+
+    QHash<QString, quint32> m_conversationIds;
+    QStringList m_conversations;
+    QVector<Document> m_documents;
+
+    QHash<QString, quint32> m_termIds;
+    std::vector<Postings> m_postings;
+
+    // Dictionary for prefix lookup; new terms wait in the short unsorted
+    // m_recentTerms until it is full and gets merged in
+    std::vector<QString> m_sortedTerms;
+    std::vector<QString> m_recentTerms;
+};
@@ -0,0 +1,212 @@
+#include "StallWatchdog.h"
+#include "ChatLogging.h"
+#include <QAtomicPointer>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+// Watchdog that Scope reports to; GUI thread only, like Scope itself
+QAtomicPointer<StallWatchdog> s_active;
+
+constexpr qint64 kNsPerMs = 1000000;
+
+} // namespace
+
+StallWatchdog::Scope::Scope(const char* handler, qint64 payload, const char* payloadUnit)
+    : m_watchdog(s_active.loadAcquire())
+{
+    if (m_watchdog) {
+        m_watchdog->push(handler, payload, payloadUnit);
+    }
+}
+
+StallWatchdog::Scope::~Scope()
+{
+    if (m_watchdog) {
+        m_watchdog->pop();
+    }
+}
+
+StallWatchdog::StallWatchdog(int thresholdMs, int capacity, QObject* parent)
+    : QObject(parent)
+    , m_thresholdMs(thresholdMs)
+    , m_capacity(qMax(1, capacity))
+    , m_stopping(false)
+    , m_lastBeatNs(0)
+    , m_depth(0)
+    , m_stallActive(false)
+    , m_nextStall(0)
+    , m_heartbeat(nullptr)
+    , m_thread(nullptr)
+{
+    if (m_thresholdMs <= 0) {
+        return;
+    }
+
+    m_clock.start();
+    m_lastBeatNs = m_clock.nsecsElapsed();
+
+    m_heartbeat = new QTimer(this);
+    m_heartbeat->setInterval(qMax(1, m_thresholdMs / 4));
+    connect(m_heartbeat, &QTimer::timeout, this, &StallWatchdog::beat);
+    m_heartbeat->start();
+
+    m_thread = QThread::create([this]() { watchLoop(); });
+    m_thread->setObjectName("ChatSDKStallWatchdog");
+    m_thread->start(QThread::HighPriority);
+
+    s_active.storeRelease(this);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    s_active.testAndSetOrdered(this, nullptr);
+
+    if (m_thread) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_stopRequested.wakeAll();
+        }
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+void StallWatchdog::push(const char* handler, qint64 payload, const char* payloadUnit)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_depth < kMaxDepth) {
+        m_frames[m_depth] = {handler, payloadUnit, payload, m_clock.nsecsElapsed()};
+    }
+    ++m_depth;
+}
+
+void StallWatchdog::pop()
+{
+    QMutexLocker locker(&m_mutex);
+    --m_depth;
+    if (!m_stallActive || m_depth >= m_pending.frames.size()) {
+        return;
+    }
+    // The stall captured this frame; note when the handler returned
+    if (m_pending.frames[m_depth].startNs == m_frames[m_depth].startNs) {
+        m_pending.endNs[m_depth] = m_clock.nsecsElapsed();
+    }
+}
+
+void StallWatchdog::watchLoop()
+{
+    const int checkIntervalMs = qMax(1, m_thresholdMs / 4);
+    const qint64 thresholdNs = m_thresholdMs * kNsPerMs;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        m_stopRequested.wait(&m_mutex, checkIntervalMs);
+        if (m_stopping || m_stallActive) {
+            continue;
+        }
+
+        const qint64 lateNs = m_clock.nsecsElapsed() - m_lastBeatNs;
+        if (lateNs <= thresholdNs) {
+            continue;
+        }
+
+        m_stallActive = true;
+        m_pending.detectedAt = QDateTime::currentDateTime();
+        m_pending.frames.clear();
+        for (int i = 0; i < qMin(m_depth, kMaxDepth); ++i) {
+            m_pending.frames.append(m_frames[i]);
+        }
+        m_pending.endNs.fill(0, m_pending.frames.size());
+
+        QStringList handlers;
+        for (const OpenFrame& frame : m_pending.frames) {
+            handlers.append(QString::fromLatin1(frame.handler));
+        }
+        qCWarning(lcPerf).noquote() << "StallWatchdog: GUI thread blocked for over"
+                                    << lateNs / kNsPerMs << "ms in"
+                                    << (handlers.isEmpty() ? QString("(no marked handler)")
+                                                           : handlers.join(" > "));
+    }
+}
+
+void StallWatchdog::beat()
+{
+    Stall stall;
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 nowNs = m_clock.nsecsElapsed();
+        const qint64 previousNs = m_lastBeatNs;
+        m_lastBeatNs = nowNs;
+        if (!m_stallActive) {
+            return;
+        }
+
+        // The beat was due one interval after the previous one
+        stall.detectedAt = m_pending.detectedAt;
+        stall.blockedMs = qMax<qint64>(
+            0, (nowNs - previousNs) / kNsPerMs - m_heartbeat->interval());
+        for (int i = 0; i < m_pending.frames.size(); ++i) {
+            const OpenFrame& open = m_pending.frames.at(i);
+            Frame frame;
+            frame.handler = QString::fromLatin1(open.handler);
+            frame.payloadUnit = open.payloadUnit ? QString::fromLatin1(open.payloadUnit)
+                                                 : QString();
+            frame.payload = open.payload;
+            frame.durationMs = m_pending.endNs.at(i)
+                ? (m_pending.endNs.at(i) - open.startNs) / kNsPerMs
+                : -1;
+            stall.handlers.append(frame);
+        }
+        m_stallActive = false;
+
+        if (m_stalls.size() < m_capacity) {
+            m_stalls.append(stall);
+        } else {
+            m_stalls[m_nextStall] = stall;
+        }
+        m_nextStall = (m_nextStall + 1) % m_capacity;
+    }
+
+    qCWarning(lcPerf).noquote() << "StallWatchdog:" << formatStall(stall);
+}
+
+QVector<StallWatchdog::Stall> StallWatchdog::stalls() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stalls.size() < m_capacity) {
+        return m_stalls;
+    }
+    // Full ring: the oldest entry is the next one to be overwritten
+    QVector<Stall> ordered;
+    ordered.reserve(m_stalls.size());
+    for (int i = 0; i < m_stalls.size(); ++i) {
+        ordered.append(m_stalls.at((m_nextStall + i) % m_stalls.size()));
+    }
+    return ordered;
+}
+
+QString StallWatchdog::formatStall(const Stall& stall)
+{
+    QStringList handlers;
+    for (const Frame& frame : stall.handlers) {
+        QString text = frame.handler;
+        if (frame.payload >= 0) {
+            text += QString(" [%1 %2]").arg(frame.payload).arg(frame.payloadUnit);
+        }
+        text += frame.durationMs >= 0 ? QString(" %1 ms").arg(frame.durationMs)
+                                      : QString(" still running");
+        handlers.append(text);
+    }
+
+    return QString("%1 blocked %2 ms in %3")
+        .arg(stall.detectedAt.toString("HH:mm:ss.zzz"))
+        .arg(stall.blockedMs)
+        .arg(handlers.isEmpty() ? QString("(no marked handler)") : handlers.join(" > "));
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+class QThread;
+class QTimer;
+
+/**
+ * Detects GUI-thread event-loop stalls and attributes them to a handler.
+ *
+ * A timer on the GUI thread beats every threshold / 4. A watchdog thread
+ * checks the last beat; when it is older than the threshold the stall is
+ * logged straight away (so a hang that never recovers is still attributed),
+ * together with the stack of handlers open at that moment. Handlers mark
+ * themselves with StallWatchdog::Scope. When the loop comes back, the next
+ * beat completes the record with how long the loop was blocked and how long
+ * each handler ran, and adds it to a fixed-size ring buffer, readable with
+ * stalls().
+ *
+ * A modal dialog runs a nested event loop, so it does not stall the GUI
+ * thread by itself; the handler that opened it simply shows up with a long
+ * duration if something else stalls meanwhile.
+ */
+class StallWatchdog : public QObject {
+    Q_OBJECT
+
+public:
+    struct Frame {
+        QString handler;
+        QString payloadUnit;  // What payload counts: events, messages, rows...
+        qint64 payload = -1;  // -1 when the handler has no natural size
+        qint64 durationMs = -1;  // Still running when the loop came back: -1
+    };
+
+    struct Stall {
+        QDateTime detectedAt;
+        qint64 blockedMs = 0;
+        QVector<Frame> handlers;  // Outermost first; empty if none was marked
+    };
+
+    /**
+     * Marks the handler running on the GUI thread while in scope. A no-op
+     * when no watchdog is running. Handler names are string literals.
+     */
+    class Scope {
+    public:
+        Scope(const char* handler, qint64 payload = -1, const char* payloadUnit = nullptr);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StallWatchdog* m_watchdog;
+    };
+
+    // thresholdMs <= 0 disables the watchdog; records keep the newest capacity stalls
+    explicit StallWatchdog(int thresholdMs, int capacity = 64, QObject* parent = nullptr);
+    ~StallWatchdog() override;
+
+    bool isRunning() const { return m_thread != nullptr; }
+    int thresholdMs() const { return m_thresholdMs; }
+
+    // Oldest first
+    QVector<Stall> stalls() const;
+    static QString formatStall(const Stall& stall);
+
+private:
+    struct OpenFrame {
+        const char* handler;
+        const char* payloadUnit;
+        qint64 payload;
+        qint64 startNs;
+    };
+    struct PendingStall {
+        QDateTime detectedAt;
+        QVector<OpenFrame> frames;
+        QVector<qint64> endNs;  // Per frame, 0 while running
+    };
+
+    static constexpr int kMaxDepth = 16;
+
+    void push(const char* handler, qint64 payload, const char* payloadUnit);
+    void pop();
+    void beat();
+    void watchLoop();
+
+    const int m_thresholdMs;
+    const int m_capacity;
+    QElapsedTimer m_clock;  // Shared monotonic clock, read on both threads
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_stopRequested;
+    bool m_stopping;
+    qint64 m_lastBeatNs;
+    OpenFrame m_frames[kMaxDepth];
+    int m_depth;  // May exceed kMaxDepth; deeper frames are not tracked
+    bool m_stallActive;
+    PendingStall m_pending;
+    QVector<Stall> m_stalls;  // Ring buffer of m_capacity entries
+    int m_nextStall;
+
+    QTimer* m_heartbeat;
+    QThread* m_thread;
+};
@@ -0,0 +1,282 @@
+#include "Theme.h"
+#include "ChatConfig.h"
+#include <QWidget>
+#include <utility>
+
+namespace {
+
+// One sheet for the whole window. @name@ is replaced by the matching color.
+const char* const kStyleSheetTemplate = R"(
+QMainWindow { background-color: @window@; }
+QSplitter { background-color: @surface@; }
+QSplitter::handle { background-color: @border@; }
+QStatusBar {
+  background-color: @surface@;
+  color: @textMuted@;
+  border-top: 1px solid @border@;
+}
+QStatusBar QLabel { color: @textMuted@; margin-right: 15px; }
+
+ConversationListPanel { background-color: @surface@; }
+#panelHeader { background-color: @surface@; border-bottom: 1px solid @border@; }
+#panelTitle { color: @text@; background: transparent; }
+#emptyState { background-color: @surface@; }
+#emptyState QLabel { color: @textMuted@; background: transparent; }
+
+QListView#conversationList { border: none; background-color: @surface@; }
+
+QListView#timeline { border: none; background-color: @surface@; padding: 16px; }
+QListView#timeline::item,
+QListView#timeline::item:selected,
+QListView#timeline::item:hover { background: transparent; }
+QListView#timeline QScrollBar:vertical {
+  background-color: @surface@;
+  width: 8px;
+  margin: 0px;
+}
+QListView#timeline QScrollBar::handle:vertical {
+  background-color: @border@;
+  border-radius: 4px;
+  min-height: 20px;
+}
+QListView#timeline QScrollBar::add-line:vertical,
+QListView#timeline QScrollBar::sub-line:vertical { height: 0px; }
+
+#composer { background-color: @surface@; border-top: 1px solid @border@; }
+#composer QLineEdit {
+  border: 1px solid @border@;
+  border-radius: 4px;
+  padding: 10px 15px;
+  background-color: @field@;
+  color: @text@;
+  font-size: 13px;
+}
+#composer QLineEdit:focus { border-color: @accent@; }
+
+QPushButton#accentButton {
+  background-color: @accent@;
+  color: @onAccent@;
+  border: none;
+  border-radius: 4px;
+  font-size: 12px;
+  font-weight: bold;
+  padding: 6px 12px;
+}
+#composer QPushButton#accentButton { font-size: 16px; padding: 0px; }
+QPushButton#accentButton:hover { background-color: @accentHover@; }
+QPushButton#accentButton:pressed { background-color: @accentPressed@; }
+QPushButton#accentButton:disabled { background-color: @disabled@; color: @textFaint@; }
+
+QPushButton#newMessagesPill {
+  background-color: @accent@;
+  color: @onAccent@;
+  border: none;
+  border-radius: 12px;
+  padding: 4px 14px;
+  font-size: 12px;
+  font-weight: bold;
+}
+QPushButton#newMessagesPill:hover { background-color: @accentHover@; }
+
+QPushButton#footerButton {
+  background-color: transparent;
+  border: none;
+  border-top: 1px solid @border@;
+  border-radius: 0px;
+  padding: 15px;
+  font-size: 13px;
+  font-weight: bold;
+  color: @text@;
+}
+QPushButton#footerButton:hover,
+QPushButton#footerButton:pressed { background-color: @hover@; }
+
+QDialog#searchDialog { background-color: @surface@; }
+QDialog#searchDialog QLabel,
+QDialog#searchDialog QCheckBox { color: @textMuted@; }
+QDialog#searchDialog QLineEdit {
+  border: 1px solid @border@;
+  border-radius: 4px;
+  padding: 8px 12px;
+  background-color: @field@;
+  color: @text@;
+}
+QDialog#searchDialog QLineEdit:focus { border-color: @accent@; }
+QDialog#searchDialog QListWidget {
+  border: 1px solid @border@;
+  background-color: @surface@;
+  color: @text@;
+}
+QDialog#searchDialog QListWidget::item { padding: 6px; border-bottom: 1px solid @hover@; }
+QDialog#searchDialog QListWidget::item:selected { background-color: @hover@; }
+
+QDialog#quickSwitcher {
+  background-color: @surface@;
+  border: 1px solid @border@;
+}
+QDialog#quickSwitcher QLineEdit {
+  border: 1px solid @accent@;
+  border-radius: 4px;
+  padding: 8px 12px;
+  background-color: @field@;
+  color: @text@;
+}
+QDialog#quickSwitcher QListWidget {
+  border: none;
+  background-color: @surface@;
+  color: @text@;
+}
+QDialog#quickSwitcher QListWidget::item { padding: 6px; }
+QDialog#quickSwitcher QListWidget::item:selected { background-color: @hover@; }
+)";
+
+QString cssColor(const QColor& color)
+{
+    if (color.alpha() == 255) {
+        return color.name();
+    }
+    return QString("rgba(%1, %2, %3, %4)")
+        .arg(color.red())
+        .arg(color.green())
+        .arg(color.blue())
+        .arg(color.alpha());
+}
+
+QFont monospaceFont(const QString& family, int pointSize)
+{
+    QFont font(family, pointSize);
+    font.setStyleHint(QFont::Monospace);
+    return font;
+}
+
+} // namespace
+
+Theme& Theme::instance()
+{
+    static Theme theme;
+    return theme;
+}
+
+Theme::Theme(QObject* parent)
+    : QObject(parent)
+    , m_mode(ChatConfig::lightThemeRequested() ? Light : Dark)
+    , m_colors(colorsFor(m_mode))
+    , m_palette(paletteFor(m_colors))
+    , m_styleSheet(styleSheetFor(m_colors))
+    , m_baseFont(monospaceFont("JetBrains Mono", 12))
+    , m_titleFont(monospaceFont("JetBrains Mono", 14))
+    , m_emptyStateFont(monospaceFont("JetBrains Mono", 14))
+    , m_listNameFont(monospaceFont("JetBrains Mono", 12))
+    , m_listTimeFont(monospaceFont("IBM Plex Mono", 10))
+{
+    m_titleFont.setBold(true);
+    m_emptyStateFont.setItalic(true);
+    m_listNameFont.setBold(true);
+}
+
+void Theme::setMode(Mode mode)
+{
+    if (mode == m_mode) {
+        return;
+    }
+    m_mode = mode;
+    m_colors = colorsFor(mode);
+    m_palette = paletteFor(m_colors);
+    m_styleSheet = styleSheetFor(m_colors);
+    emit changed();
+}
+
+void Theme::apply(QWidget* window) const
+{
+    // Dialogs parented to the window pick up its font and palette as well
+    window->setAttribute(Qt::WA_WindowPropagation, true);
+    window->setFont(m_baseFont);
+    window->setPalette(m_palette);
+    window->setStyleSheet(m_styleSheet);
+}
+
+Theme::Colors Theme::colorsFor(Mode mode)
+{
+    Colors colors;
+    if (mode == Light) {
+        colors.window = QColor("#F5F5F5");
+        colors.surface = QColor("#FFFFFF");
+        colors.field = QColor("#F9FAFB");
+        colors.hover = QColor("#F3F4F6");
+        colors.border = QColor("#E5E7EB");
+        colors.text = QColor("#0A0A0A");
+        colors.textMuted = QColor("#6B7280");
+        colors.textFaint = QColor("#9CA3AF");
+        colors.accent = QColor("#059669");
+        colors.accentHover = QColor("#10B981");
+        colors.accentPressed = QColor("#047857");
+        colors.onAccent = QColor("#FFFFFF");
+        colors.onAccentMuted = QColor(255, 255, 255, 178);
+        colors.disabled = QColor("#E5E7EB");
+    } else {
+        colors.window = QColor("#000000");
+        colors.surface = QColor("#0A0A0A");
+        colors.field = QColor("#0F0F0F");
+        colors.hover = QColor("#1F1F1F");
+        colors.border = QColor("#2a2a2a");
+        colors.text = QColor("#FAFAFA");
+        colors.textMuted = QColor("#6B7280");
+        colors.textFaint = QColor("#4B5563");
+        colors.accent = QColor("#10B981");
+        colors.accentHover = QColor("#34D399");
+        colors.accentPressed = QColor("#059669");
+        colors.onAccent = QColor("#0A0A0A");
+        colors.onAccentMuted = QColor(10, 10, 10, 153);
+        colors.disabled = QColor("#1F1F1F");
+    }
+    colors.badge = QColor("#EF4444");
+    colors.onBadge = QColor("#FFFFFF");
+    return colors;
+}
+
+QString Theme::styleSheetFor(const Colors& colors)
+{
+    const std::pair<const char*, QColor> tokens[] = {
+        {"@window@", colors.window},
+        {"@surface@", colors.surface},
+        {"@field@", colors.field},
+        {"@hover@", colors.hover},
+        {"@border@", colors.border},
+        {"@text@", colors.text},
+        {"@textMuted@", colors.textMuted},
+        {"@textFaint@", colors.textFaint},
+        {"@accent@", colors.accent},
+        {"@accentHover@", colors.accentHover},
+        {"@accentPressed@", colors.accentPressed},
+        {"@onAccent@", colors.onAccent},
+        {"@disabled@", colors.disabled},
+    };
+
+    QString sheet = QString::fromLatin1(kStyleSheetTemplate);
+    for (const auto& token : tokens) {
+        sheet.replace(QLatin1String(token.first), cssColor(token.second));
+    }
+    return sheet;
+}
+
+QPalette Theme::paletteFor(const Colors& colors)
+{
+    // Also what native title bars and plain dialogs (message boxes, input
+    // dialogs) are drawn from
+    QPalette palette;
+    palette.setColor(QPalette::Window, colors.window);
+    palette.setColor(QPalette::WindowText, colors.text);
+    palette.setColor(QPalette::Base, colors.surface);
+    palette.setColor(QPalette::AlternateBase, colors.field);
+    palette.setColor(QPalette::Text, colors.text);
+    palette.setColor(QPalette::PlaceholderText, colors.textFaint);
+    palette.setColor(QPalette::Button, colors.surface);
+    palette.setColor(QPalette::ButtonText, colors.text);
+    palette.setColor(QPalette::Highlight, colors.accent);
+    palette.setColor(QPalette::HighlightedText, colors.onAccent);
+    palette.setColor(QPalette::ToolTipBase, colors.hover);
+    palette.setColor(QPalette::ToolTipText, colors.text);
+    palette.setColor(QPalette::Disabled, QPalette::Text, colors.textFaint);
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, colors.textFaint);
+    return palette;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QObject>
+#include <QPalette>
+#include <QString>
+
+class QWidget;
+
+/**
+ * The terminal theme, in one place.
+ *
+ * Colors, fonts and a single style sheet for the whole widget tree are
+ * computed once per mode. apply() sets them on a top-level window, so the
+ * sheet is parsed once and the tree polished once, instead of every widget
+ * carrying its own sheet. Widgets are matched by object name (see the
+ * constants below). Delegates read colors and fonts from here at paint
+ * time, so switching mode repaints them without touching their views.
+ *
+ * Fonts are set on the window rather than on QApplication, so a host
+ * application is not repolished.
+ */
+class Theme : public QObject {
+    Q_OBJECT
+
+public:
+    enum Mode { Dark, Light };
+
+    struct Colors {
+        QColor window;          // Main window behind the panels
+        QColor surface;         // Panel, header and timeline background
+        QColor field;           // Input fields
+        QColor hover;           // Hovered / selected rows, peer bubbles
+        QColor border;          // Dividers and outlines
+        QColor text;
+        QColor textMuted;       // Secondary labels, status bar
+        QColor textFaint;       // Timestamps, placeholders
+        QColor accent;          // Send / new buttons, my bubbles
+        QColor accentHover;
+        QColor accentPressed;
+        QColor onAccent;        // Text on accent
+        QColor onAccentMuted;   // Timestamps on accent
+        QColor disabled;        // Disabled button background
+        QColor badge;           // Unread badge
+        QColor onBadge;
+    };
+
+    // Object names the style sheet matches on
+    static constexpr const char* PanelHeader = "panelHeader";
+    static constexpr const char* PanelTitle = "panelTitle";
+    static constexpr const char* EmptyState = "emptyState";
+    static constexpr const char* Timeline = "timeline";
+    static constexpr const char* Composer = "composer";
+    static constexpr const char* AccentButton = "accentButton";
+    static constexpr const char* FooterButton = "footerButton";
+    static constexpr const char* ConversationList = "conversationList";
+    static constexpr const char* SearchDialog = "searchDialog";
+    static constexpr const char* QuickSwitcher = "quickSwitcher";
+    static constexpr const char* NewMessagesPill = "newMessagesPill";
+
+    // Starts in the mode CHATSDK_THEME asks for (see ChatConfig)
+    static Theme& instance();
+
+    Mode mode() const { return m_mode; }
+    void setMode(Mode mode);
+
+    const Colors& colors() const { return m_colors; }
+    const QFont& baseFont() const { return m_baseFont; }
+    const QFont& titleFont() const { return m_titleFont; }        // Panel titles
+    const QFont& emptyStateFont() const { return m_emptyStateFont; }
+    const QFont& listNameFont() const { return m_listNameFont; }  // Conversation names
+    const QFont& listTimeFont() const { return m_listTimeFont; }  // Relative times
+
+    // Palette, font and style sheet for window and everything under it,
+    // including dialogs parented to it
+    void apply(QWidget* window) const;
+
+signals:
+    // Mode changed; re-apply() windows and repaint delegate-painted views
+    void changed();
+
+private:
+    explicit Theme(QObject* parent = nullptr);
+
+    static Colors colorsFor(Mode mode);
+    static QString styleSheetFor(const Colors& colors);
+    static QPalette paletteFor(const Colors& colors);
+
+    Mode m_mode;
+    Colors m_colors;
+    QPalette m_palette;
+    QString m_styleSheet;
+    QFont m_baseFont;
+    QFont m_titleFont;
+    QFont m_emptyStateFont;
+    QFont m_listNameFont;
+    QFont m_listTimeFont;
+};
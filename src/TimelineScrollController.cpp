@@ -0,0 +1,171 @@
+#include "TimelineScrollController.h"
+#include "StallWatchdog.h"
+#include "Theme.h"
+#include <QAbstractItemView>
+#include <QAction>
+#include <QEvent>
+#include <QPushButton>
+#include <QScrollBar>
+
+namespace {
+
+// Appends are settled at most once per frame
+constexpr int kFrameIntervalMs = 16;
+// Closer than this to the end still counts as reading the newest messages
+constexpr int kBottomSlackPx = 24;
+constexpr int kPillMarginPx = 12;
+
+} // namespace
+
+TimelineScrollController::TimelineScrollController(QAbstractItemView* view, QObject* parent)
+    : QObject(parent)
+    , m_view(view)
+    , m_pill(nullptr)
+    , m_jumpAction(nullptr)
+    , m_pendingFollow(false)
+    , m_followDecided(false)
+    , m_unreadCount(0)
+    , m_firstUnreadRow(-1)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(kFrameIntervalMs);
+    connect(&m_frameTimer, &QTimer::timeout, this, &TimelineScrollController::flush);
+
+    // Child of the view rather than its viewport, so it does not scroll
+    // along with the rows
+    m_pill = new QPushButton(view);
+    m_pill->setObjectName(Theme::NewMessagesPill);
+    m_pill->setCursor(Qt::PointingHandCursor);
+    m_pill->setFocusPolicy(Qt::NoFocus);
+    m_pill->hide();
+    connect(m_pill, &QPushButton::clicked, this, &TimelineScrollController::jumpToFirstUnread);
+
+    m_jumpAction = new QAction("Jump to First Unread", view);
+    m_jumpAction->setEnabled(false);
+    connect(m_jumpAction, &QAction::triggered, this,
+            &TimelineScrollController::jumpToFirstUnread);
+
+    connect(view->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &TimelineScrollController::onScrolled);
+    view->installEventFilter(this);
+}
+
+bool TimelineScrollController::isAtBottom() const
+{
+    const QScrollBar* scrollBar = m_view->verticalScrollBar();
+    return scrollBar->maximum() - scrollBar->value() <= kBottomSlackPx;
+}
+
+void TimelineScrollController::noteAppend(int count, bool mine)
+{
+    if (count <= 0) return;
+
+    // The first append of a frame decides, before any row has moved the end
+    if (!m_followDecided) {
+        m_pendingFollow = isAtBottom();
+        m_followDecided = true;
+    }
+    if (mine) {
+        m_pendingFollow = true;
+    }
+    if (!m_pendingFollow) {
+        if (m_firstUnreadRow < 0) {
+            m_firstUnreadRow = m_view->model()->rowCount();
+        }
+        m_unreadCount += count;
+    }
+
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void TimelineScrollController::notePrepend(int count)
+{
+    if (m_firstUnreadRow >= 0) {
+        m_firstUnreadRow += count;
+    }
+}
+
+void TimelineScrollController::reset()
+{
+    m_frameTimer.stop();
+    m_pendingFollow = false;
+    m_followDecided = false;
+    m_unreadCount = 0;
+    m_firstUnreadRow = -1;
+    updatePill();
+}
+
+void TimelineScrollController::flush()
+{
+    StallWatchdog::Scope stallScope("TimelineScrollController::flush", m_unreadCount,
+                                    "unread");
+    m_followDecided = false;
+    if (m_pendingFollow) {
+        m_pendingFollow = false;
+        scrollToBottom();
+        return;
+    }
+    updatePill();
+}
+
+void TimelineScrollController::scrollToBottom()
+{
+    m_view->scrollToBottom();
+    m_unreadCount = 0;
+    m_firstUnreadRow = -1;
+    updatePill();
+}
+
+void TimelineScrollController::jumpToFirstUnread()
+{
+    const QModelIndex first = m_view->model()->index(m_firstUnreadRow, 0);
+    if (!first.isValid()) {
+        scrollToBottom();
+        return;
+    }
+    m_view->scrollTo(first, QAbstractItemView::PositionAtTop);
+}
+
+void TimelineScrollController::onScrolled(int value)
+{
+    Q_UNUSED(value);
+    if (m_unreadCount > 0 && isAtBottom()) {
+        m_unreadCount = 0;
+        m_firstUnreadRow = -1;
+        updatePill();
+    }
+}
+
+void TimelineScrollController::updatePill()
+{
+    m_jumpAction->setEnabled(m_unreadCount > 0);
+    if (m_unreadCount == 0) {
+        m_pill->hide();
+        return;
+    }
+
+    m_pill->setText(QString("%1 new message%2 \xe2\x86\x93")
+                        .arg(m_unreadCount)
+                        .arg(m_unreadCount == 1 ? "" : "s"));
+    m_pill->adjustSize();
+    positionPill();
+    m_pill->show();
+    m_pill->raise();
+}
+
+void TimelineScrollController::positionPill()
+{
+    const QRect area = m_view->viewport()->geometry();
+    m_pill->move(area.center().x() - m_pill->width() / 2,
+                 area.bottom() + 1 - kPillMarginPx - m_pill->height());
+}
+
+bool TimelineScrollController::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_view && event->type() == QEvent::Resize && m_pill->isVisible()) {
+        positionPill();
+    }
+    return QObject::eventFilter(watched, event);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+class QAbstractItemView;
+class QAction;
+class QPushButton;
+
+/**
+ * Decides where the timeline scrolls when messages arrive.
+ *
+ * Appends are noted before the rows are inserted, while the scroll bar still
+ * describes the old content. All appends until the next frame are settled
+ * together: if the view was at the bottom (or the user sent one of the
+ * messages) it is scrolled to the bottom once; otherwise it stays where it
+ * is and a "N new messages" pill over the bottom of the view counts them.
+ * Clicking the pill, or the "Jump to First Unread" action, scrolls to the
+ * first message that arrived while the user was reading history. Reaching
+ * the bottom clears the count.
+ */
+class TimelineScrollController : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TimelineScrollController(QAbstractItemView* view, QObject* parent = nullptr);
+    ~TimelineScrollController() = default;
+
+    // count rows are about to be appended after the current last row
+    void noteAppend(int count, bool mine);
+    // count rows are about to be inserted above the loaded rows
+    void notePrepend(int count);
+    // The contents were replaced; the unread marker no longer applies
+    void reset();
+
+    void scrollToBottom();
+    void jumpToFirstUnread();
+    bool isAtBottom() const;
+    int unreadCount() const { return m_unreadCount; }
+
+    // Context menu entry for the view, enabled while there is unread content
+    QAction* jumpAction() const { return m_jumpAction; }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void flush();
+    void onScrolled(int value);
+    void updatePill();
+    void positionPill();
+
+    QAbstractItemView* m_view;
+    QPushButton* m_pill;
+    QAction* m_jumpAction;
+    QTimer m_frameTimer;
+    bool m_pendingFollow;   // Scroll to the bottom at the next flush
+    bool m_followDecided;   // m_pendingFollow is set for this frame
+    int m_unreadCount;
+    int m_firstUnreadRow;   // -1 when nothing is unread
+};